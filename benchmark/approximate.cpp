@@ -0,0 +1,59 @@
+// C++ includes
+#include <cstdint>
+#include <random>
+
+// Google Benchmark includes
+#include <benchmark/benchmark.h>
+
+// ctree includes
+#include <ctree/approximate.hpp>
+#include <ctree/batch_predicate.hpp>
+#include <ctree/ctree.hpp>
+#include <ctree/range_iterator.hpp>
+
+typedef classtree::ctree<int, void, int, int, int> tree_t;
+
+/// Builds a tree with @e n elements.
+static tree_t make_tree(const size_t n)
+{
+	std::mt19937 gen(1234);
+	std::uniform_int_distribution<int> k1(0, 1 << 12);
+	std::uniform_int_distribution<int> k2(0, 255);
+	std::uniform_int_distribution<int> k3(0, 15);
+
+	tree_t t;
+	for (size_t i = 0; i < n; ++i) {
+		t.template add<false>(static_cast<int>(i), k1(gen), k2(gen), k3(gen));
+	}
+	return t;
+}
+
+static const auto f1 = classtree::batch_between(0, 1 << 10);
+static const auto f2 = classtree::batch_between(64, 191);
+static const auto f3 = [](const int k) { return k % 2 == 0; };
+
+static void exact_count(benchmark::State& state)
+{
+	const tree_t t = make_tree(static_cast<size_t>(state.range(0)));
+
+	for (auto _ : state) {
+		auto it = t.get_const_range_iterator_begin(f1, f2, f3);
+		benchmark::DoNotOptimize(it.count());
+	}
+}
+
+static void approximate_count(benchmark::State& state)
+{
+	const tree_t t = make_tree(static_cast<size_t>(state.range(0)));
+
+	for (auto _ : state) {
+		const classtree::estimate e =
+			classtree::approximate_count(t, {.max_nodes = 4096}, f1, f2, f3);
+		benchmark::DoNotOptimize(e.value);
+	}
+}
+
+BENCHMARK(exact_count)->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 22);
+BENCHMARK(approximate_count)->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 22);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,235 @@
+// C++ includes
+#include <algorithm>
+#include <random>
+
+// Google Benchmark includes
+#include <benchmark/benchmark.h>
+
+// ctree includes
+#include <ctree/batch_predicate.hpp>
+#include <ctree/ctree.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/key_set.hpp>
+#include <ctree/nearest.hpp>
+#include <ctree/range_iterator.hpp>
+
+#define ARGUMENT_LIST                                                          \
+	->Arg(1 << 12)                                                             \
+		->Arg(1 << 14)                                                         \
+		->Arg(1 << 16)                                                         \
+		->Arg(1 << 18)                                                         \
+		->Arg(1 << 20)
+
+typedef classtree::ctree<int, void, int, int, int> tree_t;
+
+/**
+ * @brief Builds a tree with @e n elements and random keys.
+ *
+ * The elements are added in random order so that the memory of sibling
+ * nodes is scattered over the heap.
+ */
+static tree_t make_tree(const size_t n)
+{
+	std::mt19937 gen(1234);
+	std::uniform_int_distribution<int> k1(0, 63);
+	std::uniform_int_distribution<int> k2(0, 63);
+	std::uniform_int_distribution<int> k3(0, 255);
+
+	tree_t t;
+	for (size_t i = 0; i < n; ++i) {
+		t.template add<false>(static_cast<int>(i), k1(gen), k2(gen), k3(gen));
+	}
+	return t;
+}
+
+static void full_iteration(benchmark::State& state)
+{
+	const size_t n = static_cast<size_t>(state.range(0));
+	const tree_t t = make_tree(n);
+
+	for (auto _ : state) {
+		long long sum = 0;
+		auto it = t.get_const_iterator_begin();
+		while (not it.end()) {
+			sum += *it;
+			++it;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(full_iteration) ARGUMENT_LIST;
+
+static void range_iteration(benchmark::State& state)
+{
+	const size_t n = static_cast<size_t>(state.range(0));
+	const tree_t t = make_tree(n);
+
+	for (auto _ : state) {
+		long long sum = 0;
+		auto it = t.get_const_range_iterator_begin(
+			[](int k)
+			{
+				return k % 2 == 0;
+			},
+			[](int)
+			{
+				return true;
+			},
+			[](int k)
+			{
+				return k < 128;
+			}
+		);
+		while (not it.end()) {
+			sum += *it;
+			++it;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(range_iteration) ARGUMENT_LIST;
+
+static void range_count(benchmark::State& state)
+{
+	const size_t n = static_cast<size_t>(state.range(0));
+	tree_t t = make_tree(n);
+
+	for (auto _ : state) {
+		auto it = t.get_range_iterator(
+			[](int k)
+			{
+				return k < 32;
+			},
+			[](int)
+			{
+				return true;
+			},
+			[](int k)
+			{
+				return 100 <= k and k < 116;
+			}
+		);
+		const size_t c = it.count();
+		benchmark::DoNotOptimize(c);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(range_count) ARGUMENT_LIST;
+
+static void range_count_batch(benchmark::State& state)
+{
+	const size_t n = static_cast<size_t>(state.range(0));
+	tree_t t = make_tree(n);
+
+	for (auto _ : state) {
+		auto it = t.get_range_iterator(
+			classtree::batch_between(0, 31),
+			[](int)
+			{
+				return true;
+			},
+			classtree::batch_between(100, 115)
+		);
+		const size_t c = it.count();
+		benchmark::DoNotOptimize(c);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(range_count_batch) ARGUMENT_LIST;
+
+static void range_count_in(benchmark::State& state)
+{
+	const size_t n = static_cast<size_t>(state.range(0));
+	tree_t t = make_tree(n);
+
+	for (auto _ : state) {
+		auto it = t.get_range_iterator(
+			[](int k)
+			{
+				return k == 3 or k == 17 or k == 42;
+			},
+			[](int)
+			{
+				return true;
+			},
+			[](int k)
+			{
+				return (1 <= k and k <= 5) or (200 <= k and k <= 210);
+			}
+		);
+		const size_t c = it.count();
+		benchmark::DoNotOptimize(c);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(range_count_in) ARGUMENT_LIST;
+
+static void range_count_in_sorted(benchmark::State& state)
+{
+	const size_t n = static_cast<size_t>(state.range(0));
+	tree_t t = make_tree(n);
+
+	for (auto _ : state) {
+		auto it = t.get_range_iterator(
+			classtree::in_set({3, 17, 42}),
+			[](int)
+			{
+				return true;
+			},
+			classtree::in_intervals<int>({{1, 5}, {200, 210}})
+		);
+		const size_t c = it.count();
+		benchmark::DoNotOptimize(c);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(range_count_in_sorted) ARGUMENT_LIST;
+
+static void nearest_scan(benchmark::State& state)
+{
+	const size_t n = static_cast<size_t>(state.range(0));
+	const tree_t t = make_tree(n);
+
+	for (auto _ : state) {
+		// the 10 closest elements to (20, *, 100)
+		std::vector<std::pair<int, const int *>> best;
+		auto it = t.get_const_iterator_begin();
+		while (not it.end()) {
+			const auto [e, k1, k2, k3] = +it;
+			const int d = (k1 - 20) * (k1 - 20) + (k3 - 100) * (k3 - 100);
+			best.emplace_back(d, &*it);
+			++it;
+		}
+		std::partial_sort(
+			best.begin(),
+			best.begin() + std::min<std::ptrdiff_t>(10, std::ssize(best)),
+			best.end()
+		);
+		benchmark::DoNotOptimize(best);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(nearest_scan) ARGUMENT_LIST;
+
+static void nearest(benchmark::State& state)
+{
+	const size_t n = static_cast<size_t>(state.range(0));
+	const tree_t t = make_tree(n);
+
+	for (auto _ : state) {
+		const auto best = classtree::nearest(
+			t,
+			10,
+			classtree::target<int>{20},
+			classtree::any_key{},
+			classtree::target<int>{100}
+		);
+		benchmark::DoNotOptimize(best);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(nearest) ARGUMENT_LIST;
+
+BENCHMARK_MAIN();
@@ -0,0 +1,111 @@
+// C++ includes
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Google Benchmark includes
+#include <benchmark/benchmark.h>
+
+// ctree includes
+#include <ctree/ctree.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/packed_ctree.hpp>
+
+typedef classtree::ctree<int, void, std::uint64_t, std::uint64_t, int> tree_t;
+typedef classtree::packed_ctree<int, void, std::uint64_t, std::uint64_t, int>
+	packed_t;
+
+typedef std::tuple<std::uint64_t, std::uint64_t, int> keys_t;
+
+/// Builds a tree with @e n elements and clustered keys.
+static tree_t make_tree(const size_t n)
+{
+	std::mt19937 gen(1234);
+	std::uniform_int_distribution<std::uint64_t> k1(0, 1 << 14);
+	std::uniform_int_distribution<std::uint64_t> k2(0, 1 << 10);
+	std::uniform_int_distribution<int> k3(0, 63);
+
+	tree_t t;
+	for (size_t i = 0; i < n; ++i) {
+		t.template add<false>(
+			static_cast<int>(i),
+			(std::uint64_t{1} << 40) + k1(gen),
+			(std::uint64_t{1} << 50) + k2(gen),
+			k3(gen)
+		);
+	}
+	return t;
+}
+
+/// Keys of random elements of the tree.
+static std::vector<keys_t> make_queries(const tree_t& t, const size_t n)
+{
+	std::vector<keys_t> all;
+	auto it = t.get_const_iterator_begin();
+	while (not it.end()) {
+		const auto& [_, a, b, c] = +it;
+		all.emplace_back(a, b, c);
+		++it;
+	}
+	std::mt19937 gen(4321);
+	std::uniform_int_distribution<size_t> pick(0, all.size() - 1);
+	std::vector<keys_t> q(n);
+	for (auto& k : q) {
+		k = all[pick(gen)];
+	}
+	return q;
+}
+
+/// The child of a node with key @e k.
+template <typename node_t, typename key_t>
+static const auto& child(const node_t& n, const key_t& k)
+{
+	const auto it = std::partition_point(
+		n.begin(), n.end(), [&](const auto& p) { return p.first < k; }
+	);
+	return it->second;
+}
+
+static void ctree_leaf(benchmark::State& state)
+{
+	const tree_t t = make_tree(static_cast<size_t>(state.range(0)));
+	const std::vector<keys_t> queries = make_queries(t, 1 << 16);
+
+	for (auto _ : state) {
+		size_t c = 0;
+		for (const auto& [a, b, d] : queries) {
+			c += child(child(child(t, a), b), d).size();
+		}
+		benchmark::DoNotOptimize(c);
+	}
+	state.SetItemsProcessed(
+		state.iterations() * static_cast<int64_t>(queries.size())
+	);
+}
+
+static void packed_leaf(benchmark::State& state)
+{
+	const packed_t t(make_tree(static_cast<size_t>(state.range(0))));
+	std::vector<keys_t> queries;
+	{
+		const tree_t u = make_tree(static_cast<size_t>(state.range(0)));
+		queries = make_queries(u, 1 << 16);
+	}
+
+	for (auto _ : state) {
+		size_t c = 0;
+		for (const auto& [a, b, d] : queries) {
+			c += t.leaf(a, b, d).size();
+		}
+		benchmark::DoNotOptimize(c);
+	}
+	state.SetItemsProcessed(
+		state.iterations() * static_cast<int64_t>(queries.size())
+	);
+}
+
+BENCHMARK(ctree_leaf)->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 22);
+BENCHMARK(packed_leaf)->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 22);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,166 @@
+// C++ includes
+#include <random>
+#include <string>
+
+// Google Benchmark includes
+#include <benchmark/benchmark.h>
+
+// POSIX includes
+#include <unistd.h>
+
+// ctree includes
+#include <ctree/ctree.hpp>
+#include <ctree/query_client.hpp>
+#include <ctree/query_server.hpp>
+
+typedef classtree::ctree<int, void, int, int, int> tree_t;
+typedef classtree::query_client<tree_t> client_t;
+
+#define ARGUMENT_LIST                                                          \
+	->Arg(1)                                                                   \
+		->Arg(16)                                                              \
+		->Arg(256)                                                             \
+		->Threads(1)                                                           \
+		->Threads(4)                                                           \
+		->Threads(8)                                                           \
+		->UseRealTime()
+
+/// Builds a tree with @e n elements and random keys.
+static tree_t make_tree(const size_t n)
+{
+	std::mt19937 gen(1234);
+	std::uniform_int_distribution<int> k1(0, 63);
+	std::uniform_int_distribution<int> k2(0, 63);
+	std::uniform_int_distribution<int> k3(0, 255);
+
+	tree_t t;
+	for (size_t i = 0; i < n; ++i) {
+		t.template add<false>(static_cast<int>(i), k1(gen), k2(gen), k3(gen));
+	}
+	return t;
+}
+
+/// Path of the socket of the server.
+static const std::string& socket_path()
+{
+	static const std::string path =
+		"/tmp/ctree_benchmark_" + std::to_string(::getpid()) + ".sock";
+	return path;
+}
+
+/// Starts the server the first time it is called.
+static bool start_server()
+{
+	static classtree::query_server<tree_t, false> server(make_tree(1 << 20));
+	static const bool started = server.start(socket_path(), 4);
+	return started;
+}
+
+/// A local tree with the same contents as the tree of the server.
+static const tree_t& local_tree()
+{
+	static const tree_t t = make_tree(1 << 20);
+	return t;
+}
+
+static void local_count(benchmark::State& state)
+{
+	const tree_t& t = local_tree();
+	const size_t batch = static_cast<size_t>(state.range(0));
+
+	std::mt19937 gen(static_cast<unsigned>(state.thread_index()));
+	std::uniform_int_distribution<int> k1(0, 63);
+	std::uniform_int_distribution<int> k3(0, 255);
+
+	for (auto _ : state) {
+		size_t c = 0;
+		for (size_t i = 0; i < batch; ++i) {
+			const int a = k1(gen);
+			const int b = k1(gen);
+			const int d = k3(gen);
+			auto it = t.get_const_range_iterator(
+				[&](int k) { return k == a; },
+				[&](int k) { return k == b; },
+				[&](int k) { return k == d; }
+			);
+			c += it.count();
+		}
+		benchmark::DoNotOptimize(c);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(local_count) ARGUMENT_LIST;
+
+static void server_count(benchmark::State& state)
+{
+	client_t client;
+	if (not start_server() or not client.connect(socket_path())) {
+		state.SkipWithError("Could not connect to the server");
+		return;
+	}
+	const size_t batch = static_cast<size_t>(state.range(0));
+
+	std::mt19937 gen(static_cast<unsigned>(state.thread_index()));
+	std::uniform_int_distribution<int> k1(0, 63);
+	std::uniform_int_distribution<int> k3(0, 255);
+
+	for (auto _ : state) {
+		for (size_t i = 0; i < batch; ++i) {
+			client.count(k1(gen), k1(gen), k3(gen));
+		}
+		const auto results = client.execute();
+		benchmark::DoNotOptimize(results);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(server_count) ARGUMENT_LIST;
+
+static void server_range(benchmark::State& state)
+{
+	client_t client;
+	if (not start_server() or not client.connect(socket_path())) {
+		state.SkipWithError("Could not connect to the server");
+		return;
+	}
+	const size_t batch = static_cast<size_t>(state.range(0));
+
+	std::mt19937 gen(static_cast<unsigned>(state.thread_index()));
+	std::uniform_int_distribution<int> k1(0, 63);
+
+	for (auto _ : state) {
+		for (size_t i = 0; i < batch; ++i) {
+			const int a = k1(gen);
+			client.range({a, a + 1}, {0, 63}, {100, 115});
+		}
+		const auto results = client.execute();
+		benchmark::DoNotOptimize(results);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(server_range) ARGUMENT_LIST;
+
+static void server_add(benchmark::State& state)
+{
+	client_t client;
+	if (not start_server() or not client.connect(socket_path())) {
+		state.SkipWithError("Could not connect to the server");
+		return;
+	}
+	const size_t batch = static_cast<size_t>(state.range(0));
+
+	std::mt19937 gen(static_cast<unsigned>(state.thread_index()));
+	std::uniform_int_distribution<int> k1(0, 63);
+	std::uniform_int_distribution<int> k3(0, 255);
+
+	for (auto _ : state) {
+		for (size_t i = 0; i < batch; ++i) {
+			client.add(-1, k1(gen), k1(gen), k3(gen));
+		}
+		const auto results = client.execute();
+		benchmark::DoNotOptimize(results);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(server_add) ARGUMENT_LIST;
+
+BENCHMARK_MAIN();
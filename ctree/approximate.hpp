@@ -0,0 +1,422 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <unordered_map>
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <random>
+#include <tuple>
+#include <cmath>
+#include <span>
+
+// ctree includes
+#include <ctree/batch_predicate.hpp>
+#include <ctree/key_set.hpp>
+#include <ctree/ctree.hpp>
+
+namespace classtree {
+
+/// Options of the approximate queries (see @ref approximate_count).
+struct approximate_options {
+	/// Maximum number of nodes visited.
+	std::size_t max_nodes = 4096;
+	/// Maximum number of elements read in every visit to a leaf.
+	std::size_t leaf_sample = 64;
+	/// Maximum number of children of a node whose keys are all evaluated.
+	/// In wider nodes, only the key of the child chosen is evaluated.
+	std::size_t max_fan_out = 256;
+	/// Number of standard errors on each side of the confidence interval
+	/// (1.96 for 95% confidence).
+	double z = 1.96;
+	/// Seed of the random number generator.
+	std::uint64_t seed = 5489;
+};
+
+/// The result of an approximate query.
+struct estimate {
+	/// The estimated value.
+	double value = 0;
+	/// Lower end of the confidence interval.
+	double low = 0;
+	/// Upper end of the confidence interval.
+	double high = 0;
+	/// Number of paths from the root to a leaf sampled.
+	std::size_t num_samples = 0;
+	/// Number of nodes visited.
+	std::size_t num_nodes = 0;
+
+	/// Does the confidence interval contain @e v?
+	[[nodiscard]] bool contains(const double v) const noexcept
+	{
+		return low <= v and v <= high;
+	}
+};
+
+namespace detail {
+
+/// Counts every element of a leaf.
+struct count_elements { };
+
+/**
+ * @brief Estimates an aggregate over the elements of a tree that are within
+ * a range by sampling paths from the root to the leaves.
+ *
+ * At every node of a path, a child that matches the function of its level
+ * is chosen with probability proportional to its size, and the path is
+ * weighted by the total size of the matching children over the size of the
+ * child chosen. The aggregate of the leaf at the end of the path times the
+ * weights along the path is an unbiased estimate of the aggregate over the
+ * tree. The matching children of every node visited are computed once.
+ *
+ * In nodes with more than @ref approximate_options::max_fan_out children,
+ * the child is chosen among all the children and only its key is
+ * evaluated: a child that does not match ends the path with an estimate of
+ * 0, and the weight is the size of the node over the size of the child.
+ * The estimate is still unbiased, with a larger variance when few children
+ * match, and the number of evaluations of the functions of the keys is
+ * bounded by @ref approximate_options::max_fan_out per node.
+ * @tparam num_keys Number of keys of the tree.
+ * @tparam value_fn_t Type of the function of the elements that is added up.
+ * @tparam funcs_t Types of the functions of every level.
+ */
+template <std::size_t num_keys, typename value_fn_t, typename... funcs_t>
+class path_sampler {
+public:
+	/**
+	 * @brief Constructor.
+	 * @param opts Options.
+	 * @param value Function of the elements that is added up.
+	 * @param funcs The functions of every level.
+	 */
+	path_sampler(
+		const approximate_options& opts,
+		const value_fn_t& value,
+		funcs_t&&...funcs
+	)
+		: m_opts(opts),
+		  m_value(value),
+		  m_funcs(std::forward<funcs_t>(funcs)...),
+		  m_gen(opts.seed)
+	{ }
+
+	/// Samples paths of the tree until the maximum of nodes is reached.
+	template <typename tree_t>
+	[[nodiscard]] estimate run(const tree_t& t)
+	{
+		estimate e;
+		const std::size_t max_nodes =
+			std::max(m_opts.max_nodes, 2 * (num_keys + 1));
+
+		double sum = 0;
+		double sum_squares = 0;
+		while (e.num_nodes + num_keys + 1 <= max_nodes) {
+			const double x = sample<0>(t, e.num_nodes);
+			sum += x;
+			sum_squares += x * x;
+			++e.num_samples;
+		}
+
+		const auto s = static_cast<double>(e.num_samples);
+		e.value = sum / s;
+		const double variance =
+			std::max(0.0, (sum_squares - sum * e.value) / (s - 1));
+		const double error = m_opts.z * std::sqrt(variance / s);
+		e.low = e.value - error;
+		e.high = e.value + error;
+		if constexpr (std::is_same_v<value_fn_t, count_elements>) {
+			e.low = std::max(0.0, e.low);
+		}
+		return e;
+	}
+
+private:
+	/// The matching children of a node, with their cumulative sizes.
+	struct matching {
+		/// The index of every matching child. Empty when @ref all is true.
+		std::vector<std::size_t> children;
+		/// The sum of the sizes of the matching children up to every one.
+		std::vector<std::size_t> cumulative;
+		/// Are all the children candidates? Their keys are evaluated when
+		/// they are chosen.
+		bool all = false;
+	};
+
+	/**
+	 * @brief Samples a path from a node to a leaf.
+	 * @param n A node at depth @e d.
+	 * @param num_nodes Number of nodes visited; incremented.
+	 * @returns An unbiased estimate of the aggregate over @e n.
+	 */
+	template <std::size_t d, typename node_t>
+	[[nodiscard]] double sample(const node_t& n, std::size_t& num_nodes)
+	{
+		++num_nodes;
+		if constexpr (d == num_keys) {
+			return leaf_value(n);
+		}
+		else {
+			const matching& m = matching_children<d>(n);
+			if (m.cumulative.empty() or m.cumulative.back() == 0) {
+				return 0;
+			}
+			const std::size_t total = m.cumulative.back();
+			std::uniform_int_distribution<std::size_t> dist(0, total - 1);
+			const std::size_t r = dist(m_gen);
+			const auto j = static_cast<std::size_t>(
+				std::upper_bound(m.cumulative.begin(), m.cumulative.end(), r) -
+				m.cumulative.begin()
+			);
+			const std::size_t i = m.all ? j : m.children[j];
+			if (m.all and
+				not detail::key_matches(n.get_key(i), std::get<d>(m_funcs))) {
+				return 0;
+			}
+			const auto& c = n.get_child(i);
+			const double weight = static_cast<double>(total) /
+								  static_cast<double>(c.size());
+			return weight * sample<d + 1>(c, num_nodes);
+		}
+	}
+
+	/// The matching children of a node at depth @e d.
+	template <std::size_t d, typename node_t>
+	[[nodiscard]] const matching& matching_children(const node_t& n)
+	{
+		const auto [it, inserted] = m_matching.try_emplace(&n);
+		matching& m = it->second;
+		if (not inserted) {
+			return m;
+		}
+
+		const std::size_t num_children = n.num_keys();
+		std::size_t total = 0;
+		if (num_children > m_opts.max_fan_out) {
+			m.all = true;
+			m.cumulative.reserve(num_children);
+			for (std::size_t i = 0; i < num_children; ++i) {
+				total += n.get_child(i).size();
+				m.cumulative.push_back(total);
+			}
+			return m;
+		}
+
+		detail::fill_key_mask(n, std::get<d>(m_funcs), m_mask);
+
+		for (std::size_t i = 0; i < num_children; ++i) {
+			if ((m_mask[i / 64] >> (i % 64)) & 1) {
+				total += n.get_child(i).size();
+				m.children.push_back(i);
+				m.cumulative.push_back(total);
+			}
+		}
+		return m;
+	}
+
+	/**
+	 * @brief The aggregate over the matching elements of a leaf.
+	 *
+	 * When the leaf has more than @ref approximate_options::leaf_sample
+	 * elements, the aggregate is estimated from that many consecutive
+	 * elements starting at a random position (wrapping around), so that
+	 * every element is read with the same probability.
+	 */
+	template <typename leaf_t>
+	[[nodiscard]] double leaf_value(const leaf_t& n)
+	{
+		constexpr bool has_predicate = sizeof...(funcs_t) > num_keys;
+		const std::size_t size = n.size();
+		if constexpr (not has_predicate and
+					  std::is_same_v<value_fn_t, count_elements>) {
+			return static_cast<double>(size);
+		}
+		if (size == 0) {
+			return 0;
+		}
+
+		const auto *const data = &*n.begin();
+		const std::size_t k = std::min(size, m_opts.leaf_sample);
+		std::size_t first = 0;
+		if (k < size) {
+			std::uniform_int_distribution<std::size_t> dist(0, size - 1);
+			first = dist(m_gen);
+		}
+
+		double sum = 0;
+		const auto add = [&](const std::size_t begin, const std::size_t end)
+		{ sum += block_value(data + begin, end - begin); };
+		if (first + k <= size) {
+			add(first, first + k);
+		}
+		else {
+			add(first, size);
+			add(0, first + k - size);
+		}
+		return sum * static_cast<double>(size) / static_cast<double>(k);
+	}
+
+	/// The aggregate over the matching elements of a block of a leaf.
+	template <typename element_t>
+	[[nodiscard]] double
+	block_value(const element_t *const block, const std::size_t n)
+	{
+		const auto value = [&](const element_t& e) -> double
+		{
+			if constexpr (std::is_same_v<value_fn_t, count_elements>) {
+				return 1;
+			}
+			else {
+				return static_cast<double>(m_value(e));
+			}
+		};
+
+		double sum = 0;
+		if constexpr (sizeof...(funcs_t) == num_keys) {
+			for (std::size_t i = 0; i < n; ++i) {
+				sum += value(block[i]);
+			}
+		}
+		else {
+			auto& f = std::get<num_keys>(m_funcs);
+			using func_t = std::remove_cvref_t<decltype(f)>;
+			if constexpr (is_batch_predicate_v<func_t>) {
+				m_mask.assign((n + 63) / 64, 0);
+				f.func(
+					std::span<const element_t>(block, n), std::span(m_mask)
+				);
+				for (std::size_t i = 0; i < n; ++i) {
+					if ((m_mask[i / 64] >> (i % 64)) & 1) {
+						sum += value(block[i]);
+					}
+				}
+			}
+			else {
+				for (std::size_t i = 0; i < n; ++i) {
+					if (f(block[i])) {
+						sum += value(block[i]);
+					}
+				}
+			}
+		}
+		return sum;
+	}
+
+private:
+	/// Options.
+	const approximate_options& m_opts;
+	/// Function of the elements that is added up.
+	value_fn_t m_value;
+	/// The functions of every level.
+	std::tuple<std::remove_cvref_t<funcs_t>...> m_funcs;
+	/// Random number generator.
+	std::mt19937_64 m_gen;
+	/// The matching children of the nodes visited.
+	std::unordered_map<const void *, matching> m_matching;
+	/// Bitmask of the matching keys or elements of a node.
+	std::vector<std::uint64_t> m_mask;
+};
+
+} // namespace detail
+
+/**
+ * @brief Estimates the number of elements within a range.
+ *
+ * The range is given as in @ref basic_ctree::get_const_range_iterator: one
+ * function per key, and optionally one over the elements of the leaves.
+ * Paths from the root to the leaves are sampled until
+ * @e opts.max_nodes nodes have been visited: at every node, a child that
+ * matches is chosen with probability proportional to its size. The cost
+ * does not depend on the size of the tree, only on @e opts: the functions
+ * of the keys are evaluated at most @e opts.max_fan_out times per node
+ * visited.
+ * @param t The tree.
+ * @param opts Options.
+ * @param fs The functions of every level.
+ * @returns The estimate, with a confidence interval from the variance of
+ * the samples.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t,
+	typename... Callables>
+	requires(
+		sizeof...(Callables) == sizeof...(keys_t) or
+		sizeof...(Callables) == sizeof...(keys_t) + 1
+	)
+[[nodiscard]] estimate approximate_count(
+	const basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	const approximate_options& opts,
+	Callables&&...fs
+)
+{
+	using sampler_t = detail::
+		path_sampler<sizeof...(keys_t), detail::count_elements, Callables...>;
+	sampler_t s(opts, {}, std::forward<Callables>(fs)...);
+	return s.run(t);
+}
+
+/**
+ * @brief Estimates the sum of a function over the elements within a range.
+ *
+ * Same as @ref approximate_count, but every element within the range adds
+ * @e value(e) instead of 1.
+ * @param t The tree.
+ * @param opts Options.
+ * @param value Function of the elements, convertible to @e double.
+ * @param fs The functions of every level.
+ * @returns The estimate, with a confidence interval from the variance of
+ * the samples.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t,
+	typename value_fn_t,
+	typename... Callables>
+	requires(
+		sizeof...(Callables) == sizeof...(keys_t) or
+		sizeof...(Callables) == sizeof...(keys_t) + 1
+	)
+[[nodiscard]] estimate approximate_sum(
+	const basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	const approximate_options& opts,
+	const value_fn_t& value,
+	Callables&&...fs
+)
+{
+	detail::path_sampler<sizeof...(keys_t), value_fn_t, Callables...> s(
+		opts, value, std::forward<Callables>(fs)...
+	);
+	return s.run(t);
+}
+
+} // namespace classtree
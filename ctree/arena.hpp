@@ -0,0 +1,247 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <memory_resource>
+#include <type_traits>
+#include <cstddef>
+#include <utility>
+#include <memory>
+#include <map>
+
+// ctree includes
+#include <ctree/ctree.hpp>
+
+namespace classtree {
+
+/**
+ * @brief A tree in which every subtree of the root has its own arena.
+ * @tparam tree_t Type of the tree.
+ * @tparam resource_t Type of the memory resource of every arena.
+ */
+template <
+	typename tree_t,
+	typename resource_t = std::pmr::unsynchronized_pool_resource>
+class arena_ctree;
+
+/**
+ * @brief A tree in which every subtree of the root has its own arena.
+ *
+ * Every child of the root owns a memory resource (its arena), from which
+ * all the nodes and leaves beneath it are allocated (the children of a node
+ * use the allocator of the node). Scans of one subtree stay within a
+ * compact region of memory, and a whole subtree is dropped by releasing its
+ * arena (see @ref drop): when the keys, the data and the metadata are
+ * trivially destructible, the nodes of the subtree are not visited.
+ *
+ * The arenas are not thread-safe by default, and neither is the tree.
+ * @tparam data_t Type of the data stored in the leaves of the tree.
+ * @tparam metadata_t Type of the metadata stored in the leaves of the tree.
+ * @tparam key_t Type of the first key.
+ * @tparam keys_t Types of the other keys of the tree.
+ * @tparam resource_t Type of the memory resource of every arena.
+ */
+template <
+	typename data_t,
+	typename metadata_t,
+	typename key_t,
+	typename... keys_t,
+	typename resource_t>
+	requires(std::is_base_of_v<std::pmr::memory_resource, resource_t>)
+class arena_ctree<
+	basic_ctree<
+		std::pmr::polymorphic_allocator,
+		data_t,
+		metadata_t,
+		key_t,
+		keys_t...>,
+	resource_t> {
+public:
+
+	/// Type of the tree.
+	using tree_t = basic_ctree<
+		std::pmr::polymorphic_allocator,
+		data_t,
+		metadata_t,
+		key_t,
+		keys_t...>;
+	/// Type of the subtrees of the root.
+	using child_t = typename tree_t::child_t;
+	/// Type of the elements in the leaves.
+	using leaf_element_t = element_t<data_t, metadata_t>;
+
+	/// Can the nodes of a subtree be forgotten instead of destroyed?
+	static constexpr bool is_trivially_droppable =
+		std::is_trivially_destructible_v<data_t> and
+		(std::is_void_v<metadata_t> or
+		 std::is_trivially_destructible_v<metadata_t>) and
+		std::is_trivially_destructible_v<key_t> and
+		(std::is_trivially_destructible_v<keys_t> and ...);
+
+public:
+
+	/**
+	 * @brief Constructor.
+	 * @param upstream Memory resource of the root and of the arenas.
+	 */
+	explicit arena_ctree(
+		std::pmr::memory_resource *const upstream =
+			std::pmr::get_default_resource()
+	)
+		: m_upstream(upstream)
+	{
+		m_tree.set_allocator(upstream);
+	}
+
+	arena_ctree(const arena_ctree&) = delete;
+	arena_ctree& operator= (const arena_ctree&) = delete;
+
+	/// Destructor. Releases every arena.
+	~arena_ctree() noexcept
+	{
+		clear();
+	}
+
+	/**
+	 * @brief Adds an element to the tree.
+	 *
+	 * Same as @ref basic_ctree::add. If the first key is new, its subtree
+	 * is created in a new arena.
+	 * @tparam unique Store the element when there are no repeats.
+	 * @param value Element to add.
+	 * @param k The value of the first key.
+	 * @param ks The values of the other keys.
+	 * @returns True if the element was not found and added.
+	 */
+	template <bool unique = true>
+	bool add(leaf_element_t&& value, key_t k, keys_t... ks)
+	{
+		if (m_arenas.contains(k)) {
+			return m_tree.template add<unique>(
+				std::move(value), std::move(k), std::move(ks)...
+			);
+		}
+
+		auto arena = std::make_unique<resource_t>(m_upstream);
+		key_t key = k;
+		{
+			// the nodes of the new subtree are allocated in the arena
+			tree_t single;
+			single.set_allocator(arena.get());
+			single.template add<unique>(
+				std::move(value), std::move(k), std::move(ks)...
+			);
+			m_tree.template merge<unique>(std::move(single));
+		}
+		m_arenas.emplace(std::move(key), std::move(arena));
+		return true;
+	}
+
+	/**
+	 * @brief Drops the subtree of a value of the first key.
+	 *
+	 * The arena of the subtree is released in one call. The nodes of the
+	 * subtree are only visited when some type is not trivially
+	 * destructible.
+	 * @param k The value of the first key.
+	 * @returns The number of elements removed.
+	 */
+	std::size_t drop(const key_t& k)
+	{
+		const auto it = m_arenas.find(k);
+		if (it == m_arenas.end()) {
+			return 0;
+		}
+		std::size_t n = 0;
+		{
+			// the subtree must be gone before its arena
+			child_t c = m_tree.extract(k);
+			n = c.size();
+			forget(c);
+		}
+		m_arenas.erase(it);
+		return n;
+	}
+
+	/// Removes all elements and releases every arena.
+	void clear() noexcept
+	{
+		for (std::size_t i = 0; i < m_tree.num_keys(); ++i) {
+			forget(m_tree.get_child(i));
+		}
+		m_tree.clear();
+		m_arenas.clear();
+	}
+
+	/// The arena of a value of the first key, or null if there is none.
+	[[nodiscard]] resource_t *arena(const key_t& k) const noexcept
+	{
+		const auto it = m_arenas.find(k);
+		return it == m_arenas.end() ? nullptr : it->second.get();
+	}
+
+	/// The tree.
+	[[nodiscard]] const tree_t& tree() const noexcept
+	{
+		return m_tree;
+	}
+	/// The number of elements.
+	[[nodiscard]] std::size_t size() const noexcept
+	{
+		return m_tree.size();
+	}
+	/// The number of arenas.
+	[[nodiscard]] std::size_t num_arenas() const noexcept
+	{
+		return m_arenas.size();
+	}
+
+private:
+
+	/**
+	 * @brief Forgets the nodes of a subtree whose arena is about to be
+	 * released.
+	 *
+	 * When some type is not trivially destructible, the nodes are left as
+	 * they are, and they are destroyed as usual.
+	 */
+	static void forget(child_t& c) noexcept
+	{
+		if constexpr (is_trivially_droppable) {
+			c.abandon();
+		}
+	}
+
+private:
+
+	/// Memory resource of the root and of the arenas.
+	std::pmr::memory_resource *m_upstream;
+	/// The arena of every subtree of the root.
+	std::map<key_t, std::unique_ptr<resource_t>> m_arenas;
+	/// The tree. It is destroyed before the arenas.
+	tree_t m_tree;
+};
+
+} // namespace classtree
@@ -0,0 +1,116 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <span>
+
+namespace classtree {
+
+/**
+ * @brief A predicate over all the keys of a node.
+ *
+ * A batch predicate is a function
+ * @code
+ * void f(std::span<const key_t> keys, std::span<std::uint64_t> mask);
+ * @endcode
+ * that sets the bit @e i of @e mask (bit @e i % 64 of the word @e i / 64) if,
+ * and only if, the key @e keys[i] is within the range of the iteration. The
+ * mask has enough words for all the keys and is filled with zeros.
+ *
+ * Range iterators evaluate a batch predicate once every time they enter a
+ * node, and then move from one set bit of the mask to the next. Batch
+ * predicates can be vectorized by the compiler; see @ref batch_between.
+ *
+ * Use @ref batch to make a batch predicate.
+ * @tparam F Type of the function.
+ */
+template <typename F>
+struct batch_predicate {
+	/// The function.
+	F func;
+};
+
+/**
+ * @brief Makes a batch predicate.
+ *
+ * See @ref batch_predicate for details on the signature of @e f.
+ * @param f A function over all the keys of a node.
+ * @returns A batch predicate that can be passed to the functions that make
+ * range iterators.
+ */
+template <typename F>
+[[nodiscard]] constexpr batch_predicate<std::remove_cvref_t<F>> batch(F&& f
+) noexcept(std::is_nothrow_constructible_v<std::remove_cvref_t<F>, F>)
+{
+	return {std::forward<F>(f)};
+}
+
+/// Is @e T a @ref batch_predicate?
+template <typename T>
+constexpr bool is_batch_predicate_v = false;
+
+template <typename F>
+constexpr bool is_batch_predicate_v<batch_predicate<F>> = true;
+
+/**
+ * @brief A batch predicate for keys in a closed interval.
+ *
+ * The resulting predicate sets the bit of every key @e k such that
+ * \f$lo \le k \le hi\f$. The comparisons are branchless so that the loop can
+ * be vectorized.
+ * @tparam key_t Type of the key.
+ * @param lo Lower bound of the interval.
+ * @param hi Upper bound of the interval.
+ */
+template <typename key_t>
+	requires std::is_arithmetic_v<key_t>
+[[nodiscard]] constexpr auto
+batch_between(const key_t lo, const key_t hi) noexcept
+{
+	return batch(
+		[lo, hi](std::span<const key_t> keys, std::span<std::uint64_t> mask)
+		{
+			for (std::size_t w = 0; w < mask.size(); ++w) {
+				const std::size_t first = 64 * w;
+				const std::size_t n =
+					std::min<std::size_t>(64, keys.size() - first);
+
+				std::uint64_t bits = 0;
+				for (std::size_t i = 0; i < n; ++i) {
+					const key_t k = keys[first + i];
+					const bool in = (lo <= k) & (k <= hi);
+					bits |= std::uint64_t{in} << i;
+				}
+				mask[w] = bits;
+			}
+		}
+	);
+}
+
+} // namespace classtree
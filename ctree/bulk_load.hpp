@@ -0,0 +1,859 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <type_traits>
+#include <algorithm>
+#include <functional>
+#include <charconv>
+#include <fstream>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <iterator>
+#include <optional>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <span>
+
+// POSIX includes
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// ctree includes
+#include <ctree/concepts.hpp>
+#include <ctree/parallel.hpp>
+#include <ctree/ctree.hpp>
+#include <ctree/types.hpp>
+
+namespace classtree {
+
+/**
+ * @brief Types that can be read from a field of a text record.
+ *
+ * Arithmetic types are parsed with @e std::from_chars, and strings are the
+ * contents of the field.
+ * @tparam T Type.
+ */
+template <typename T>
+concept TextField =
+	(std::is_arithmetic_v<T> and not std::same_as<T, bool>) or
+	std::same_as<T, std::string>;
+
+/**
+ * @brief Types that can be read from a field of a binary record.
+ * @tparam T Type.
+ */
+template <typename T>
+concept BinaryField = std::is_trivially_copyable_v<T>;
+
+/// Options of the bulk loaders (see @ref load_csv and @ref load_binary).
+struct load_options {
+	/// Number of threads. Must be at least 1.
+	std::size_t num_threads = 1;
+	/// Separator of the fields of a text record.
+	char separator = ',';
+	/// Does the first line of a text file contain the names of the fields?
+	bool header = false;
+};
+
+/// Statistics of a bulk load.
+struct load_stats {
+	/// Number of records read.
+	std::size_t num_records = 0;
+	/// Number of bytes read.
+	std::size_t num_bytes = 0;
+	/// Time spent splitting and parsing the file, in seconds.
+	double parse_seconds = 0;
+	/// Time spent sorting the records and building the tree, in seconds.
+	double build_seconds = 0;
+
+	/// Bytes parsed per second.
+	[[nodiscard]] double parse_throughput() const noexcept
+	{
+		return parse_seconds > 0
+				   ? static_cast<double>(num_bytes) / parse_seconds
+				   : 0;
+	}
+	/// Records added to the tree per second.
+	[[nodiscard]] double build_throughput() const noexcept
+	{
+		return build_seconds > 0
+				   ? static_cast<double>(num_records) / build_seconds
+				   : 0;
+	}
+};
+
+namespace detail {
+
+/// A file mapped into memory for reading.
+class mapped_file {
+public:
+
+	/**
+	 * @brief Maps a file into memory.
+	 * @param path Path to the file.
+	 */
+	explicit mapped_file(const std::string& path) noexcept
+	{
+		const int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return;
+		}
+		struct stat st;
+		if (::fstat(fd, &st) != 0) {
+			::close(fd);
+			return;
+		}
+		m_size = static_cast<std::size_t>(st.st_size);
+		if (m_size > 0) {
+			void *const p =
+				::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (p != MAP_FAILED) {
+				::madvise(p, m_size, MADV_SEQUENTIAL);
+				m_data = static_cast<const char *>(p);
+			}
+		}
+		::close(fd);
+		m_open = m_size == 0 or m_data != nullptr;
+	}
+
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator= (const mapped_file&) = delete;
+
+	/// Destructor. Unmaps the file.
+	~mapped_file() noexcept
+	{
+		if (m_data != nullptr) {
+			::munmap(const_cast<char *>(m_data), m_size);
+		}
+	}
+
+	/// Was the file mapped?
+	[[nodiscard]] bool is_open() const noexcept
+	{
+		return m_open;
+	}
+	/// The contents of the file.
+	[[nodiscard]] std::span<const char> data() const noexcept
+	{
+		return {m_data, m_data == nullptr ? 0 : m_size};
+	}
+
+private:
+
+	/// The contents of the file.
+	const char *m_data = nullptr;
+	/// The size of the file.
+	std::size_t m_size = 0;
+	/// Was the file mapped?
+	bool m_open = false;
+};
+
+/**
+ * @brief Splits a text into chunks of whole lines.
+ * @param text The text.
+ * @param num_chunks Number of chunks wanted.
+ * @returns The positions where the chunks start, and the size of the text.
+ * There are at most @e num_chunks chunks, all of them non-empty.
+ */
+[[nodiscard]] inline std::vector<std::size_t>
+split_lines(const std::span<const char> text, const std::size_t num_chunks)
+{
+	std::vector<std::size_t> bounds{0};
+	for (std::size_t c = 1; c < num_chunks; ++c) {
+		const std::size_t from =
+			std::max(bounds.back(), text.size() * c / num_chunks);
+		const auto nl = std::find(
+			text.begin() + static_cast<std::ptrdiff_t>(from), text.end(), '\n'
+		);
+		if (nl == text.end()) {
+			break;
+		}
+		const auto b = static_cast<std::size_t>(nl - text.begin()) + 1;
+		if (b > bounds.back()) {
+			bounds.push_back(b);
+		}
+	}
+	if (bounds.back() < text.size() or bounds.size() == 1) {
+		bounds.push_back(text.size());
+	}
+	return bounds;
+}
+
+/**
+ * @brief Parses a field of a text record.
+ * @param first Beginning of the field.
+ * @param last End of the field.
+ * @param v The value read.
+ * @returns True if the whole field was read.
+ */
+template <TextField T>
+[[nodiscard]] bool
+parse_field(const char *first, const char *last, T& v) noexcept(
+	not std::same_as<T, std::string>
+)
+{
+	if constexpr (std::same_as<T, std::string>) {
+		v.assign(first, last);
+		return true;
+	}
+	else {
+		const auto [p, ec] = std::from_chars(first, last, v);
+		return ec == std::errc{} and p == last;
+	}
+}
+
+/// Compares records by their keys, and by their data if possible.
+template <typename data_t, typename metadata_t, std::size_t num_keys>
+struct record_less {
+	template <typename record_t>
+	[[nodiscard]] bool
+	operator() (const record_t& a, const record_t& b) const noexcept
+	{
+		const auto c = [&]<std::size_t... I>(std::index_sequence<I...>)
+		{
+			return std::tie(std::get<I>(a)...) <=> std::tie(std::get<I>(b)...);
+		}(std::make_index_sequence<num_keys>{});
+		if constexpr (LessthanComparable<data_t>) {
+			if (c == 0) {
+				return data_of(std::get<num_keys>(a)) <
+					   data_of(std::get<num_keys>(b));
+			}
+		}
+		return c < 0;
+	}
+
+	/// The data of an element.
+	[[nodiscard]] static const data_t&
+	data_of(const element_t<data_t, metadata_t>& e) noexcept
+	{
+		if constexpr (Compound<data_t, metadata_t>) {
+			return e.data;
+		}
+		else {
+			return e;
+		}
+	}
+};
+
+/**
+ * @brief Builds the subtree of a node from sorted records.
+ *
+ * The subtrees of a node that holds a large part of the records are built
+ * in parallel.
+ * @param n An empty node of level @e level.
+ * @param first First record of the subtree.
+ * @param last Last + 1 record of the subtree.
+ * @param e The executor.
+ * @param total Total number of records.
+ */
+template <
+	bool unique,
+	std::size_t level,
+	typename node_t,
+	typename it_t,
+	Executor executor_t>
+void build_sorted(
+	node_t& n,
+	it_t first,
+	const it_t last,
+	executor_t& e,
+	const std::size_t total
+)
+{
+	using record_t = typename std::iterator_traits<it_t>::value_type;
+	constexpr std::size_t num_keys = std::tuple_size_v<record_t> - 1;
+
+	if constexpr (level == num_keys) {
+		n.reserve(static_cast<std::size_t>(last - first));
+		for (; first != last; ++first) {
+			n.template add<unique>(std::move(std::get<num_keys>(*first)));
+		}
+	}
+	else {
+		const auto same_key = [](const record_t& a, const record_t& b)
+		{ return std::get<level>(a) == std::get<level>(b); };
+		const auto group_end = [&](const it_t it)
+		{
+			const auto l = std::adjacent_find(it, last, std::not_fn(same_key));
+			return l == last ? last : std::next(l);
+		};
+
+		const auto size = static_cast<std::size_t>(last - first);
+		if (is_large_task(size, total, e.num_workers())) {
+			std::vector<it_t> bounds{first};
+			while (bounds.back() != last) {
+				bounds.push_back(group_end(bounds.back()));
+			}
+			std::vector<typename node_t::child_t> children;
+			children.reserve(bounds.size() - 1);
+			for (std::size_t g = 0; g + 1 < bounds.size(); ++g) {
+				children.push_back(n.new_child());
+			}
+			e.bulk(
+				children.size(),
+				[&](const std::size_t, const std::size_t g)
+				{
+					build_sorted<unique, level + 1>(
+						children[g], bounds[g], bounds[g + 1], e, total
+					);
+				}
+			);
+			n.reserve(children.size());
+			for (std::size_t g = 0; g < children.size(); ++g) {
+				n.append(
+					std::move(std::get<level>(*bounds[g])),
+					std::move(children[g])
+				);
+			}
+			return;
+		}
+
+		std::size_t num_groups = 0;
+		for (auto it = first; it != last; ++num_groups) {
+			it = group_end(it);
+		}
+		n.reserve(num_groups);
+
+		while (first != last) {
+			const it_t group_last = group_end(first);
+			auto c = n.new_child();
+			build_sorted<unique, level + 1>(c, first, group_last, e, total);
+			n.append(std::move(std::get<level>(*first)), std::move(c));
+			first = group_last;
+		}
+	}
+}
+
+/**
+ * @brief Sorts the records of every chunk and merges the chunks.
+ * @param chunks The records of every chunk.
+ * @param e The executor.
+ * @returns All the records, sorted.
+ */
+template <typename record_t, Executor executor_t, typename less_t>
+[[nodiscard]] std::vector<record_t> sort_records(
+	std::vector<std::vector<record_t>>&& chunks,
+	executor_t& e,
+	const less_t& less
+)
+{
+	if (chunks.empty()) {
+		return {};
+	}
+	e.bulk(
+		chunks.size(),
+		[&](const std::size_t, const std::size_t i)
+		{ std::sort(chunks[i].begin(), chunks[i].end(), less); }
+	);
+
+	// merge pairs of chunks until there is only one
+	while (chunks.size() > 1) {
+		std::vector<std::vector<record_t>> merged(chunks.size() / 2);
+		e.bulk(
+			merged.size(),
+			[&](const std::size_t, const std::size_t i)
+			{
+				auto& a = chunks[2 * i];
+				auto& b = chunks[2 * i + 1];
+				merged[i].reserve(a.size() + b.size());
+				std::merge(
+					std::make_move_iterator(a.begin()),
+					std::make_move_iterator(a.end()),
+					std::make_move_iterator(b.begin()),
+					std::make_move_iterator(b.end()),
+					std::back_inserter(merged[i]),
+					less
+				);
+				std::vector<record_t>().swap(a);
+				std::vector<record_t>().swap(b);
+			}
+		);
+		if (chunks.size() % 2 == 1) {
+			merged.push_back(std::move(chunks.back()));
+		}
+		chunks = std::move(merged);
+	}
+	return std::move(chunks[0]);
+}
+
+/**
+ * @brief Adds sorted records to a tree.
+ *
+ * The subtrees of the root are built in parallel. If the tree is not
+ * empty, the new tree is merged into it.
+ */
+template <
+	bool unique,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t,
+	typename record_t,
+	Executor executor_t>
+void build_tree(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	std::vector<record_t>& records,
+	executor_t& e
+)
+{
+	using tree_t = basic_ctree<allocator_t, data_t, metadata_t, keys_t...>;
+
+	if (records.empty()) {
+		return;
+	}
+
+	// the records are added directly to an empty tree; otherwise, they are
+	// built with the allocator of t and merged into it
+	tree_t built;
+	if (t.size() > 0) {
+		built.set_allocator(t.get_allocator());
+	}
+	tree_t& target = t.size() == 0 ? t : built;
+	build_sorted<unique, 0>(
+		target, records.begin(), records.end(), e, records.size()
+	);
+	if (&target == &built) {
+		t.template merge<unique>(std::move(built));
+	}
+}
+
+/**
+ * @brief Parses chunks of a file in parallel, then sorts the records and
+ * builds the tree.
+ * @param parse_chunk Function called as @e parse_chunk(i, records) to parse
+ * the @e i-th chunk into @e records. Returns false if the chunk is
+ * malformed.
+ */
+template <
+	bool unique,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t,
+	Executor executor_t,
+	typename parse_t>
+[[nodiscard]] std::optional<load_stats> load(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	const std::size_t num_chunks,
+	const std::size_t num_bytes,
+	executor_t& e,
+	const parse_t& parse_chunk
+)
+{
+	using record_t =
+		std::tuple<keys_t..., element_t<data_t, metadata_t>>;
+	using clock = std::chrono::steady_clock;
+
+	load_stats stats;
+	stats.num_bytes = num_bytes;
+
+	const auto start = clock::now();
+	std::vector<std::vector<record_t>> chunks(num_chunks);
+	std::atomic<bool> ok{true};
+	e.bulk(
+		num_chunks,
+		[&](const std::size_t, const std::size_t i)
+		{
+			if (not parse_chunk(i, chunks[i])) {
+				ok = false;
+			}
+		}
+	);
+	if (not ok) {
+		return {};
+	}
+	for (const auto& c : chunks) {
+		stats.num_records += c.size();
+	}
+	const auto parsed = clock::now();
+
+	std::vector<record_t> records = sort_records(
+		std::move(chunks),
+		e,
+		record_less<data_t, metadata_t, sizeof...(keys_t)>{}
+	);
+	build_tree<unique>(t, records, e);
+	const auto built = clock::now();
+
+	stats.parse_seconds =
+		std::chrono::duration<double>(parsed - start).count();
+	stats.build_seconds =
+		std::chrono::duration<double>(built - parsed).count();
+	return stats;
+}
+
+/// Makes an element from its data.
+template <typename data_t, typename metadata_t, typename metadata_fn_t>
+[[nodiscard]] element_t<data_t, metadata_t>
+make_element(data_t&& d, const metadata_fn_t& make_metadata)
+{
+	if constexpr (Compound<data_t, metadata_t>) {
+		metadata_t m = make_metadata(std::as_const(d));
+		return {std::move(d), std::move(m)};
+	}
+	else {
+		return std::move(d);
+	}
+}
+
+/// Metadata made by default.
+template <typename metadata_t>
+struct default_metadata {
+	template <typename data_t>
+	[[nodiscard]] metadata_t operator() (const data_t&) const
+	{
+		return metadata_t{};
+	}
+};
+
+} // namespace detail
+
+/**
+ * @brief Adds the records of a text file to a tree.
+ *
+ * Every line of the file is a record with the values of the keys and the
+ * data, in this order, separated by @e opts.separator. Empty lines are
+ * skipped. The file is mapped into memory and split into chunks of whole
+ * lines, which are parsed in parallel. The records are then sorted in
+ * parallel, and the subtrees of the root are built from the sorted records
+ * in parallel, without searching the nodes.
+ *
+ * The allocators of the tree must be thread-safe (the default memory
+ * resource is).
+ * @tparam unique Store the elements so that there are no repeats.
+ * @param t The tree.
+ * @param path Path to the file.
+ * @param e The executor of the parallel steps.
+ * @param opts Options. The number of threads is not used.
+ * @param make_metadata Function that makes the metadata of an element from
+ * its data, when the metadata is not void.
+ * @returns The statistics of the load, or nothing if the file could not be
+ * opened or a record is malformed (the tree is not modified then).
+ */
+template <
+	bool unique = true,
+	Executor executor_t,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t,
+	typename metadata_fn_t = detail::default_metadata<metadata_t>>
+	requires(TextField<data_t> and (TextField<keys_t> and ...))
+[[nodiscard]] std::optional<load_stats> load_csv(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	const std::string& path,
+	executor_t& e,
+	const load_options& opts = {},
+	const metadata_fn_t& make_metadata = {}
+)
+{
+	using record_t =
+		std::tuple<keys_t..., element_t<data_t, metadata_t>>;
+
+	const detail::mapped_file file(path);
+	if (not file.is_open()) {
+		return {};
+	}
+	std::span<const char> text = file.data();
+	if (opts.header) {
+		const auto nl = std::find(text.begin(), text.end(), '\n');
+		const auto line = static_cast<std::size_t>(nl - text.begin());
+		text = text.subspan(std::min(line + 1, text.size()));
+	}
+	const std::vector<std::size_t> bounds =
+		detail::split_lines(text, 4 * e.num_workers());
+
+	const auto parse_line = [&](const char *p, const char *eol, record_t& r)
+	{
+		bool ok = true;
+		const auto field = [&]<typename T>(T& v, const bool last)
+		{
+			const char *const end =
+				last ? eol : std::find(p, eol, opts.separator);
+			ok = ok and (last or end != eol) and
+				 detail::parse_field(p, end, v);
+			p = end == eol ? eol : end + 1;
+		};
+		data_t d{};
+		[&]<std::size_t... I>(std::index_sequence<I...>)
+		{
+			(field(std::get<I>(r), false), ...);
+		}(std::make_index_sequence<sizeof...(keys_t)>{});
+		field(d, true);
+		std::get<sizeof...(keys_t)>(r) =
+			detail::make_element<data_t, metadata_t>(
+				std::move(d), make_metadata
+			);
+		return ok;
+	};
+
+	return detail::load<unique>(
+		t,
+		bounds.size() - 1,
+		text.size(),
+		e,
+		[&](const std::size_t i, std::vector<record_t>& records)
+		{
+			const char *p = text.data() + bounds[i];
+			const char *const end = text.data() + bounds[i + 1];
+			while (p < end) {
+				const char *const nl = std::find(p, end, '\n');
+				const char *eol = nl;
+				if (eol > p and *(eol - 1) == '\r') {
+					--eol;
+				}
+				if (eol > p) {
+					if (not parse_line(p, eol, records.emplace_back())) {
+						return false;
+					}
+				}
+				p = nl == end ? end : nl + 1;
+			}
+			return true;
+		}
+	);
+}
+
+/**
+ * @brief Adds the records of a text file to a tree.
+ *
+ * Same as @ref load_csv with a @ref thread_executor of @e opts.num_threads
+ * threads.
+ * @tparam unique Store the elements so that there are no repeats.
+ * @param t The tree.
+ * @param path Path to the file.
+ * @param opts Options.
+ * @param make_metadata Function that makes the metadata of an element from
+ * its data, when the metadata is not void.
+ * @returns The statistics of the load, or nothing if the file could not be
+ * opened or a record is malformed (the tree is not modified then).
+ */
+template <
+	bool unique = true,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t,
+	typename metadata_fn_t = detail::default_metadata<metadata_t>>
+	requires(TextField<data_t> and (TextField<keys_t> and ...))
+[[nodiscard]] std::optional<load_stats> load_csv(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	const std::string& path,
+	const load_options& opts = {},
+	const metadata_fn_t& make_metadata = {}
+)
+{
+	thread_executor e(opts.num_threads);
+	return load_csv<unique>(t, path, e, opts, make_metadata);
+}
+
+/**
+ * @brief Adds the records of a binary file to a tree.
+ *
+ * Every record is the values of the keys and the data, in this order, with
+ * no padding and in native byte order. The file is mapped into memory and
+ * split into chunks of whole records. The rest is as in @ref load_csv.
+ * @tparam unique Store the elements so that there are no repeats.
+ * @param t The tree.
+ * @param path Path to the file.
+ * @param e The executor of the parallel steps.
+ * @param make_metadata Function that makes the metadata of an element from
+ * its data, when the metadata is not void.
+ * @returns The statistics of the load, or nothing if the file could not be
+ * opened or its size is not a multiple of the size of a record.
+ */
+template <
+	bool unique = true,
+	Executor executor_t,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t,
+	typename metadata_fn_t = detail::default_metadata<metadata_t>>
+	requires(BinaryField<data_t> and (BinaryField<keys_t> and ...))
+[[nodiscard]] std::optional<load_stats> load_binary(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	const std::string& path,
+	executor_t& e,
+	const metadata_fn_t& make_metadata = {}
+)
+{
+	using record_t =
+		std::tuple<keys_t..., element_t<data_t, metadata_t>>;
+	constexpr std::size_t record_size =
+		(sizeof(keys_t) + ... + sizeof(data_t));
+
+	const detail::mapped_file file(path);
+	if (not file.is_open() or file.data().size() % record_size != 0) {
+		return {};
+	}
+	const std::span<const char> bytes = file.data();
+	const std::size_t n = bytes.size() / record_size;
+	const std::size_t num_chunks =
+		std::max<std::size_t>(1, std::min(n, 4 * e.num_workers()));
+
+	return detail::load<unique>(
+		t,
+		num_chunks,
+		bytes.size(),
+		e,
+		[&](const std::size_t i, std::vector<record_t>& records)
+		{
+			const std::size_t first = n * i / num_chunks;
+			const std::size_t last = n * (i + 1) / num_chunks;
+			records.resize(last - first);
+			for (std::size_t j = first; j < last; ++j) {
+				const char *p = bytes.data() + j * record_size;
+				const auto field = [&]<typename T>(T& v)
+				{
+					std::memcpy(&v, p, sizeof(T));
+					p += sizeof(T);
+				};
+				record_t& r = records[j - first];
+				[&]<std::size_t... I>(std::index_sequence<I...>)
+				{
+					(field(std::get<I>(r)), ...);
+				}(std::make_index_sequence<sizeof...(keys_t)>{});
+				data_t d;
+				field(d);
+				std::get<sizeof...(keys_t)>(r) =
+					detail::make_element<data_t, metadata_t>(
+						std::move(d), make_metadata
+					);
+			}
+			return true;
+		}
+	);
+}
+
+/**
+ * @brief Adds the records of a binary file to a tree.
+ *
+ * Same as @ref load_binary with a @ref thread_executor of
+ * @e opts.num_threads threads.
+ * @tparam unique Store the elements so that there are no repeats.
+ * @param t The tree.
+ * @param path Path to the file.
+ * @param opts Options. Only the number of threads is used.
+ * @param make_metadata Function that makes the metadata of an element from
+ * its data, when the metadata is not void.
+ * @returns The statistics of the load, or nothing if the file could not be
+ * opened or its size is not a multiple of the size of a record.
+ */
+template <
+	bool unique = true,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t,
+	typename metadata_fn_t = detail::default_metadata<metadata_t>>
+	requires(BinaryField<data_t> and (BinaryField<keys_t> and ...))
+[[nodiscard]] std::optional<load_stats> load_binary(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	const std::string& path,
+	const load_options& opts = {},
+	const metadata_fn_t& make_metadata = {}
+)
+{
+	thread_executor e(opts.num_threads);
+	return load_binary<unique>(t, path, e, make_metadata);
+}
+
+namespace detail {
+
+/**
+ * @brief Writes the elements of a node as binary records.
+ * @param n A node of the tree.
+ * @param prefix The bytes of the keys of the path to @e n.
+ * @param fout The output stream.
+ */
+template <typename data_t, typename node_t>
+void save_records(const node_t& n, std::string& prefix, std::ostream& fout)
+{
+	if constexpr (requires { typename node_t::child_t; }) {
+		const std::size_t length = prefix.size();
+		for (const auto& [k, c] : n) {
+			prefix.append(reinterpret_cast<const char *>(&k), sizeof(k));
+			save_records<data_t>(c, prefix, fout);
+			prefix.resize(length);
+		}
+	}
+	else {
+		for (const auto& e : n) {
+			const data_t *d;
+			if constexpr (std::is_same_v<std::decay_t<decltype(e)>, data_t>) {
+				d = &e;
+			}
+			else {
+				d = &e.data;
+			}
+			fout.write(
+				prefix.data(), static_cast<std::streamsize>(prefix.size())
+			);
+			fout.write(reinterpret_cast<const char *>(d), sizeof(data_t));
+		}
+	}
+}
+
+} // namespace detail
+
+/**
+ * @brief Writes the elements of a tree to a binary file.
+ *
+ * The records are in the format read by @ref load_binary, in the order of
+ * the tree. The metadata is not written.
+ * @param t The tree.
+ * @param path Path to the file.
+ * @returns Whether the file could be written.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t>
+	requires(BinaryField<data_t> and (BinaryField<keys_t> and ...))
+[[nodiscard]] bool save_binary(
+	const basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	const std::string& path
+)
+{
+	std::ofstream fout(path, std::ios::binary);
+	if (not fout.is_open()) {
+		return false;
+	}
+	std::string prefix;
+	detail::save_records<data_t>(t, prefix, fout);
+	return static_cast<bool>(fout);
+}
+
+} // namespace classtree
@@ -0,0 +1,632 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#if defined DEBUG
+#include <cassert>
+#endif
+#include <type_traits>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <limits>
+#include <cstddef>
+
+// ctree includes
+#include <ctree/type_traits.hpp>
+
+namespace classtree {
+
+/**
+ * @brief Allocator with 32-bit sizes.
+ *
+ * This is the same as @e std::allocator except that its size type is a 32-bit
+ * unsigned integer. Trees that use this allocator (see @ref compact_ctree)
+ * store the sizes and capacities of their nodes (see @ref compact_vector),
+ * and the number of elements in their subtrees, in 32 bits.
+ * @tparam T Type of the allocated objects.
+ */
+template <typename T>
+struct compact_allocator : public std::allocator<T> {
+	/// Size type of this allocator.
+	using size_type = std::uint32_t;
+	/// Difference type of this allocator.
+	using difference_type = std::int32_t;
+
+	/// Rebind this allocator to another type.
+	template <typename U>
+	struct rebind {
+		using other = compact_allocator<U>;
+	};
+
+	/// Default constructor.
+	constexpr compact_allocator() noexcept = default;
+	/// Constructor from another allocator.
+	template <typename U>
+	constexpr compact_allocator(const compact_allocator<U>&) noexcept
+	{ }
+};
+
+template <typename T>
+constexpr bool is_trivially_relocatable_v<compact_allocator<T>> = true;
+
+/**
+ * @brief Compact allocator concept.
+ *
+ * The size type of the allocator @e allocator_t is a 32-bit unsigned integer.
+ * @tparam allocator_t Allocator type.
+ */
+template <typename allocator_t>
+concept CompactAllocator = std::is_same_v<
+	typename std::allocator_traits<allocator_t>::size_type,
+	std::uint32_t>;
+
+/**
+ * @brief The vector used in the nodes of the tree.
+ *
+ * The pointer to the memory is stored as two 32-bit words and the size and
+ * capacity use the size type of the allocator. When the allocator is a
+ * @ref CompactAllocator, the alignment of this class is 4 bytes and it
+ * occupies 16 bytes (against the 24 bytes of @e std::vector), and a
+ * @ref basic_ctree node that contains it occupies 20 bytes. With any other
+ * allocator it is as large as @e std::vector.
+ *
+ * Elements that are trivially relocatable (see
+ * @ref is_trivially_relocatable_v) are moved with @e memcpy and @e memmove
+ * when the vector grows and when an element is inserted, instead of being
+ * move-constructed and destroyed one at a time.
+ *
+ * This container supports only the operations needed by the tree.
+ * @tparam T Type of the elements.
+ * @tparam allocator_t Allocator type.
+ */
+template <typename T, typename allocator_t>
+class compact_vector {
+public:
+
+	/// Type of the elements.
+	using value_type = T;
+	/// Type of the allocator.
+	using allocator_type = allocator_t;
+	/// Size type, that of the allocator.
+	using size_type = std::allocator_traits<allocator_t>::size_type;
+	/// Iterator type.
+	using iterator = T *;
+	/// Constant iterator type.
+	using const_iterator = const T *;
+
+public:
+
+	/// Default constructor.
+	compact_vector() noexcept = default;
+	/// Constructor with allocator.
+	explicit compact_vector(const allocator_t& alloc) noexcept
+		: m_alloc(alloc)
+	{ }
+
+	/// Copy constructor.
+	compact_vector(const compact_vector& v)
+		: m_alloc(
+			  traits::select_on_container_copy_construction(v.m_alloc)
+		  )
+	{
+		copy_from(v);
+	}
+	/// Copy constructor with allocator.
+	compact_vector(const compact_vector& v, const allocator_t& alloc)
+		: m_alloc(alloc)
+	{
+		copy_from(v);
+	}
+	/// Move constructor.
+	compact_vector(compact_vector&& v) noexcept
+		: m_alloc(std::move(v.m_alloc))
+	{
+		steal(v);
+	}
+
+	/// Copy assignment operator.
+	compact_vector& operator= (const compact_vector& v)
+	{
+		if (this != &v) {
+			release();
+			if constexpr (propagate_on_copy) {
+				m_alloc = v.m_alloc;
+			}
+			copy_from(v);
+		}
+		return *this;
+	}
+	/// Move assignment operator.
+	compact_vector& operator= (compact_vector&& v) noexcept(
+		propagate_on_move or traits::is_always_equal::value
+	)
+	{
+		if (this == &v) {
+			return *this;
+		}
+		release();
+		if constexpr (propagate_on_move) {
+			m_alloc = std::move(v.m_alloc);
+			steal(v);
+		}
+		else if (m_alloc == v.m_alloc) {
+			steal(v);
+		}
+		else {
+			// the memory of 'v' cannot be freed with this allocator
+			reserve(v.m_size);
+			for (T& e : v) {
+				traits::construct(m_alloc, end(), std::move(e));
+				++m_size;
+			}
+			v.clear();
+		}
+		return *this;
+	}
+
+	/// Destructor.
+	~compact_vector() noexcept
+	{
+		release();
+	}
+
+	/// Returns a copy of the allocator.
+	[[nodiscard]] allocator_t get_allocator() const noexcept
+	{
+		return m_alloc;
+	}
+
+	/// Pointer to the first element.
+	[[nodiscard]] T *data() noexcept
+	{
+		return get_pointer();
+	}
+	/// Pointer to the first element.
+	[[nodiscard]] const T *data() const noexcept
+	{
+		return get_pointer();
+	}
+
+	/// Iterator to the first element.
+	[[nodiscard]] iterator begin() noexcept
+	{
+		return get_pointer();
+	}
+	/// Iterator to the first element.
+	[[nodiscard]] const_iterator begin() const noexcept
+	{
+		return get_pointer();
+	}
+	/// Iterator past the last element.
+	[[nodiscard]] iterator end() noexcept
+	{
+		return get_pointer() + m_size;
+	}
+	/// Iterator past the last element.
+	[[nodiscard]] const_iterator end() const noexcept
+	{
+		return get_pointer() + m_size;
+	}
+
+	/// The number of elements.
+	[[nodiscard]] size_type size() const noexcept
+	{
+		return m_size;
+	}
+	/// The number of elements that fit in the allocated memory.
+	[[nodiscard]] size_type capacity() const noexcept
+	{
+		return m_capacity;
+	}
+	/// Is this vector empty?
+	[[nodiscard]] bool empty() const noexcept
+	{
+		return m_size == 0;
+	}
+	/// The maximum number of elements.
+	[[nodiscard]] static constexpr size_type max_size() noexcept
+	{
+		return std::numeric_limits<size_type>::max();
+	}
+
+	/// Returns the @e i-th element.
+	[[nodiscard]] T& operator[] (const size_t i) noexcept
+	{
+#if defined DEBUG
+		assert(i < m_size);
+#endif
+		return get_pointer()[i];
+	}
+	/// Returns the @e i-th element.
+	[[nodiscard]] const T& operator[] (const size_t i) const noexcept
+	{
+#if defined DEBUG
+		assert(i < m_size);
+#endif
+		return get_pointer()[i];
+	}
+	/// Returns the first element.
+	[[nodiscard]] T& front() noexcept
+	{
+		return (*this)[0];
+	}
+	/// Returns the first element.
+	[[nodiscard]] const T& front() const noexcept
+	{
+		return (*this)[0];
+	}
+	/// Returns the last element.
+	[[nodiscard]] T& back() noexcept
+	{
+		return (*this)[m_size - 1];
+	}
+	/// Returns the last element.
+	[[nodiscard]] const T& back() const noexcept
+	{
+		return (*this)[m_size - 1];
+	}
+
+	/**
+	 * @brief Allocates memory for at least @e n elements.
+	 * @param n Number of elements.
+	 */
+	void reserve(const size_t n)
+	{
+		if (n > m_capacity) {
+			reallocate(to_size_type(n));
+		}
+	}
+
+	/**
+	 * @brief Resizes this vector to @e n elements.
+	 *
+	 * New elements are default-constructed.
+	 * @param n Number of elements.
+	 */
+	void resize(const size_t n)
+	{
+		const size_type s = to_size_type(n);
+		if (s < m_size) {
+			std::destroy(begin() + s, end());
+			m_size = s;
+			return;
+		}
+		reserve(s);
+		T *const p = get_pointer();
+		for (; m_size < s; ++m_size) {
+			traits::construct(m_alloc, p + m_size);
+		}
+	}
+
+	/// Destroys all elements. The capacity is not modified.
+	void clear() noexcept
+	{
+		std::destroy(begin(), end());
+		m_size = 0;
+	}
+
+	/**
+	 * @brief Constructs a new element at the end of this vector.
+	 * @param args Arguments to the constructor of the element.
+	 * @returns A reference to the new element.
+	 */
+	template <typename... Args>
+	T& emplace_back(Args&&...args)
+	{
+		if (m_size == m_capacity) [[unlikely]] {
+			const size_type new_capacity = next_capacity();
+			T *const new_p = traits::allocate(m_alloc, new_capacity);
+			try {
+				traits::construct(
+					m_alloc, new_p + m_size, std::forward<Args>(args)...
+				);
+			}
+			catch (...) {
+				traits::deallocate(m_alloc, new_p, new_capacity);
+				throw;
+			}
+			relocate(new_p, begin(), end());
+			replace(new_p, new_capacity);
+		}
+		else {
+			traits::construct(
+				m_alloc, get_pointer() + m_size, std::forward<Args>(args)...
+			);
+		}
+		++m_size;
+		return back();
+	}
+
+	/**
+	 * @brief Inserts a new element before @e pos.
+	 * @param pos Iterator to the element before which the new one is inserted.
+	 * @param value The new element.
+	 * @returns An iterator to the new element.
+	 */
+	iterator insert(const_iterator pos, T&& value)
+	{
+		const size_type i = static_cast<size_type>(pos - begin());
+
+		if (m_size == m_capacity) [[unlikely]] {
+			const size_type new_capacity = next_capacity();
+			T *const new_p = traits::allocate(m_alloc, new_capacity);
+			try {
+				traits::construct(m_alloc, new_p + i, std::move(value));
+			}
+			catch (...) {
+				traits::deallocate(m_alloc, new_p, new_capacity);
+				throw;
+			}
+			relocate(new_p, begin(), begin() + i);
+			relocate(new_p + i + 1, begin() + i, end());
+			replace(new_p, new_capacity);
+		}
+		else if (i == m_size) {
+			traits::construct(m_alloc, end(), std::move(value));
+		}
+		else if constexpr (is_trivially_relocatable_v<T>) {
+			// construct the new element at the end, then rotate the bytes
+			T *const p = get_pointer();
+			traits::construct(m_alloc, p + m_size, std::move(value));
+			alignas(T) std::byte tmp[sizeof(T)];
+			std::memcpy(tmp, as_bytes(p + m_size), sizeof(T));
+			std::memmove(
+				as_bytes(p + i + 1), as_bytes(p + i), (m_size - i) * sizeof(T)
+			);
+			std::memcpy(as_bytes(p + i), tmp, sizeof(T));
+		}
+		else {
+			T *const p = get_pointer();
+			traits::construct(m_alloc, p + m_size, std::move(p[m_size - 1]));
+			std::move_backward(p + i, p + m_size - 1, p + m_size);
+			p[i] = std::move(value);
+		}
+		++m_size;
+		return begin() + i;
+	}
+
+	/**
+	 * @brief Removes the element at @e pos.
+	 * @param pos Iterator to the element to remove.
+	 * @returns An iterator to the element after the removed one.
+	 */
+	iterator erase(const_iterator pos)
+	{
+		const size_type i = static_cast<size_type>(pos - begin());
+		T *const p = get_pointer();
+		traits::destroy(m_alloc, p + i);
+		if constexpr (is_trivially_relocatable_v<T>) {
+			std::memmove(
+				as_bytes(p + i),
+				as_bytes(p + i + 1),
+				(m_size - i - 1) * sizeof(T)
+			);
+		}
+		else {
+			for (size_type j = i; j + 1 < m_size; ++j) {
+				traits::construct(m_alloc, p + j, std::move(p[j + 1]));
+				traits::destroy(m_alloc, p + j + 1);
+			}
+		}
+		--m_size;
+		return begin() + i;
+	}
+
+	/**
+	 * @brief Removes the elements in [@e first, @e last).
+	 * @param first Iterator to the first element to remove.
+	 * @param last Iterator past the last element to remove.
+	 * @returns An iterator to the element after the removed ones.
+	 */
+	iterator erase(const_iterator first, const_iterator last)
+	{
+		const size_type i = static_cast<size_type>(first - begin());
+		const size_type j = static_cast<size_type>(last - begin());
+		if (i == j) {
+			return begin() + i;
+		}
+		T *const p = get_pointer();
+		std::move(p + j, p + m_size, p + i);
+		std::destroy(p + m_size - (j - i), p + m_size);
+		m_size -= j - i;
+		return begin() + i;
+	}
+
+	/**
+	 * @brief Forgets the elements and the memory of this vector.
+	 *
+	 * The elements are not destroyed and the memory is not freed: this is
+	 * meant for vectors whose memory resource is about to be released as a
+	 * whole, and whose elements need not be destroyed.
+	 */
+	void abandon() noexcept
+	{
+		set_pointer(nullptr);
+		m_size = 0;
+		m_capacity = 0;
+	}
+
+private:
+
+	/// Shorthand for the allocator traits.
+	using traits = std::allocator_traits<allocator_t>;
+
+	/// Is the allocator copied in a copy assignment?
+	static constexpr bool propagate_on_copy =
+		traits::propagate_on_container_copy_assignment::value;
+	/// Is the allocator moved in a move assignment?
+	static constexpr bool propagate_on_move =
+		traits::propagate_on_container_move_assignment::value;
+
+	/// Number of 32-bit words needed to store a pointer.
+	static constexpr size_t pointer_words =
+		sizeof(T *) / sizeof(std::uint32_t);
+
+	/// Returns the pointer to the memory.
+	[[nodiscard]] T *get_pointer() const noexcept
+	{
+		T *p;
+		std::memcpy(&p, m_pointer, sizeof(T *));
+		return p;
+	}
+	/// Sets the pointer to the memory.
+	void set_pointer(T *p) noexcept
+	{
+		std::memcpy(m_pointer, &p, sizeof(T *));
+	}
+
+	/// Converts @e n to @ref size_type, checking for overflow.
+	[[nodiscard]] static size_type to_size_type(const size_t n)
+	{
+		if (n > max_size()) [[unlikely]] {
+			throw std::length_error("compact_vector: too many elements");
+		}
+		return static_cast<size_type>(n);
+	}
+
+	/// The capacity after the next growth.
+	[[nodiscard]] size_type next_capacity() const
+	{
+		if (m_capacity == 0) {
+			return 1;
+		}
+		return to_size_type(2 * static_cast<size_t>(m_capacity));
+	}
+
+	/// Raw pointer to the bytes of an element.
+	[[nodiscard]] static void *as_bytes(T *p) noexcept
+	{
+		return static_cast<void *>(p);
+	}
+
+	/**
+	 * @brief Relocates the elements in [@e first, @e last) into @e dest.
+	 *
+	 * The memory at @e dest is uninitialized. After the call, the elements in
+	 * [@e first, @e last) no longer exist.
+	 */
+	void relocate(T *dest, T *first, T *last)
+	{
+		if constexpr (is_trivially_relocatable_v<T>) {
+			if (first != last) {
+				std::memcpy(
+					as_bytes(dest),
+					as_bytes(first),
+					static_cast<size_t>(last - first) * sizeof(T)
+				);
+			}
+		}
+		else {
+			for (; first != last; ++first, ++dest) {
+				traits::construct(m_alloc, dest, std::move(*first));
+				traits::destroy(m_alloc, first);
+			}
+		}
+	}
+
+	/// Moves all elements into a new memory region of size @e new_capacity.
+	void reallocate(const size_type new_capacity)
+	{
+		T *const new_p = traits::allocate(m_alloc, new_capacity);
+		relocate(new_p, begin(), end());
+		replace(new_p, new_capacity);
+	}
+
+	/// Frees the current memory, whose elements were relocated.
+	void replace(T *new_p, const size_type new_capacity) noexcept
+	{
+		if (m_capacity > 0) {
+			traits::deallocate(m_alloc, get_pointer(), m_capacity);
+		}
+		set_pointer(new_p);
+		m_capacity = new_capacity;
+	}
+
+	/// Destroys all elements and frees the memory.
+	void release() noexcept
+	{
+		clear();
+		if (m_capacity > 0) {
+			traits::deallocate(m_alloc, get_pointer(), m_capacity);
+		}
+		set_pointer(nullptr);
+		m_capacity = 0;
+	}
+
+	/// Copies the contents of @e v into this (empty) vector.
+	void copy_from(const compact_vector& v)
+	{
+		if (v.m_size == 0) {
+			return;
+		}
+		T *const p = traits::allocate(m_alloc, v.m_size);
+		set_pointer(p);
+		m_capacity = v.m_size;
+		if constexpr (std::is_trivially_copyable_v<T>) {
+			std::memcpy(as_bytes(p), v.data(), v.m_size * sizeof(T));
+			m_size = v.m_size;
+			return;
+		}
+		for (const T& e : v) {
+			traits::construct(m_alloc, p + m_size, e);
+			++m_size;
+		}
+	}
+
+	/// Takes the memory of @e v.
+	void steal(compact_vector& v) noexcept
+	{
+		set_pointer(v.get_pointer());
+		m_size = v.m_size;
+		m_capacity = v.m_capacity;
+		v.set_pointer(nullptr);
+		v.m_size = 0;
+		v.m_capacity = 0;
+	}
+
+private:
+
+	/// The allocator.
+	[[no_unique_address]] allocator_t m_alloc;
+	/// Pointer to the memory, stored as 32-bit words.
+	std::uint32_t m_pointer[pointer_words] = {};
+	/// The number of elements.
+	size_type m_size = 0;
+	/// The number of elements that fit in the allocated memory.
+	size_type m_capacity = 0;
+};
+
+/**
+ * @brief A @ref compact_vector is trivially relocatable when its allocator is.
+ * @tparam T Type of the elements.
+ * @tparam allocator_t Allocator type.
+ */
+template <typename T, typename allocator_t>
+constexpr bool is_trivially_relocatable_v<compact_vector<T, allocator_t>> =
+	is_trivially_relocatable_v<allocator_t>;
+
+} // namespace classtree
@@ -23,7 +23,13 @@
 
 #pragma once
 
+// C++ includes
+#include <memory_resource>
+#include <cstddef>
+
 // ctree includes
+#include <ctree/compact_vector.hpp>
+#include <ctree/type_traits.hpp>
 #include <ctree/concepts.hpp>
 
 namespace classtree {
@@ -59,62 +65,207 @@ namespace classtree {
  * - Keep all objects. Store the new object at the corresponding leaf of
  * the tree ignoring possible repeats.
  *
+ * The memory of every node is obtained through the allocator template
+ * @e allocator_t, which is rebound to the type of the elements stored in each
+ * node. Most users will use the shorthand @ref ctree, which uses
+ * @e std::pmr::polymorphic_allocator. Stateless allocators (for example,
+ * @e std::allocator or a statically-bound pool allocator) make every node
+ * 8 bytes smaller and avoid the virtual call in every allocation.
+ *
+ * Every node stores its elements in a @ref compact_vector. When the size type
+ * of the allocator is a 32-bit integer (see @ref CompactAllocator) the sizes
+ * of the nodes and of the subtrees are stored in 32 bits. See
+ * @ref compact_ctree.
+ *
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam data_t Type of the values to store uniquely.
  * @tparam metadata_ Type of the metadata object associated to every unique
  * value.
  * @tparam keys_t The types of the values returned by the key functions.
  */
-template <typename data_t, typename metadata_t, Comparable... keys_t>
-class ctree;
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	Comparable... keys_t>
+class basic_ctree;
+
+/**
+ * @brief The nodes of a @ref basic_ctree are trivially relocatable when the
+ * allocator is.
+ *
+ * Every node is a @ref compact_vector and a size, so relocating a node
+ * only depends on relocating its allocator.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	Comparable... keys_t>
+constexpr bool is_trivially_relocatable_v<
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>> =
+	is_trivially_relocatable_v<allocator_t<std::byte>>;
 
-/// Iterator class over the leaves of a tree @ref ir_tree.
+/**
+ * @brief The Classification Tree class using polymorphic allocators.
+ *
+ * See @ref basic_ctree for details.
+ * @tparam data_t Type of the values to store uniquely.
+ * @tparam metadata_ Type of the metadata object associated to every unique
+ * value.
+ * @tparam keys_t The types of the values returned by the key functions.
+ */
 template <typename data_t, typename metadata_t, Comparable... keys_t>
-class iterator;
+using ctree = basic_ctree<
+	std::pmr::polymorphic_allocator,
+	data_t,
+	metadata_t,
+	keys_t...>;
 
-/// Constant iterator class over the leaves of a tree @ref ir_tree.
+/**
+ * @brief The Classification Tree class in compact mode.
+ *
+ * Every node uses a @ref compact_vector with 32-bit sizes and capacities.
+ * An internal node occupies 20 bytes (40 bytes in a @ref ctree), and a leaf
+ * occupies 16 bytes (32 bytes in a @ref ctree). No node can contain more than
+ * \f$2^{32} - 1\f$ elements.
+ *
+ * See @ref basic_ctree for details.
+ * @tparam data_t Type of the values to store uniquely.
+ * @tparam metadata_ Type of the metadata object associated to every unique
+ * value.
+ * @tparam keys_t The types of the values returned by the key functions.
+ */
 template <typename data_t, typename metadata_t, Comparable... keys_t>
-class const_iterator;
+using compact_ctree =
+	basic_ctree<compact_allocator, data_t, metadata_t, keys_t...>;
+
+/// Iterator class over the leaves of a tree @ref basic_ctree.
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	Comparable... keys_t>
+class basic_iterator;
+
+/// Constant iterator class over the leaves of a tree @ref basic_ctree.
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	Comparable... keys_t>
+class basic_const_iterator;
 
 /**
- * @brief Iterator class over the leaves of a tree @ref ir_tree.
+ * @brief Iterator class over the leaves of a tree @ref basic_ctree.
  *
  * This class iterates over ranges of values of the keys determined by a
- * series of functions passed as parameter.
+ * series of functions passed as parameter, one per key. An optional last
+ * function filters the elements stored at the leaves.
  */
-template <typename data_t, typename metadata_t, Comparable... keys_t>
-class range_iterator;
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	Comparable... keys_t>
+class basic_range_iterator;
 
 /**
- * @brief Constant iterator class over the leaves of a tree @ref ir_tree.
+ * @brief Constant iterator class over the leaves of a tree @ref basic_ctree.
  *
  * This class iterates over ranges of values of the keys determined by a
- * series of functions passed as parameter.
+ * series of functions passed as parameter, one per key. An optional last
+ * function filters the elements stored at the leaves.
  */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	Comparable... keys_t>
+class basic_const_range_iterator;
+
+/// Iterator class over the leaves of a tree @ref ctree.
+template <typename data_t, typename metadata_t, Comparable... keys_t>
+using iterator = basic_iterator<
+	std::pmr::polymorphic_allocator,
+	data_t,
+	metadata_t,
+	keys_t...>;
+
+/// Constant iterator class over the leaves of a tree @ref ctree.
+template <typename data_t, typename metadata_t, Comparable... keys_t>
+using const_iterator = basic_const_iterator<
+	std::pmr::polymorphic_allocator,
+	data_t,
+	metadata_t,
+	keys_t...>;
+
+/// Range iterator class over the leaves of a tree @ref ctree.
+template <typename data_t, typename metadata_t, Comparable... keys_t>
+using range_iterator = basic_range_iterator<
+	std::pmr::polymorphic_allocator,
+	data_t,
+	metadata_t,
+	keys_t...>;
+
+/// Constant range iterator class over the leaves of a tree @ref ctree.
 template <typename data_t, typename metadata_t, Comparable... keys_t>
-class const_range_iterator;
+using const_range_iterator = basic_const_range_iterator<
+	std::pmr::polymorphic_allocator,
+	data_t,
+	metadata_t,
+	keys_t...>;
 
 /// Implementation details.
 namespace detail {
 
-/// Pointer type to an instance of @ref ir_tree.
-template <typename data_t, typename metadata_t, Comparable... keys_t>
+/// Pointer type to an instance of @ref basic_ctree.
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	Comparable... keys_t>
 struct pointer {
-	using type = ctree<data_t, metadata_t, keys_t...> *;
+	using type = basic_ctree<allocator_t, data_t, metadata_t, keys_t...> *;
 };
 
-/// Pointer type to an instance of @ref ir_tree.
-template <typename data_t, typename metadata_t, Comparable... keys_t>
-using pointer_t = pointer<data_t, metadata_t, keys_t...>::type;
+/// Pointer type to an instance of @ref basic_ctree.
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	Comparable... keys_t>
+using pointer_t = pointer<allocator_t, data_t, metadata_t, keys_t...>::type;
 
-/// Constant pointer type to an instance of @ref ir_tree.
-template <typename data_t, typename metadata_t, Comparable... keys_t>
+/// Constant pointer type to an instance of @ref basic_ctree.
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	Comparable... keys_t>
 struct const_pointer {
-	using type = const ctree<data_t, metadata_t, keys_t...> *;
+	using type =
+		const basic_ctree<allocator_t, data_t, metadata_t, keys_t...> *;
 };
 
-/// Constant pointer type to an instance of @ref ir_tree.
-template <typename data_t, typename metadata_t, Comparable... keys_t>
-using const_pointer_t = const_pointer<data_t, metadata_t, keys_t...>::type;
+/// Constant pointer type to an instance of @ref basic_ctree.
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	Comparable... keys_t>
+using const_pointer_t =
+	const_pointer<allocator_t, data_t, metadata_t, keys_t...>::type;
+
+/// The type of the nodes at depth @e d of a tree of type @e node_t.
+template <typename node_t, std::size_t d>
+struct node_at {
+	using type = typename node_at<typename node_t::child_t, d - 1>::type;
+};
+template <typename node_t>
+struct node_at<node_t, 0> {
+	using type = node_t;
+};
 
 } // namespace detail
 } // namespace classtree
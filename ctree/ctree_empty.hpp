@@ -28,11 +28,17 @@
 #include <cassert>
 #endif
 #include <memory_resource>
+#include <stdexcept>
 #include <ostream>
+#include <cstddef>
 #include <vector>
 #include <ranges>
+#include <span>
 
 // custom includes
+#include <ctree/compact_vector.hpp>
+#include <ctree/growth_policy.hpp>
+#include <ctree/prefetch.hpp>
 #include <ctree/ctree.hpp>
 #include <ctree/search.hpp>
 #include <ctree/types.hpp>
@@ -44,37 +50,66 @@ namespace classtree {
  *
  * This class has no subtrees and is implemented simply as an array of
  * pairs of value and its metadata (see @ref element_t).
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam data_t Type of the values to add.
  * @tparam metadata_t Type of the metadata associated to the values.
  */
-template <typename data_t, typename metadata_t>
-class ctree<data_t, metadata_t> {
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t>
+class basic_ctree<allocator_t, data_t, metadata_t> {
 public:
 
 	/// Shorthand for a useful type.
 	using leaf_element_t = element_t<data_t, metadata_t>;
 
+	/// The allocator of the container of elements.
+	using container_allocator_t = allocator_t<leaf_element_t>;
+
 	/// The container that stores the key values, and the associated subtree.
-	using container_t = std::pmr::vector<leaf_element_t>;
+	using container_t =
+		compact_vector<leaf_element_t, container_allocator_t>;
+
+	/// Iterator over the leaves of this tree.
+	using iterator_t = basic_iterator<allocator_t, data_t, metadata_t>;
+	/// Constant iterator over the leaves of this tree.
+	using const_iterator_t =
+		basic_const_iterator<allocator_t, data_t, metadata_t>;
+	/// Range iterator over the leaves of this tree.
+	using range_iterator_t =
+		basic_range_iterator<allocator_t, data_t, metadata_t>;
+	/// Constant range iterator over the leaves of this tree.
+	using const_range_iterator_t =
+		basic_const_range_iterator<allocator_t, data_t, metadata_t>;
 
 	/// Direct access to a nice property of @ref element_t.
 	static constexpr bool is_compound = Compound<data_t, metadata_t>;
 
 public:
 
+	/// Default constructor.
+	basic_ctree() noexcept = default;
+
 	/**
-	 * @brief Resets the children empty and sets the memory resource
+	 * @brief Resets the children empty and sets the allocator
 	 *
-	 * Resets the @ref m_data vector and sets the memory resource
-	 * @param mem_res Memory resource allocator.
+	 * Resets the @ref m_data vector and sets its allocator. When the
+	 * allocator is @e std::pmr::polymorphic_allocator, a pointer to a memory
+	 * resource can be passed directly.
+	 * @param alloc Allocator.
 	 */
-	void set_allocator(std::pmr::memory_resource *mem_res)
+	void set_allocator(const container_allocator_t& alloc)
 	{
-		m_data.~vector();
+		m_data.~container_t();
 
-		new (&m_data) std::pmr::vector<leaf_element_t>(
-			std::pmr::polymorphic_allocator<leaf_element_t>{mem_res}
-		);
+		new (&m_data) container_t(alloc);
+	}
+
+	/// Returns a copy of the allocator of the elements.
+	[[nodiscard]] container_allocator_t get_allocator() const noexcept
+	{
+		return m_data.get_allocator();
 	}
 
 	/**
@@ -92,6 +127,60 @@ public:
 		m_data.clear();
 	}
 
+	/**
+	 * @brief Forgets the memory occupied by this leaf.
+	 *
+	 * See @ref basic_ctree::abandon of internal nodes.
+	 */
+	void abandon() noexcept
+	{
+		m_data.abandon();
+	}
+
+	/**
+	 * @brief Deep copy of this leaf.
+	 *
+	 * The copy is allocated with @e alloc, and its capacity is its size.
+	 * Trivially copyable elements are copied with @e memcpy.
+	 * @param alloc Allocator.
+	 * @returns A copy of this leaf.
+	 */
+	[[nodiscard]] basic_ctree clone(const container_allocator_t& alloc) const
+	{
+		return basic_ctree(m_data, alloc);
+	}
+
+	/**
+	 * @brief Deep copy of this leaf.
+	 *
+	 * Same as @ref clone with @e allocs[0]. Throws
+	 * @e std::invalid_argument if @e allocs is empty.
+	 * @param allocs One allocator per thread. Must not be empty.
+	 * @returns A copy of this leaf.
+	 */
+	[[nodiscard]] basic_ctree
+	clone_parallel(const std::span<const allocator_t<std::byte>> allocs) const
+	{
+		if (allocs.empty()) [[unlikely]] {
+			throw std::invalid_argument("clone_parallel: no allocators");
+		}
+		return clone(allocs[0]);
+	}
+
+	/**
+	 * @brief Deep copy of this leaf.
+	 *
+	 * Same as @ref clone with @e alloc.
+	 * @param alloc Allocator.
+	 * @returns A copy of this leaf.
+	 */
+	[[nodiscard]] basic_ctree
+	clone_parallel(const std::size_t, const allocator_t<std::byte>& alloc = {})
+		const
+	{
+		return clone(alloc);
+	}
+
 	/// Iterator to the key-child pair container.
 	[[nodiscard]] container_t::iterator begin() noexcept
 	{
@@ -113,6 +202,12 @@ public:
 		return m_data.end();
 	}
 
+	/// Prefetches the memory of the elements of this leaf.
+	void prefetch() const noexcept
+	{
+		detail::prefetch(m_data.data());
+	}
+
 	/**
 	 * @brief Adds another element to this tree.
 	 * @tparam _leaf_element_t Type of the value to add.
@@ -122,6 +217,25 @@ public:
 	 */
 	template <bool unique = true, typename _leaf_element_t = leaf_element_t>
 	bool add(leaf_element_t&& value)
+	{
+		return add_with_policy<unique, _leaf_element_t>({}, std::move(value));
+	}
+
+	/**
+	 * @brief Adds another element to this tree.
+	 *
+	 * If this leaf is full, it grows according to a growth policy (see
+	 * @ref growth_policy).
+	 * @tparam _leaf_element_t Type of the value to add.
+	 * @tparam unique Store the element when there are no repeats.
+	 * @param levels The growth policy from the level of this leaf downwards.
+	 * @param value Value to add.
+	 * @returns True if the element was not found and added. False if otherwise.
+	 */
+	template <bool unique = true, typename _leaf_element_t = leaf_element_t>
+	bool add_with_policy(
+		const std::span<const level_growth> levels, leaf_element_t&& value
+	)
 	{
 		static_assert(check_types<_leaf_element_t>());
 
@@ -141,6 +255,7 @@ public:
 					}
 				}();
 
+				detail::grow(m_data, levels);
 				auto it = m_data.begin();
 				std::advance(it, i);
 				m_data.insert(it, {std::move(value)});
@@ -148,6 +263,7 @@ public:
 			else {
 				// simply add the object and its metadata -- no need
 				// to check the types.
+				detail::grow(m_data, levels);
 				m_data.emplace_back(std::move(value));
 			}
 			return true;
@@ -183,6 +299,7 @@ public:
 				}
 				return false;
 			}
+			detail::grow(m_data, levels);
 			auto it = m_data.begin();
 			std::advance(it, i);
 			m_data.insert(it, std::move(value));
@@ -205,6 +322,7 @@ public:
 			);
 
 			if (it == m_data.end()) {
+				detail::grow(m_data, levels);
 				m_data.emplace_back(std::move(value));
 				return true;
 			}
@@ -227,8 +345,29 @@ public:
 	 */
 	template <bool unique = true, typename _leaf_element_t = leaf_element_t>
 	bool add_empty(_leaf_element_t&& value)
+	{
+		return add_empty<unique, _leaf_element_t>(
+			{}, std::forward<_leaf_element_t>(value)
+		);
+	}
+
+	/**
+	 * @brief Adds another element to this tree.
+	 *
+	 * This method assumes that this leaf is empty.
+	 * @tparam _leaf_element_t Type of the value to add.
+	 * @tparam unique Store the element when there are no repeats.
+	 * @param levels The growth policy from the level of this leaf downwards.
+	 * @param value Value to add.
+	 * @returns True if the element was not found and added. False if otherwise.
+	 */
+	template <bool unique = true, typename _leaf_element_t = leaf_element_t>
+	bool add_empty(
+		const std::span<const level_growth> levels, _leaf_element_t&& value
+	)
 	{
 		static_assert(check_types<_leaf_element_t>());
+		detail::grow(m_data, levels);
 		m_data.emplace_back(std::move(value));
 		return true;
 	}
@@ -240,7 +379,7 @@ public:
 	 * @returns The difference of the new size and the old size.
 	 */
 	template <bool unique = true>
-	size_t merge(ctree<data_t, metadata_t>&& t)
+	size_t merge(basic_ctree<allocator_t, data_t, metadata_t>&& t)
 	{
 		size_t added_elems = 0;
 		for (auto& v : t.m_data) {
@@ -249,6 +388,68 @@ public:
 		return added_elems;
 	}
 
+	/**
+	 * @brief Merges the elements of this leaf with equal data.
+	 *
+	 * The first of the elements with equal data is kept, and the metadata of
+	 * the others is merged into it as in @ref add. When the data is
+	 * less-than comparable the elements must be sorted; otherwise every pair
+	 * of elements is compared.
+	 * @returns The number of elements removed.
+	 */
+	size_t merge_equal()
+	{
+		static_assert(
+			EqualityComparable<data_t> or LessthanComparable<data_t>
+		);
+
+		const auto data_of = [](const leaf_element_t& e) -> const data_t&
+		{
+			if constexpr (is_compound) {
+				return e.data;
+			}
+			else {
+				return e;
+			}
+		};
+		const auto merge_into = [](leaf_element_t& e, leaf_element_t& other)
+		{
+			if constexpr (Mergeable<metadata_t>) {
+				static_assert(is_compound);
+				e.metadata += std::move(other.metadata);
+			}
+		};
+
+		const size_t n = m_data.size();
+		size_t k = 0;
+		for (size_t i = 0; i < n; ++i) {
+			bool found = false;
+			if constexpr (LessthanComparable<data_t>) {
+				found = k > 0 and
+						not(data_of(m_data[k - 1]) < data_of(m_data[i]));
+				if (found) {
+					merge_into(m_data[k - 1], m_data[i]);
+				}
+			}
+			else {
+				for (size_t j = 0; j < k and not found; ++j) {
+					if (data_of(m_data[j]) == data_of(m_data[i])) {
+						merge_into(m_data[j], m_data[i]);
+						found = true;
+					}
+				}
+			}
+			if (not found) {
+				if (k != i) {
+					m_data[k] = std::move(m_data[i]);
+				}
+				++k;
+			}
+		}
+		m_data.erase(m_data.begin() + k, m_data.end());
+		return n - k;
+	}
+
 	/**
 	 * @brief The number of unique elements over all leaves of this tree.
 	 * @returns The number of unique elements over all leaves of this tree.
@@ -411,9 +612,9 @@ public:
 	}
 
 	/// Returns an iterator object over the leaves of this tree.
-	[[nodiscard]] iterator<data_t, metadata_t> get_iterator() noexcept
+	[[nodiscard]] iterator_t get_iterator() noexcept
 	{
-		iterator<data_t, metadata_t> it;
+		iterator_t it;
 		it.set_pointer(this);
 		return it;
 	}
@@ -422,9 +623,9 @@ public:
 	 *
 	 * Starts at the beginning of the iteration.
 	 */
-	[[nodiscard]] iterator<data_t, metadata_t> get_iterator_begin() noexcept
+	[[nodiscard]] iterator_t get_iterator_begin() noexcept
 	{
-		iterator<data_t, metadata_t> it;
+		iterator_t it;
 		it.set_pointer(this);
 		it.to_begin();
 		return it;
@@ -434,18 +635,17 @@ public:
 	 *
 	 * Starts at the end of the iteration.
 	 */
-	[[nodiscard]] iterator<data_t, metadata_t> get_iterator_end() noexcept
+	[[nodiscard]] iterator_t get_iterator_end() noexcept
 	{
-		iterator<data_t, metadata_t> it;
+		iterator_t it;
 		it.set_pointer(this);
 		it.to_end();
 		return it;
 	}
 	/// Returns an iterator object over the leaves of this tree.
-	[[nodiscard]] const_iterator<data_t, metadata_t>
-	get_const_iterator() const noexcept
+	[[nodiscard]] const_iterator_t get_const_iterator() const noexcept
 	{
-		const_iterator<data_t, metadata_t> it;
+		const_iterator_t it;
 		it.set_pointer(this);
 		return it;
 	}
@@ -454,10 +654,9 @@ public:
 	 *
 	 * Starts at the beginning of the iteration.
 	 */
-	[[nodiscard]] const_iterator<data_t, metadata_t>
-	get_const_iterator_begin() const noexcept
+	[[nodiscard]] const_iterator_t get_const_iterator_begin() const noexcept
 	{
-		const_iterator<data_t, metadata_t> it;
+		const_iterator_t it;
 		it.set_pointer(this);
 		it.to_begin();
 		return it;
@@ -467,20 +666,25 @@ public:
 	 *
 	 * Starts at the end of the iteration.
 	 */
-	[[nodiscard]] const_iterator<data_t, metadata_t>
-	get_const_iterator_end() const noexcept
+	[[nodiscard]] const_iterator_t get_const_iterator_end() const noexcept
 	{
-		const_iterator<data_t, metadata_t> it;
+		const_iterator_t it;
 		it.set_pointer(this);
 		it.to_end();
 		return it;
 	}
 
-	/// Returns an iterator object over the leaves of this tree.
-	[[nodiscard]] range_iterator<data_t, metadata_t>
-	get_range_iterator() noexcept
+	/**
+	 * @brief Returns a range iterator object over the leaves of this tree.
+	 *
+	 * The optional function filters the elements of the leaf (see
+	 * @ref basic_range_iterator).
+	 */
+	template <typename... Callables>
+	[[nodiscard]] range_iterator_t get_range_iterator(Callables&&...fs)
 	{
-		range_iterator<data_t, metadata_t> it;
+		range_iterator_t it;
+		it.set_functions(std::forward<Callables>(fs)...);
 		it.set_pointer(this);
 		return it;
 	}
@@ -489,10 +693,12 @@ public:
 	 *
 	 * Starts at the beginning of the iteration.
 	 */
-	[[nodiscard]] range_iterator<data_t, metadata_t>
-	get_range_iterator_begin() noexcept
+	template <typename... Callables>
+	[[nodiscard]] range_iterator_t
+	get_range_iterator_begin(Callables&&...fs)
 	{
-		range_iterator<data_t, metadata_t> it;
+		range_iterator_t it;
+		it.set_functions(std::forward<Callables>(fs)...);
 		it.set_pointer(this);
 		[[maybe_unused]] const auto _ = it.to_begin();
 		return it;
@@ -502,19 +708,28 @@ public:
 	 *
 	 * Starts at the end of the iteration.
 	 */
-	[[nodiscard]] range_iterator<data_t, metadata_t>
-	get_range_iterator_end() noexcept
+	template <typename... Callables>
+	[[nodiscard]] range_iterator_t
+	get_range_iterator_end(Callables&&...fs)
 	{
-		range_iterator<data_t, metadata_t> it;
+		range_iterator_t it;
+		it.set_functions(std::forward<Callables>(fs)...);
 		it.set_pointer(this);
 		[[maybe_unused]] const auto _ = it.to_end();
 		return it;
 	}
-	/// Returns an iterator object over the leaves of this tree.
-	[[nodiscard]] const_range_iterator<data_t, metadata_t>
-	get_const_range_iterator() const noexcept
+	/**
+	 * @brief Returns a range iterator object over the leaves of this tree.
+	 *
+	 * The optional function filters the elements of the leaf (see
+	 * @ref basic_const_range_iterator).
+	 */
+	template <typename... Callables>
+	[[nodiscard]] const_range_iterator_t
+	get_const_range_iterator(Callables&&...fs) const
 	{
-		const_range_iterator<data_t, metadata_t> it;
+		const_range_iterator_t it;
+		it.set_functions(std::forward<Callables>(fs)...);
 		it.set_pointer(this);
 		return it;
 	}
@@ -523,10 +738,12 @@ public:
 	 *
 	 * Starts at the beginning of the iteration.
 	 */
-	[[nodiscard]] const_range_iterator<data_t, metadata_t>
-	get_const_range_iterator_begin() const noexcept
+	template <typename... Callables>
+	[[nodiscard]] const_range_iterator_t
+	get_const_range_iterator_begin(Callables&&...fs) const
 	{
-		const_range_iterator<data_t, metadata_t> it;
+		const_range_iterator_t it;
+		it.set_functions(std::forward<Callables>(fs)...);
 		it.set_pointer(this);
 		[[maybe_unused]] const auto _ = it.to_begin();
 		return it;
@@ -534,12 +751,14 @@ public:
 	/**
 	 * @brief Returns a range iterator object over the leaves of this tree.
 	 *
-	 * Starts at the beginning of the iteration.
+	 * Starts at the end of the iteration.
 	 */
-	[[nodiscard]] const_range_iterator<data_t, metadata_t>
-	get_const_range_iterator_end() const noexcept
+	template <typename... Callables>
+	[[nodiscard]] const_range_iterator_t
+	get_const_range_iterator_end(Callables&&...fs) const
 	{
-		const_range_iterator<data_t, metadata_t> it;
+		const_range_iterator_t it;
+		it.set_functions(std::forward<Callables>(fs)...);
 		it.set_pointer(this);
 		[[maybe_unused]] const auto _ = it.to_end();
 		return it;
@@ -573,6 +792,11 @@ private:
 
 private:
 
+	/// Copy constructor with allocator.
+	basic_ctree(const container_t& data, const container_allocator_t& alloc)
+		: m_data(data, alloc)
+	{ }
+
 	/// The elements in this leaf node.
 	container_t m_data;
 };
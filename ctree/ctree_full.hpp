@@ -29,63 +29,156 @@
 #endif
 #include <memory_resource>
 #include <algorithm>
+#include <stdexcept>
+#include <optional>
+#include <cstddef>
 #include <vector>
 #include <ranges>
+#include <span>
 
 // custom includes
+#include <ctree/compact_vector.hpp>
+#include <ctree/growth_policy.hpp>
+#include <ctree/executor.hpp>
+#include <ctree/prefetch.hpp>
 #include <ctree/search.hpp>
 #include <ctree/type_traits.hpp>
 #include <ctree/ctree.hpp>
 #include <ctree/types.hpp>
 
 namespace classtree {
+namespace detail {
+
+/**
+ * @brief Deep copy of a node, splitting the large subtrees into tasks.
+ * @param n The node.
+ * @param e The executor.
+ * @param allocs One allocator per worker of @e e.
+ * @param total Size of the whole tree.
+ * @param w The worker that allocates @e n.
+ * @returns A copy of @e n.
+ */
+template <typename node_t, Executor executor_t, typename alloc_t>
+[[nodiscard]] node_t clone_split(
+	const node_t& n,
+	executor_t& e,
+	const std::span<const alloc_t> allocs,
+	const std::size_t total,
+	const std::size_t w
+)
+{
+	using child_t = typename node_t::child_t;
+	using key_t = typename node_t::subtree_t::first_type;
+
+	// moving a child into a node with a different allocator would copy it
+	std::vector<std::optional<child_t>> clones(n.num_keys());
+	e.bulk(
+		clones.size(),
+		[&](const std::size_t v, const std::size_t i)
+		{
+			const child_t& c = n.get_child(i);
+			if constexpr (requires { typename child_t::child_t; }) {
+				if (is_large_task(c.size(), total, e.num_workers())) {
+					clones[i].emplace(clone_split(c, e, allocs, total, v));
+					return;
+				}
+			}
+			clones[i].emplace(c.clone(allocs[v]));
+		}
+	);
+
+	node_t r;
+	r.set_allocator(typename node_t::container_allocator_t(allocs[w]));
+	r.reserve(clones.size());
+	for (std::size_t i = 0; i < clones.size(); ++i) {
+		r.append(key_t(n.get_key(i)), std::move(*clones[i]));
+	}
+	return r;
+}
+
+} // namespace detail
 
 /**
  * @brief Partial template specialization of the Classification Tree.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam data_t Type of the values to add.
  * @tparam metadata_t Type of the metadata associated to the values.
  * @tparam key_t Type of the first key.
  * @tparam keys_t Type of the remaining keys.
  */
 template <
+	template <typename> class allocator_t,
 	typename data_t,
 	typename metadata_t,
 	Comparable key_t,
 	Comparable... keys_t>
-class ctree<data_t, metadata_t, key_t, keys_t...> {
+class basic_ctree<allocator_t, data_t, metadata_t, key_t, keys_t...> {
 public:
 
 	/// Shorthand for a useful type.
 	using leaf_element_t = element_t<data_t, metadata_t>;
 
 	/// Type of the children nodes.
-	using child_t = ctree<data_t, metadata_t, keys_t...>;
+	using child_t = basic_ctree<allocator_t, data_t, metadata_t, keys_t...>;
 
 	/// Node type, a pair of key value and its associated subtree.
 	using subtree_t = std::pair<key_t, child_t>;
 
+	/// The allocator of the container of key values and subtrees.
+	using container_allocator_t = allocator_t<subtree_t>;
+
 	/// The container that stores the key values, and the associated subtree.
-	using container_t = std::pmr::vector<subtree_t>;
+	using container_t =
+		compact_vector<subtree_t, container_allocator_t>;
+
+	/// Type used to store the number of elements in this tree.
+	using size_type = std::allocator_traits<container_allocator_t>::size_type;
+
+	/// Iterator over the leaves of this tree.
+	using iterator_t =
+		basic_iterator<allocator_t, data_t, metadata_t, key_t, keys_t...>;
+	/// Constant iterator over the leaves of this tree.
+	using const_iterator_t =
+		basic_const_iterator<allocator_t, data_t, metadata_t, key_t, keys_t...>;
+	/// Range iterator over the leaves of this tree.
+	using range_iterator_t =
+		basic_range_iterator<allocator_t, data_t, metadata_t, key_t, keys_t...>;
+	/// Constant range iterator over the leaves of this tree.
+	using const_range_iterator_t = basic_const_range_iterator<
+		allocator_t,
+		data_t,
+		metadata_t,
+		key_t,
+		keys_t...>;
 
 public:
 
+	/// Default constructor.
+	basic_ctree() noexcept = default;
+
 	/**
-	 * @brief Resets the children empty and sets the memory resource
+	 * @brief Resets the children empty and sets the allocator
 	 *
-	 * Resets the @ref m_children vector and sets the memory resource
-	 * @param mem_res Memory resource allocator.
+	 * Resets the @ref m_children vector and sets its allocator. When the
+	 * allocator is @e std::pmr::polymorphic_allocator, a pointer to a memory
+	 * resource can be passed directly.
+	 * @param alloc Allocator.
 	 */
-	void set_allocator(std::pmr::memory_resource *mem_res)
+	void set_allocator(const container_allocator_t& alloc)
 	{
-		m_children.~vector();
+		m_children.~container_t();
 
-		new (&m_children) std::pmr::vector<subtree_t>(
-			std::pmr::polymorphic_allocator<subtree_t>{mem_res}
-		);
+		new (&m_children) container_t(alloc);
 
 		m_size = 0;
 	}
 
+	/// Returns a copy of the allocator of the children.
+	[[nodiscard]] container_allocator_t get_allocator() const noexcept
+	{
+		return m_children.get_allocator();
+	}
+
 	/**
 	 * @brief Resizes the allocator of children
 	 * @param s Size.
@@ -95,6 +188,15 @@ public:
 		m_children.resize(s);
 	}
 
+	/**
+	 * @brief Reserves memory for @e s children.
+	 * @param s Number of children.
+	 */
+	void reserve(const size_t s)
+	{
+		m_children.reserve(s);
+	}
+
 	/**
 	 * @brief Clear the memory occupied by this internal node.
 	 *
@@ -109,6 +211,148 @@ public:
 		m_size = 0;
 	}
 
+	/**
+	 * @brief Forgets the memory occupied by this node and its subtrees.
+	 *
+	 * Nothing is destroyed and no memory is freed: this is meant for nodes
+	 * allocated from a memory resource that is about to be released as a
+	 * whole, and whose keys and elements are trivially destructible.
+	 */
+	void abandon() noexcept
+	{
+		m_children.abandon();
+		m_size = 0;
+	}
+
+	/**
+	 * @brief A new empty child of this node.
+	 *
+	 * The child uses the allocator of this node, so that every node of a
+	 * subtree is allocated from the same memory resource as its root.
+	 */
+	[[nodiscard]] child_t new_child() const
+	{
+		child_t c;
+		if constexpr (not std::allocator_traits<
+						  container_allocator_t>::is_always_equal::value) {
+			c.set_allocator(typename child_t::container_allocator_t(
+				m_children.get_allocator()
+			));
+		}
+		return c;
+	}
+
+	/**
+	 * @brief Appends a subtree to this node.
+	 *
+	 * This is meant for building trees from sorted elements.
+	 * @param k Key value, greater than every key of this node.
+	 * @param c The subtree of @e k (see @ref new_child).
+	 */
+	void append(key_t&& k, child_t&& c)
+	{
+#if defined DEBUG
+		assert(m_children.empty() or m_children.back().first < k);
+#endif
+		m_size += static_cast<size_type>(c.size());
+		m_children.emplace_back(std::move(k), std::move(c));
+	}
+
+	/**
+	 * @brief Removes the subtree of a key value and returns it.
+	 * @param k Key value.
+	 * @returns The subtree of @e k, or an empty subtree if there is none.
+	 */
+	[[nodiscard]] child_t extract(const key_t& k)
+	{
+		const auto [i, exists] = search(m_children, k);
+		if (not exists) {
+			return child_t();
+		}
+		child_t c = std::move(m_children[i].second);
+		m_size -= static_cast<size_type>(c.size());
+		m_children.erase(m_children.begin() + i);
+		return c;
+	}
+
+	/**
+	 * @brief Deep copy of this tree.
+	 *
+	 * Every node of the copy is allocated with @e alloc, and its capacity is
+	 * its size. When the allocator is @e std::pmr::polymorphic_allocator, a
+	 * pointer to a memory resource can be passed directly (for example, a
+	 * @e std::pmr::monotonic_buffer_resource of @ref total_bytes bytes).
+	 * @param alloc Allocator.
+	 * @returns A copy of this tree.
+	 */
+	[[nodiscard]] basic_ctree clone(const container_allocator_t& alloc) const
+	{
+		container_t children(alloc);
+		children.reserve(m_children.size());
+		for (const auto& [k, c] : m_children) {
+			children.emplace_back(k, c.clone(alloc));
+		}
+		return basic_ctree(std::move(children), m_size);
+	}
+
+	/**
+	 * @brief Deep copy of this tree using an executor.
+	 *
+	 * Same as @ref clone, but the subtrees are copied in parallel. A subtree
+	 * that holds a large part of the elements of the tree is split into one
+	 * task per child. Worker @e w allocates the nodes it copies with
+	 * @e allocs[w]. The root is allocated with @e allocs[0]. Throws
+	 * @e std::invalid_argument if there are fewer allocators than workers.
+	 * @param e The executor.
+	 * @param allocs One allocator per worker of @e e.
+	 * @returns A copy of this tree.
+	 */
+	template <Executor executor_t>
+	[[nodiscard]] basic_ctree clone_parallel(
+		executor_t& e, const std::span<const allocator_t<std::byte>> allocs
+	) const
+	{
+		if (allocs.empty() or allocs.size() < e.num_workers()) [[unlikely]] {
+			throw std::invalid_argument(
+				"clone_parallel: fewer allocators than workers"
+			);
+		}
+		return detail::clone_split(*this, e, allocs, size(), 0);
+	}
+
+	/**
+	 * @brief Deep copy of this tree using several threads.
+	 *
+	 * Same as @ref clone_parallel with a @ref thread_executor of
+	 * @e allocs.size() threads.
+	 * @param allocs One allocator per thread. Must not be empty.
+	 * @returns A copy of this tree.
+	 */
+	[[nodiscard]] basic_ctree
+	clone_parallel(const std::span<const allocator_t<std::byte>> allocs) const
+	{
+		thread_executor e(allocs.size());
+		return clone_parallel(e, allocs);
+	}
+
+	/**
+	 * @brief Deep copy of this tree using several threads.
+	 *
+	 * Same as @ref clone_parallel with the allocator @e alloc in every
+	 * thread. The allocator must be thread-safe (the default memory resource
+	 * is).
+	 * @param num_threads Number of threads. Must be at least 1.
+	 * @param alloc Allocator.
+	 * @returns A copy of this tree.
+	 */
+	[[nodiscard]] basic_ctree clone_parallel(
+		const std::size_t num_threads, const allocator_t<std::byte>& alloc = {}
+	) const
+	{
+		const std::vector<allocator_t<std::byte>> allocs(num_threads, alloc);
+		return clone_parallel(std::span<const allocator_t<std::byte>>(allocs));
+	}
+
 	/// Iterator to the key-child pair container.
 	[[nodiscard]] container_t::iterator begin() noexcept
 	{
@@ -130,6 +374,12 @@ public:
 		return m_children.end();
 	}
 
+	/// Prefetches the memory of the key-child pairs of this node.
+	void prefetch() const noexcept
+	{
+		detail::prefetch(m_children.data());
+	}
+
 	/**
 	 * @brief Adds another element to this tree.
 	 * @tparam unique Store the element when there are no repeats.
@@ -147,25 +397,65 @@ public:
 		typename _key_t = key_t,
 		typename... _keys_t>
 	bool add(_leaf_element_t&& value, _key_t&& h, _keys_t&&...ks)
+	{
+		return add_with_policy<unique>(
+			{},
+			std::forward<_leaf_element_t>(value),
+			std::forward<_key_t>(h),
+			std::forward<_keys_t>(ks)...
+		);
+	}
+
+	/**
+	 * @brief Adds another element to this tree.
+	 *
+	 * The nodes that are full grow according to a growth policy (see
+	 * @ref growth_policy).
+	 * @tparam unique Store the element when there are no repeats.
+	 * @tparam _leaf_element_t Type of the element to be added.
+	 * @tparam _key_t Type of the first key.
+	 * @tparam _keys_t Type of the remaining keys.
+	 * @param levels The growth policy from the level of this node downwards.
+	 * @param value Value to add.
+	 * @param h The value of the first key.
+	 * @param ks The values of the other keys.
+	 * @returns True if the element was not found and added. False if otherwise.
+	 */
+	template <
+		bool unique = true,
+		typename _leaf_element_t = leaf_element_t,
+		typename _key_t = key_t,
+		typename... _keys_t>
+	bool add_with_policy(
+		const std::span<const level_growth> levels,
+		_leaf_element_t&& value,
+		_key_t&& h,
+		_keys_t&&...ks
+	)
 	{
 		static_assert(check_types<_leaf_element_t, _key_t, _keys_t...>());
 
 		const auto [i, exists] = search(m_children, h);
 		if (not exists) {
+			detail::grow(m_children, levels);
 			auto it = m_children.begin();
 			std::advance(it, i);
-			m_children.insert(it, subtree_t{std::move(h), child_t()});
+			m_children.insert(it, subtree_t{std::move(h), new_child()});
 			m_size += 1;
 			// this always returns true
 			return m_children[i].second.template add_empty<unique>(
+				detail::next_levels(levels),
 				std::forward<leaf_element_t>(value),
 				std::forward<_keys_t>(ks)...
 			);
 		}
 
-		const bool added = m_children[i].second.template add<unique>(
-			std::forward<leaf_element_t>(value), std::forward<_keys_t>(ks)...
-		);
+		const bool added =
+			m_children[i].second.template add_with_policy<unique>(
+				detail::next_levels(levels),
+				std::forward<leaf_element_t>(value),
+				std::forward<_keys_t>(ks)...
+			);
 		m_size += added;
 		return added;
 	}
@@ -189,14 +479,51 @@ public:
 		typename _key_t = key_t,
 		typename... _keys_t>
 	bool add_empty(leaf_element_t&& value, _key_t&& h, _keys_t&&...ks)
+	{
+		return add_empty<unique, _leaf_element_t>(
+			std::span<const level_growth>{},
+			std::move(value),
+			std::forward<_key_t>(h),
+			std::forward<_keys_t>(ks)...
+		);
+	}
+
+	/**
+	 * @brief Adds another element to this tree.
+	 *
+	 * This method assumes that this node is empty.
+	 * @tparam unique Store the element when there are no repeats.
+	 * @tparam _leaf_element_t Type of the element to be added.
+	 * @tparam _key_t Type of the first key.
+	 * @tparam _keys_t Type of the remaining keys.
+	 * @param levels The growth policy from the level of this node downwards.
+	 * @param v Value to add.
+	 * @param h The value of the first key.
+	 * @param ks The values of the other keys.
+	 * @returns True if the element was not found and added. False if otherwise.
+	 */
+	template <
+		bool unique = true,
+		typename _leaf_element_t = leaf_element_t,
+		typename _key_t = key_t,
+		typename... _keys_t>
+	bool add_empty(
+		const std::span<const level_growth> levels,
+		leaf_element_t&& value,
+		_key_t&& h,
+		_keys_t&&...ks
+	)
 	{
 		static_assert(check_types<_leaf_element_t, _key_t, _keys_t...>());
 
-		m_children.emplace_back(std::move(h), child_t());
+		detail::grow(m_children, levels);
+		m_children.emplace_back(std::move(h), new_child());
 		m_size += 1;
 		// this always returns true
 		return m_children[0].second.template add_empty<unique>(
-			std::forward<leaf_element_t>(value), std::forward<_keys_t>(ks)...
+			detail::next_levels(levels),
+			std::forward<leaf_element_t>(value),
+			std::forward<_keys_t>(ks)...
 		);
 	}
 
@@ -207,7 +534,8 @@ public:
 	 * @returns The difference of the new size and the old size.
 	 */
 	template <bool unique = true>
-	size_t merge(ctree<data_t, metadata_t, key_t, keys_t...>&& t)
+	size_t
+	merge(basic_ctree<allocator_t, data_t, metadata_t, key_t, keys_t...>&& t)
 	{
 		size_t old_size = m_size;
 		for (auto& [k, c] : t.m_children) {
@@ -216,12 +544,13 @@ public:
 			if (not exists) {
 				auto it = m_children.begin();
 				std::advance(it, i);
-				m_size += c.size();
+				m_size += static_cast<size_type>(c.size());
 				m_children.insert(it, {std::move(k), std::move(c)});
 			}
 			else {
-				m_size +=
-					m_children[i].second.template merge<unique>(std::move(c));
+				m_size += static_cast<size_type>(
+					m_children[i].second.template merge<unique>(std::move(c))
+				);
 			}
 		}
 		return m_size - old_size;
@@ -358,7 +687,7 @@ public:
 	{
 		m_size = 0;
 		for (auto& [_, child] : m_children) {
-			m_size += child.update_size();
+			m_size += static_cast<size_type>(child.update_size());
 		}
 		return m_size;
 	}
@@ -471,10 +800,9 @@ public:
 	}
 
 	// Returns an iterator object over the leaves of this tree.
-	[[nodiscard]] iterator<data_t, metadata_t, key_t, keys_t...>
-	get_iterator() noexcept
+	[[nodiscard]] iterator_t get_iterator() noexcept
 	{
-		iterator<data_t, metadata_t, key_t, keys_t...> it;
+		iterator_t it;
 		it.set_pointer(this);
 		return it;
 	}
@@ -483,10 +811,9 @@ public:
 	 *
 	 * Starts at the beginning of the iteration.
 	 */
-	[[nodiscard]] iterator<data_t, metadata_t, key_t, keys_t...>
-	get_iterator_begin() noexcept
+	[[nodiscard]] iterator_t get_iterator_begin() noexcept
 	{
-		iterator<data_t, metadata_t, key_t, keys_t...> it;
+		iterator_t it;
 		it.set_pointer(this);
 		it.to_begin();
 		return it;
@@ -496,19 +823,17 @@ public:
 	 *
 	 * Starts at the end of the iteration.
 	 */
-	[[nodiscard]] iterator<data_t, metadata_t, key_t, keys_t...>
-	get_iterator_end() noexcept
+	[[nodiscard]] iterator_t get_iterator_end() noexcept
 	{
-		iterator<data_t, metadata_t, key_t, keys_t...> it;
+		iterator_t it;
 		it.set_pointer(this);
 		it.to_end();
 		return it;
 	}
 	// Returns an iterator object over the leaves of this tree.
-	[[nodiscard]] const_iterator<data_t, metadata_t, key_t, keys_t...>
-	get_const_iterator() const noexcept
+	[[nodiscard]] const_iterator_t get_const_iterator() const noexcept
 	{
-		const_iterator<data_t, metadata_t, key_t, keys_t...> it;
+		const_iterator_t it;
 		it.set_pointer(this);
 		return it;
 	}
@@ -517,10 +842,9 @@ public:
 	 *
 	 * Starts at the beginning of the iteration.
 	 */
-	[[nodiscard]] const_iterator<data_t, metadata_t, key_t, keys_t...>
-	get_const_iterator_begin() const noexcept
+	[[nodiscard]] const_iterator_t get_const_iterator_begin() const noexcept
 	{
-		const_iterator<data_t, metadata_t, key_t, keys_t...> it;
+		const_iterator_t it;
 		it.set_pointer(this);
 		it.to_begin();
 		return it;
@@ -530,21 +854,24 @@ public:
 	 *
 	 * Starts at the end of the iteration.
 	 */
-	[[nodiscard]] const_iterator<data_t, metadata_t, key_t, keys_t...>
-	get_const_iterator_end() const noexcept
+	[[nodiscard]] const_iterator_t get_const_iterator_end() const noexcept
 	{
-		const_iterator<data_t, metadata_t, key_t, keys_t...> it;
+		const_iterator_t it;
 		it.set_pointer(this);
 		it.to_end();
 		return it;
 	}
 
-	// Returns a range iterator object over the leaves of this tree.
+	/**
+	 * @brief Returns a range iterator object over the leaves of this tree.
+	 *
+	 * There is one function per key, and an optional last function over the
+	 * elements of the leaves (see @ref basic_range_iterator).
+	 */
 	template <typename... Callables>
-	[[nodiscard]] range_iterator<data_t, metadata_t, key_t, keys_t...>
-	get_range_iterator(Callables&&...fs) noexcept
+	[[nodiscard]] range_iterator_t get_range_iterator(Callables&&...fs)
 	{
-		range_iterator<data_t, metadata_t, key_t, keys_t...> it;
+		range_iterator_t it;
 		it.set_functions(std::forward<Callables>(fs)...);
 		it.set_pointer(this);
 		return it;
@@ -555,10 +882,10 @@ public:
 	 * Starts at the beginning of the iteration.
 	 */
 	template <typename... Callables>
-	[[nodiscard]] range_iterator<data_t, metadata_t, key_t, keys_t...>
-	get_range_iterator_begin(Callables&&...fs) noexcept
+	[[nodiscard]] range_iterator_t
+	get_range_iterator_begin(Callables&&...fs)
 	{
-		range_iterator<data_t, metadata_t, key_t, keys_t...> it;
+		range_iterator_t it;
 		it.set_functions(std::forward<Callables>(fs)...);
 		it.set_pointer(this);
 		[[maybe_unused]] const bool _ = it.to_begin();
@@ -570,10 +897,10 @@ public:
 	 * Starts at the end of the iteration.
 	 */
 	template <typename... Callables>
-	[[nodiscard]] range_iterator<data_t, metadata_t, key_t, keys_t...>
-	get_range_iterator_end(Callables&&...fs) noexcept
+	[[nodiscard]] range_iterator_t
+	get_range_iterator_end(Callables&&...fs)
 	{
-		range_iterator<data_t, metadata_t, key_t, keys_t...> it;
+		range_iterator_t it;
 		it.set_functions(std::forward<Callables>(fs)...);
 		it.set_pointer(this);
 		[[maybe_unused]] const bool _ = it.to_end();
@@ -581,10 +908,10 @@ public:
 	}
 	// Returns a const range iterator object over the leaves of this tree.
 	template <typename... Callables>
-	[[nodiscard]] const_range_iterator<data_t, metadata_t, key_t, keys_t...>
-	get_const_range_iterator(Callables&&...fs) const noexcept
+	[[nodiscard]] const_range_iterator_t
+	get_const_range_iterator(Callables&&...fs) const
 	{
-		const_range_iterator<data_t, metadata_t, key_t, keys_t...> it;
+		const_range_iterator_t it;
 		it.set_functions(std::forward<Callables>(fs)...);
 		it.set_pointer(this);
 		return it;
@@ -595,10 +922,10 @@ public:
 	 * Starts at the beginning of the iteration.
 	 */
 	template <typename... Callables>
-	[[nodiscard]] const_range_iterator<data_t, metadata_t, key_t, keys_t...>
-	get_const_range_iterator_begin(Callables&&...fs) const noexcept
+	[[nodiscard]] const_range_iterator_t
+	get_const_range_iterator_begin(Callables&&...fs) const
 	{
-		const_range_iterator<data_t, metadata_t, key_t, keys_t...> it;
+		const_range_iterator_t it;
 		it.set_functions(std::forward<Callables>(fs)...);
 		it.set_pointer(this);
 		[[maybe_unused]] const bool _ = it.to_begin();
@@ -610,10 +937,10 @@ public:
 	 * Starts at the end of the iteration.
 	 */
 	template <typename... Callables>
-	[[nodiscard]] const_range_iterator<data_t, metadata_t, key_t, keys_t...>
-	get_const_range_iterator_end(Callables&&...fs) const noexcept
+	[[nodiscard]] const_range_iterator_t
+	get_const_range_iterator_end(Callables&&...fs) const
 	{
-		const_range_iterator<data_t, metadata_t, key_t, keys_t...> it;
+		const_range_iterator_t it;
 		it.set_functions(std::forward<Callables>(fs)...);
 		it.set_pointer(this);
 		[[maybe_unused]] const bool _ = it.to_end();
@@ -646,10 +973,16 @@ public:
 
 private:
 
+	/// Constructor from the children of the node and the size of the tree.
+	basic_ctree(container_t&& children, const size_type size) noexcept
+		: m_children(std::move(children)),
+		  m_size(size)
+	{ }
+
 	/// The set of keys and their associated subtree of this tree's node.
 	container_t m_children;
 	/// The number of unique elements over all leaves of this tree.
-	size_t m_size = 0;
+	size_type m_size = 0;
 
 private:
 
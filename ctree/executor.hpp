@@ -0,0 +1,438 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <condition_variable>
+#include <type_traits>
+#include <exception>
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <deque>
+
+// ctree includes
+#include <ctree/parallel.hpp>
+
+namespace classtree {
+namespace detail {
+
+/// A task of a parallel operation, as seen by @ref Executor.
+struct task_archetype {
+	void operator() (const std::size_t, const std::size_t) const;
+};
+
+} // namespace detail
+
+/**
+ * @brief Runs the tasks of the parallel operations on trees.
+ *
+ * The call @e e.bulk(n,work) runs @e work(w,i) for every @e i in [0,n),
+ * where @e w in [0,e.num_workers()) is the index of the worker that runs
+ * the task, and returns when all the tasks have finished. No two tasks run
+ * on the same worker at the same time, so @e w can select per-thread
+ * resources (for example, allocators). If a task throws, the exception is
+ * rethrown by @e bulk. A task may call @e bulk again.
+ */
+template <typename executor_t>
+concept Executor = requires(
+	executor_t& e, const std::size_t n, const detail::task_archetype& work
+) {
+	{ e.num_workers() } -> std::convertible_to<std::size_t>;
+	e.bulk(n, work);
+};
+
+/// An executor that runs all the tasks on the calling thread.
+class inline_executor {
+public:
+	/// The number of workers: 1.
+	[[nodiscard]] std::size_t num_workers() const noexcept
+	{
+		return 1;
+	}
+
+	/**
+	 * @brief Runs @e num_tasks tasks, in increasing order of index.
+	 * @param num_tasks Number of tasks.
+	 * @param work Function called as @e work(0,i) to run the @e i-th task.
+	 */
+	template <typename work_t>
+	void bulk(const std::size_t num_tasks, const work_t& work) const
+	{
+		for (std::size_t i = 0; i < num_tasks; ++i) {
+			work(0, i);
+		}
+	}
+};
+
+/**
+ * @brief An executor that starts new threads for every call to @ref bulk.
+ *
+ * Calls to @ref bulk made from a task run the tasks on the worker of the
+ * calling task.
+ */
+class thread_executor {
+public:
+	/**
+	 * @brief Constructor.
+	 * @param num_threads Number of threads. Must be at least 1.
+	 */
+	explicit thread_executor(const std::size_t num_threads) noexcept
+		: m_num_threads(num_threads)
+	{ }
+
+	/// The number of workers.
+	[[nodiscard]] std::size_t num_workers() const noexcept
+	{
+		return m_num_threads;
+	}
+
+	/**
+	 * @brief Runs @e num_tasks tasks (see @ref detail::parallel_for).
+	 * @param num_tasks Number of tasks.
+	 * @param work Function called as @e work(w,i) to run the @e i-th task on
+	 * the @e w-th worker.
+	 */
+	template <typename work_t>
+	void bulk(const std::size_t num_tasks, const work_t& work) const
+	{
+		if (s_worker != nullptr) {
+			const std::size_t w = *s_worker;
+			for (std::size_t i = 0; i < num_tasks; ++i) {
+				work(w, i);
+			}
+			return;
+		}
+
+		detail::parallel_for(
+			num_tasks,
+			m_num_threads,
+			[&](const std::size_t w, const std::size_t i)
+			{
+				s_worker = &w;
+				try {
+					work(w, i);
+				}
+				catch (...) {
+					s_worker = nullptr;
+					throw;
+				}
+				s_worker = nullptr;
+			}
+		);
+	}
+
+private:
+	/// Number of threads.
+	std::size_t m_num_threads;
+	/// The index of the worker of the task running on this thread, if any.
+	static inline thread_local const std::size_t *s_worker = nullptr;
+};
+
+/**
+ * @brief A pool of threads that balances the tasks by work stealing.
+ *
+ * Every worker has a queue of ranges of tasks. A worker takes the range at
+ * the back of its own queue, and when the queue is empty it steals the
+ * range at the front of the queue of another worker. Before running the
+ * first task of a range, the worker splits the range in halves and pushes
+ * the second half back to its queue, so that idle workers can steal large
+ * ranges while the tasks of a range are run in order of index.
+ *
+ * A call to @ref bulk made from a task pushes the new tasks to the queue of
+ * the worker and runs tasks until they are all finished, so that recursive
+ * operations on subtrees do not block any worker. A call made from any
+ * other thread waits for the tasks to finish.
+ */
+class work_stealing_pool {
+public:
+	/**
+	 * @brief Constructor. Starts the threads.
+	 * @param num_threads Number of threads. Must be at least 1.
+	 */
+	explicit work_stealing_pool(const std::size_t num_threads)
+		: m_queues(num_threads)
+	{
+		m_threads.reserve(num_threads);
+		for (std::size_t w = 0; w < num_threads; ++w) {
+			m_threads.emplace_back([this, w]() { work_loop(w); });
+		}
+	}
+
+	/// Destructor. Stops the threads; no tasks must be pending.
+	~work_stealing_pool()
+	{
+		{
+			const std::lock_guard lock(m_sleep_mutex);
+			m_stop = true;
+		}
+		m_wake.notify_all();
+		m_threads.clear();
+	}
+
+	work_stealing_pool(const work_stealing_pool&) = delete;
+	work_stealing_pool& operator= (const work_stealing_pool&) = delete;
+
+	/// The number of workers.
+	[[nodiscard]] std::size_t num_workers() const noexcept
+	{
+		return m_queues.size();
+	}
+
+	/**
+	 * @brief Runs @e num_tasks tasks on the workers of the pool.
+	 *
+	 * If a task throws, the tasks that have not started are skipped and the
+	 * first exception is rethrown.
+	 * @param num_tasks Number of tasks.
+	 * @param work Function called as @e work(w,i) to run the @e i-th task on
+	 * the @e w-th worker.
+	 */
+	template <typename work_t>
+	void bulk(const std::size_t num_tasks, const work_t& work)
+	{
+		if (num_tasks == 0) {
+			return;
+		}
+
+		group g;
+		g.work = &work;
+		g.run = [](const void *f, const std::size_t w, const std::size_t i)
+		{ (*static_cast<const work_t *>(f))(w, i); };
+		g.pending = num_tasks;
+
+		if (s_pool == this) {
+			// called from a task: help until the tasks are finished
+			const std::size_t w = s_worker;
+			push(w, range{&g, 0, num_tasks});
+			while (g.pending.load() != 0) {
+				if (not run_one(w)) {
+					std::this_thread::yield();
+				}
+			}
+		}
+		else {
+			push(m_next_queue++ % m_queues.size(), range{&g, 0, num_tasks});
+		}
+
+		std::unique_lock lock(g.mutex);
+		g.finished.wait(lock, [&]() { return g.done; });
+		lock.unlock();
+
+		if (g.error) {
+			std::rethrow_exception(g.error);
+		}
+	}
+
+private:
+	/// The tasks of one call to @ref bulk.
+	struct group {
+		/// The function of the tasks.
+		const void *work = nullptr;
+		/// Calls @ref work.
+		void (*run)(const void *, std::size_t, std::size_t) = nullptr;
+		/// Number of tasks not finished.
+		std::atomic<std::size_t> pending{0};
+		/// Has a task thrown?
+		std::atomic<bool> failed{false};
+		/// The first exception thrown by a task.
+		std::exception_ptr error;
+		/// Have all the tasks finished?
+		bool done = false;
+		/// Protects @ref error and @ref done.
+		std::mutex mutex;
+		/// Notified when all the tasks have finished.
+		std::condition_variable finished;
+	};
+
+	/// A range of tasks of a group.
+	struct range {
+		/// The group of the tasks.
+		group *g;
+		/// First task.
+		std::size_t first;
+		/// Last + 1 task.
+		std::size_t last;
+	};
+
+	/// The queue of a worker.
+	struct queue {
+		/// Protects @ref ranges.
+		std::mutex mutex;
+		/// The ranges of tasks.
+		std::deque<range> ranges;
+	};
+
+	/// Pushes a range to the queue of worker @e w and wakes the workers.
+	void push(const std::size_t w, const range r)
+	{
+		{
+			const std::lock_guard lock(m_queues[w].mutex);
+			m_queues[w].ranges.push_back(r);
+		}
+		++m_num_queued;
+		{
+			const std::lock_guard lock(m_sleep_mutex);
+		}
+		m_wake.notify_all();
+	}
+
+	/**
+	 * @brief Takes a range from the queue of worker @e w, or steals one.
+	 * @returns Whether a range was found.
+	 */
+	[[nodiscard]] bool take(const std::size_t w, range& r)
+	{
+		{
+			const std::lock_guard lock(m_queues[w].mutex);
+			if (not m_queues[w].ranges.empty()) {
+				r = m_queues[w].ranges.back();
+				m_queues[w].ranges.pop_back();
+				--m_num_queued;
+				return true;
+			}
+		}
+		for (std::size_t j = 1; j < m_queues.size(); ++j) {
+			queue& q = m_queues[(w + j) % m_queues.size()];
+			const std::lock_guard lock(q.mutex);
+			if (not q.ranges.empty()) {
+				r = q.ranges.front();
+				q.ranges.pop_front();
+				--m_num_queued;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Runs the first task of a range on worker @e w.
+	 * @returns Whether a range was found.
+	 */
+	bool run_one(const std::size_t w)
+	{
+		range r;
+		if (not take(w, r)) {
+			return false;
+		}
+		if (r.last - r.first > 1) {
+			// the rest of the range, in halves: the second can be stolen
+			const std::size_t first = r.first + 1;
+			const std::size_t mid = first + (r.last - first) / 2;
+			push(w, range{r.g, mid, r.last});
+			if (first < mid) {
+				push(w, range{r.g, first, mid});
+			}
+		}
+
+		group& g = *r.g;
+		if (not g.failed.load()) {
+			try {
+				g.run(g.work, w, r.first);
+			}
+			catch (...) {
+				const std::lock_guard lock(g.mutex);
+				if (not g.error) {
+					g.error = std::current_exception();
+				}
+				g.failed = true;
+			}
+		}
+		if (g.pending.fetch_sub(1) == 1) {
+			// the group is destroyed once its mutex is released
+			const std::lock_guard lock(g.mutex);
+			g.done = true;
+			g.finished.notify_all();
+		}
+		return true;
+	}
+
+	/// The loop of the thread of worker @e w.
+	void work_loop(const std::size_t w)
+	{
+		s_pool = this;
+		s_worker = w;
+		while (true) {
+			if (run_one(w)) {
+				continue;
+			}
+			std::unique_lock lock(m_sleep_mutex);
+			m_wake.wait(
+				lock, [this]() { return m_stop or m_num_queued.load() > 0; }
+			);
+			if (m_stop) {
+				return;
+			}
+		}
+	}
+
+private:
+	/// The queue of every worker.
+	std::vector<queue> m_queues;
+	/// Number of ranges in the queues.
+	std::atomic<std::size_t> m_num_queued{0};
+	/// The queue of the next call to @ref bulk from outside the pool.
+	std::atomic<std::size_t> m_next_queue{0};
+	/// Protects @ref m_stop and the sleep of the workers.
+	std::mutex m_sleep_mutex;
+	/// Wakes the workers.
+	std::condition_variable m_wake;
+	/// Must the workers stop?
+	bool m_stop = false;
+	/// The threads of the workers.
+	std::vector<std::jthread> m_threads;
+
+	/// The pool of the worker running on this thread, if any.
+	static inline thread_local const work_stealing_pool *s_pool = nullptr;
+	/// The index of the worker running on this thread.
+	static inline thread_local std::size_t s_worker = 0;
+};
+
+namespace detail {
+
+/**
+ * @brief Is a subtree too large to be a single task?
+ *
+ * Parallel operations split a subtree into one task per child when it
+ * holds more than a fraction of the elements of the tree, so that a tree
+ * with a few very large subtrees still keeps all the workers busy.
+ * @param size Size of the subtree.
+ * @param total Size of the tree.
+ * @param num_workers Number of workers of the executor.
+ */
+[[nodiscard]] constexpr bool is_large_task(
+	const std::size_t size,
+	const std::size_t total,
+	const std::size_t num_workers
+) noexcept
+{
+	return num_workers > 1 and size * 4 * num_workers > total;
+}
+
+} // namespace detail
+} // namespace classtree
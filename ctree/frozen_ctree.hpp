@@ -0,0 +1,643 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <array>
+#include <tuple>
+#include <span>
+
+// ctree includes
+#include <ctree/concepts.hpp>
+#include <ctree/types.hpp>
+
+namespace classtree {
+
+/**
+ * @brief An immutable Classification Tree that can be built at compile time.
+ *
+ * This tree is made from a fixed list of @e N tuples (keys..., element) (see
+ * @ref make_frozen_ctree). Its entries are stored in a @e std::array sorted by
+ * their keys, so that every leaf of the equivalent @ref basic_ctree is a
+ * contiguous range of entries, and every internal node is a contiguous range
+ * of leaves. Entries with the same keys are sorted by their data when
+ * @e data_t is @ref LessthanComparable, and keep their relative order
+ * otherwise. Entries are never merged, as in @ref basic_ctree::add with
+ * @e unique set to false.
+ *
+ * All member functions are @e constexpr, so that a tree declared as
+ * @code
+ * static constexpr auto table =
+ *     classtree::make_frozen_ctree<data, void, int, char>({
+ *         {1, 'a', data{...}},
+ *         ...
+ *     });
+ * @endcode
+ * has no construction cost at run time and lookups can be evaluated at
+ * compile time.
+ * @tparam data_t Type of the values stored.
+ * @tparam metadata_t Type of the metadata associated to the values.
+ * @tparam N Number of entries.
+ * @tparam keys_t The types of the keys.
+ */
+template <
+	typename data_t,
+	typename metadata_t,
+	std::size_t N,
+	Comparable... keys_t>
+class frozen_ctree {
+public:
+
+	/// Shorthand for a useful type.
+	using leaf_element_t = element_t<data_t, metadata_t>;
+
+	/// The keys of an entry.
+	using keys_type = std::tuple<keys_t...>;
+
+	/// The tuple from which an entry is made: keys first, element last.
+	using input_t = std::tuple<keys_t..., leaf_element_t>;
+
+	/// An entry of the tree: the keys and the element they classify.
+	struct entry_t {
+		/// The keys of the element.
+		keys_type keys;
+		/// The element.
+		leaf_element_t element;
+	};
+
+	/// Number of keys.
+	static constexpr std::size_t num_levels = sizeof...(keys_t);
+
+	/// Direct access to a nice property of @ref element_t.
+	static constexpr bool is_compound = Compound<data_t, metadata_t>;
+
+	/**
+	 * @brief Iterator over the entries of the tree.
+	 *
+	 * It has the same interface as @ref basic_const_range_iterator. With no
+	 * functions, it iterates over all the entries of the tree.
+	 * @tparam Callables The types of the predicates on each key.
+	 */
+	template <typename... Callables>
+	class range_iterator;
+
+	/// Iterator over all the entries of the tree.
+	using const_iterator_t = range_iterator<>;
+
+public:
+
+	/**
+	 * @brief Constructor from a list of tuples (keys..., element).
+	 * @param entries The entries of the tree.
+	 */
+	constexpr frozen_ctree(const input_t (&entries)[N])
+		: m_entries(sort_entries(std::span<const input_t, N>(entries)))
+	{ }
+	/**
+	 * @brief Constructor from an array of tuples (keys..., element).
+	 * @param entries The entries of the tree.
+	 */
+	constexpr frozen_ctree(const std::array<input_t, N>& entries)
+		: m_entries(sort_entries(std::span<const input_t, N>(entries)))
+	{ }
+
+	/// The number of elements in this tree.
+	[[nodiscard]] static constexpr std::size_t size() noexcept
+	{
+		return N;
+	}
+
+	/// The entries of this tree, sorted by keys.
+	[[nodiscard]] constexpr std::span<const entry_t, N> entries() const noexcept
+	{
+		return m_entries;
+	}
+
+	/**
+	 * @brief The elements classified under the given keys.
+	 * @param ks The values of the keys.
+	 * @returns The (possibly empty) range of entries with keys @e ks.
+	 */
+	[[nodiscard]] constexpr std::span<const entry_t>
+	leaf(const keys_t&...ks) const noexcept
+	{
+		const keys_type k{ks...};
+		const auto [first, last] = std::equal_range(
+			m_entries.begin(), m_entries.end(), k, entry_key_less{}
+		);
+		return {first, last};
+	}
+
+	/**
+	 * @brief Is there any element classified under the given keys?
+	 * @param ks The values of the keys.
+	 */
+	[[nodiscard]] constexpr bool has_keys(const keys_t&...ks) const noexcept
+	{
+		return not leaf(ks...).empty();
+	}
+
+	/**
+	 * @brief Finds an element.
+	 * @param d The data of the element.
+	 * @param ks The values of the keys of the element.
+	 * @returns A pointer to the element, or a null pointer if it does not
+	 * exist.
+	 */
+	[[nodiscard]] constexpr const leaf_element_t *
+	find(const data_t& d, const keys_t&...ks) const noexcept
+	{
+		for (const entry_t& e : leaf(ks...)) {
+			if (data_of(e.element) == d) {
+				return &e.element;
+			}
+		}
+		return nullptr;
+	}
+
+	/// Returns an iterator over all the entries.
+	[[nodiscard]] constexpr const_iterator_t get_const_iterator() const noexcept
+	{
+		return const_iterator_t(this);
+	}
+	/// Returns an iterator over all the entries, placed at the beginning.
+	[[nodiscard]] constexpr const_iterator_t
+	get_const_iterator_begin() const noexcept
+	{
+		const_iterator_t it(this);
+		[[maybe_unused]] const bool _ = it.to_begin();
+		return it;
+	}
+	/// Returns an iterator over all the entries, placed at the end.
+	[[nodiscard]] constexpr const_iterator_t
+	get_const_iterator_end() const noexcept
+	{
+		const_iterator_t it(this);
+		[[maybe_unused]] const bool _ = it.to_end();
+		return it;
+	}
+
+	/**
+	 * @brief Returns a range iterator.
+	 * @param fs One predicate for every key.
+	 */
+	template <typename... Callables>
+	[[nodiscard]] constexpr range_iterator<std::remove_cvref_t<Callables>...>
+	get_const_range_iterator(Callables&&...fs) const
+	{
+		return range_iterator<std::remove_cvref_t<Callables>...>(
+			this, std::forward<Callables>(fs)...
+		);
+	}
+	/**
+	 * @brief Returns a range iterator placed at the beginning.
+	 * @param fs One predicate for every key.
+	 */
+	template <typename... Callables>
+	[[nodiscard]] constexpr range_iterator<std::remove_cvref_t<Callables>...>
+	get_const_range_iterator_begin(Callables&&...fs) const
+	{
+		auto it = get_const_range_iterator(std::forward<Callables>(fs)...);
+		[[maybe_unused]] const bool _ = it.to_begin();
+		return it;
+	}
+	/**
+	 * @brief Returns a range iterator placed at the end.
+	 * @param fs One predicate for every key.
+	 */
+	template <typename... Callables>
+	[[nodiscard]] constexpr range_iterator<std::remove_cvref_t<Callables>...>
+	get_const_range_iterator_end(Callables&&...fs) const
+	{
+		auto it = get_const_range_iterator(std::forward<Callables>(fs)...);
+		[[maybe_unused]] const bool _ = it.to_end();
+		return it;
+	}
+
+private:
+
+	/// Returns the data of an element.
+	[[nodiscard]] static constexpr const data_t&
+	data_of(const leaf_element_t& e) noexcept
+	{
+		if constexpr (is_compound) {
+			return e.data;
+		}
+		else {
+			return e;
+		}
+	}
+
+	/// Compares the keys of entries with keys.
+	struct entry_key_less {
+		[[nodiscard]] constexpr bool
+		operator() (const entry_t& e, const keys_type& k) const noexcept
+		{
+			return e.keys < k;
+		}
+		[[nodiscard]] constexpr bool
+		operator() (const keys_type& k, const entry_t& e) const noexcept
+		{
+			return k < e.keys;
+		}
+	};
+
+	/**
+	 * @brief Compares the first @e n keys of two entries.
+	 * @returns A negative value, zero or a positive value if the first @e n
+	 * keys of @e a are less than, equal to or greater than those of @e b.
+	 */
+	template <std::size_t I = 0>
+	[[nodiscard]] static constexpr int compare_prefix(
+		const keys_type& a, const keys_type& b, const std::size_t n
+	) noexcept
+	{
+		if constexpr (I == num_levels) {
+			return 0;
+		}
+		else {
+			if (I == n) {
+				return 0;
+			}
+			if (std::get<I>(a) < std::get<I>(b)) {
+				return -1;
+			}
+			if (std::get<I>(b) < std::get<I>(a)) {
+				return 1;
+			}
+			return compare_prefix<I + 1>(a, b, n);
+		}
+	}
+
+	/// Sorts the entries by keys (and data), keeping the input order of ties.
+	[[nodiscard]] static constexpr std::array<entry_t, N>
+	sort_entries(const std::span<const input_t, N> entries)
+	{
+		std::array<std::size_t, N> order{};
+		for (std::size_t i = 0; i < N; ++i) {
+			order[i] = i;
+		}
+
+		std::sort(
+			order.begin(),
+			order.end(),
+			[&](const std::size_t a, const std::size_t b) -> bool
+			{
+				const int c = compare_inputs(entries[a], entries[b]);
+				return c < 0 or (c == 0 and a < b);
+			}
+		);
+
+		return [&]<std::size_t... I>(std::index_sequence<I...>)
+		{
+			return std::array<entry_t, N>{make_entry(entries[order[I]])...};
+		}(std::make_index_sequence<N>{});
+	}
+
+	/// Compares two input tuples by keys, and by data if possible.
+	[[nodiscard]] static constexpr int
+	compare_inputs(const input_t& a, const input_t& b) noexcept
+	{
+		const int c = [&]<std::size_t... I>(std::index_sequence<I...>)
+		{
+			return compare_prefix(
+				keys_type{std::get<I>(a)...},
+				keys_type{std::get<I>(b)...},
+				num_levels
+			);
+		}(std::make_index_sequence<num_levels>{});
+
+		if constexpr (LessthanComparable<data_t>) {
+			if (c == 0) {
+				const data_t& da = data_of(std::get<num_levels>(a));
+				const data_t& db = data_of(std::get<num_levels>(b));
+				return da < db ? -1 : (db < da ? 1 : 0);
+			}
+		}
+		return c;
+	}
+
+	/// Makes an entry from an input tuple.
+	[[nodiscard]] static constexpr entry_t make_entry(const input_t& e)
+	{
+		return [&]<std::size_t... I>(std::index_sequence<I...>)
+		{
+			return entry_t{
+				keys_type{std::get<I>(e)...}, std::get<num_levels>(e)
+			};
+		}(std::make_index_sequence<num_levels>{});
+	}
+
+private:
+
+	/// The entries, sorted by keys.
+	std::array<entry_t, N> m_entries;
+};
+
+template <
+	typename data_t,
+	typename metadata_t,
+	std::size_t N,
+	Comparable... keys_t>
+template <typename... Callables>
+class frozen_ctree<data_t, metadata_t, N, keys_t...>::range_iterator {
+public:
+
+	static_assert(
+		sizeof...(Callables) == 0 or sizeof...(Callables) == num_levels or
+			sizeof...(Callables) == num_levels + 1,
+		"There must be one function per key (plus, optionally, one function "
+		"over the elements), or none."
+	);
+
+public:
+
+	/**
+	 * @brief Constructor with tree and predicates.
+	 * @param tree The tree to iterate on.
+	 * @param fs One predicate for every key and, optionally, a last predicate
+	 * over the elements; or none.
+	 */
+	template <typename... Fs>
+	constexpr range_iterator(const frozen_ctree *tree, Fs&&...fs)
+		: m_tree(tree),
+		  m_funcs(std::forward<Fs>(fs)...)
+	{ }
+
+	/**
+	 * @brief Place the iterator at the beginning of the iteration.
+	 * @returns True if there is any entry within the range.
+	 */
+	[[nodiscard]] constexpr bool to_begin() noexcept
+	{
+		initialize_limits();
+		m_idx = m_first;
+		m_past_begin = m_first == m_last;
+		return not m_past_begin;
+	}
+	/**
+	 * @brief Place the iterator at the end of the iteration.
+	 * @returns True if there is any entry within the range.
+	 */
+	[[nodiscard]] constexpr bool to_end() noexcept
+	{
+		initialize_limits();
+		if (m_first == m_last) {
+			m_idx = m_last;
+			m_past_begin = true;
+			return false;
+		}
+		m_idx = m_last - 1;
+		m_past_begin = false;
+		return true;
+	}
+
+	/// Advance one step in the iteration.
+	constexpr void operator++ () noexcept
+	{
+		if (m_past_begin) [[unlikely]] {
+			m_past_begin = false;
+			return;
+		}
+		m_idx = m_idx + 1 < m_last ? next_match(m_idx + 1) : m_last;
+	}
+	/// Move back one step in the iteration.
+	constexpr void operator-- () noexcept
+	{
+		if (m_idx == m_first) [[unlikely]] {
+			m_past_begin = true;
+			return;
+		}
+		m_idx = previous_match(m_idx - 1);
+	}
+
+	/// Is the iteration at the beginning?
+	[[nodiscard]] constexpr bool begin() const noexcept
+	{
+		return not m_past_begin and m_first != m_last and m_idx == m_first;
+	}
+	/// Is the iteration past the beginning?
+	[[nodiscard]] constexpr bool past_begin() const noexcept
+	{
+		return m_past_begin;
+	}
+	/// Is the iteration at the end?
+	[[nodiscard]] constexpr bool end() const noexcept
+	{
+		return m_idx == m_last;
+	}
+
+	/// Returns the current element of the iteration.
+	[[nodiscard]] constexpr const leaf_element_t& operator* () const noexcept
+	{
+		return m_tree->m_entries[m_idx].element;
+	}
+	/// Returns the current element of the iteration and its keys.
+	[[nodiscard]] constexpr std::tuple<leaf_element_t, keys_t...>
+	operator+ () const noexcept
+	{
+		const entry_t& e = m_tree->m_entries[m_idx];
+		return std::tuple_cat(std::tuple<leaf_element_t>(e.element), e.keys);
+	}
+
+	/// Count the number of elements that match the search criteria.
+	[[nodiscard]] constexpr std::size_t count() const noexcept
+	{
+		std::size_t c = 0;
+		for (std::size_t i = next_match(0); i < N; i = next_match(i + 1)) {
+			++c;
+		}
+		return c;
+	}
+
+private:
+
+	/// Computes the first and last + 1 positions within the range.
+	constexpr void initialize_limits() noexcept
+	{
+		m_first = next_match(0);
+		m_last = m_first == N ? N : previous_match(N - 1) + 1;
+	}
+
+	/**
+	 * @brief The first key of @e k that does not satisfy its predicate.
+	 * @returns The index of the key, or @ref num_levels if all keys satisfy
+	 * their predicates.
+	 */
+	[[nodiscard]] constexpr std::size_t failing_level(const keys_type& k
+	) const noexcept
+	{
+		if constexpr (sizeof...(Callables) == 0) {
+			return num_levels;
+		}
+		else {
+			std::size_t level = num_levels;
+			[&]<std::size_t... I>(std::index_sequence<I...>)
+			{
+				(void)((std::get<I>(m_funcs)(std::get<I>(k)) or
+						(level = I, false)) and
+					   ...);
+			}(std::make_index_sequence<num_levels>{});
+			return level;
+		}
+	}
+
+	/// Does the element satisfy the predicate over the elements, if any?
+	[[nodiscard]] constexpr bool element_matches(const leaf_element_t& e
+	) const noexcept
+	{
+		if constexpr (sizeof...(Callables) == num_levels + 1) {
+			return std::get<num_levels>(m_funcs)(e);
+		}
+		else {
+			return true;
+		}
+	}
+
+	/**
+	 * @brief The first position at or after @e i within the range.
+	 *
+	 * When a key of an entry does not satisfy its predicate, all the entries
+	 * that share that key and the previous ones (the whole subtree) are
+	 * skipped.
+	 * @returns The position, or @e N if there is none.
+	 */
+	[[nodiscard]] constexpr std::size_t next_match(std::size_t i
+	) const noexcept
+	{
+		const auto& entries = m_tree->m_entries;
+		while (i < N) {
+			const keys_type& k = entries[i].keys;
+			const std::size_t l = failing_level(k);
+			if (l == num_levels) {
+				if (element_matches(entries[i].element)) {
+					return i;
+				}
+				++i;
+				continue;
+			}
+			const auto it = std::partition_point(
+				entries.begin() + static_cast<std::ptrdiff_t>(i),
+				entries.end(),
+				[&](const entry_t& e) -> bool
+				{
+					return compare_prefix(e.keys, k, l + 1) == 0;
+				}
+			);
+			i = static_cast<std::size_t>(it - entries.begin());
+		}
+		return N;
+	}
+
+	/**
+	 * @brief The last position at or before @e i within the range.
+	 *
+	 * Skips whole subtrees as in @ref next_match.
+	 * @returns The position, or @e N if there is none.
+	 */
+	[[nodiscard]] constexpr std::size_t previous_match(std::size_t i
+	) const noexcept
+	{
+		const auto& entries = m_tree->m_entries;
+		while (true) {
+			const keys_type& k = entries[i].keys;
+			const std::size_t l = failing_level(k);
+			if (l == num_levels) {
+				if (element_matches(entries[i].element)) {
+					return i;
+				}
+				if (i == 0) {
+					return N;
+				}
+				--i;
+				continue;
+			}
+			const auto it = std::partition_point(
+				entries.begin(),
+				entries.begin() + static_cast<std::ptrdiff_t>(i),
+				[&](const entry_t& e) -> bool
+				{
+					return compare_prefix(e.keys, k, l + 1) < 0;
+				}
+			);
+			const auto first = static_cast<std::size_t>(it - entries.begin());
+			if (first == 0) {
+				return N;
+			}
+			i = first - 1;
+		}
+	}
+
+private:
+
+	/// The tree iterated on.
+	const frozen_ctree *m_tree;
+	/// The predicates, one per key, and the predicate over the elements.
+	std::tuple<Callables...> m_funcs;
+
+	/// Current position.
+	std::size_t m_idx = N;
+	/// First position within the range.
+	std::size_t m_first = N;
+	/// Last + 1 position within the range.
+	std::size_t m_last = N;
+
+	/// Has the iterator reached the beginning and tried to move back?
+	bool m_past_begin = true;
+};
+
+/**
+ * @brief Makes a @ref frozen_ctree from a list of tuples (keys..., element).
+ *
+ * Usage:
+ * @code
+ * constexpr auto t = classtree::make_frozen_ctree<int, void, int, char>({
+ *     {1, 'a', 10},
+ *     {2, 'b', 20},
+ * });
+ * @endcode
+ * @tparam data_t Type of the values stored.
+ * @tparam metadata_t Type of the metadata associated to the values.
+ * @tparam keys_t The types of the keys.
+ * @tparam N Number of entries (deduced).
+ * @param entries The entries of the tree.
+ */
+template <
+	typename data_t,
+	typename metadata_t,
+	Comparable... keys_t,
+	std::size_t N>
+[[nodiscard]] constexpr frozen_ctree<data_t, metadata_t, N, keys_t...>
+make_frozen_ctree(
+	const std::tuple<keys_t..., element_t<data_t, metadata_t>> (&entries)[N]
+)
+{
+	return frozen_ctree<data_t, metadata_t, N, keys_t...>(entries);
+}
+
+} // namespace classtree
@@ -0,0 +1,123 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include <cmath>
+#include <span>
+
+namespace classtree {
+
+/**
+ * @brief Growth of the nodes of one level of a tree.
+ *
+ * An empty node reserves @ref initial elements when it receives its first
+ * element, and a full node grows to @ref factor times its capacity.
+ */
+struct level_growth {
+	/// Largest initial capacity accepted when a policy is read.
+	static constexpr std::size_t max_initial = std::size_t{1} << 32;
+	/// Largest growth factor accepted when a policy is read.
+	static constexpr double max_factor = 16.0;
+
+	/// Capacity of an empty node after its first element is added.
+	std::size_t initial = 1;
+	/// Growth factor of a full node.
+	double factor = 2.0;
+
+	/**
+	 * @brief The capacity of a node after it grows.
+	 * @param capacity The current capacity of the node.
+	 * @returns A capacity strictly larger than @e capacity, or the largest
+	 * value of @e std::size_t.
+	 */
+	[[nodiscard]] std::size_t next_capacity(const std::size_t capacity
+	) const noexcept
+	{
+		constexpr std::size_t max = std::numeric_limits<std::size_t>::max();
+		if (capacity == 0) {
+			return std::max<std::size_t>(initial, 1);
+		}
+		if (capacity == max) [[unlikely]] {
+			return max;
+		}
+		const double grown = std::ceil(static_cast<double>(capacity) * factor);
+		// a value that does not fit cannot be converted (also for NaN)
+		if (not(grown < static_cast<double>(max))) [[unlikely]] {
+			return max;
+		}
+		return std::max(static_cast<std::size_t>(grown), capacity + 1);
+	}
+};
+
+/**
+ * @brief Growth policy of the nodes of a tree, one entry per level.
+ *
+ * Level 0 is the root, and the last level (the number of keys) holds the
+ * leaves. When the policy has fewer levels than the tree, the nodes of the
+ * deeper levels grow by doubling their capacity.
+ *
+ * A policy can be learned from a tree that has already been built (see
+ * @ref learn_growth_policy) and be used to add elements to a new tree (see
+ * @ref basic_ctree::add_with_policy).
+ */
+struct growth_policy {
+	/// The growth of every level.
+	std::vector<level_growth> levels;
+};
+
+namespace detail {
+
+/**
+ * @brief Makes room in a container for one more element.
+ *
+ * Does nothing if there is no policy for this level or there is room for
+ * one more element.
+ * @param c The container of a node.
+ * @param levels The growth policy from the level of the node downwards.
+ */
+template <typename container_t>
+void grow(container_t& c, const std::span<const level_growth> levels)
+{
+	if (not levels.empty() and c.size() == c.capacity()) {
+		c.reserve(levels.front().next_capacity(c.capacity()));
+	}
+}
+
+/**
+ * @brief The policy for the levels below the current one.
+ * @param levels The growth policy from the level of the node downwards.
+ */
+[[nodiscard]] inline std::span<const level_growth>
+next_levels(const std::span<const level_growth> levels) noexcept
+{
+	return levels.empty() ? levels : levels.subspan(1);
+}
+
+} // namespace detail
+} // namespace classtree
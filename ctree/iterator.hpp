@@ -24,16 +24,23 @@
 #pragma once
 
 // C++ includes
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <array>
 #include <tuple>
 
 // ctree includes
 #include <ctree/ctree.hpp>
+#include <ctree/prefetch.hpp>
 
 namespace classtree {
 namespace detail {
 
 /**
  * @brief Partial template specialization of the @ref iterator_ class.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam tree_pointer_t Type of the pointer to the tree iterated on.
  * @tparam container_iterator_t Type of the iterator over the keys of the tree iterated on.
  * @tparam data_t Type of the values to add.
@@ -41,6 +48,7 @@ namespace detail {
  * @tparam keys_t Type of the remaining keys.
  */
 template <
+	template <typename> class allocator_t,
 	typename tree_pointer_t,
 	typename container_iterator_t,
 	typename data_t,
@@ -48,86 +56,26 @@ template <
 	Comparable... keys_t>
 class iterator_;
 
-/**
- * @brief Shorthand for the type of iterator over the children of the current subtree.
- * @tparam tree_pointer_t Type of the pointer to the tree iterated on.
- * @tparam data_t Type of the values to add.
- * @tparam metadata_t Type of the metadata associated to the values.
- * @tparam key_t Type of the first key.
- * @tparam keys_t Type of the remaining keys.
- */
-template <
-	typename tree_pointer_t,
-	typename data_t,
-	typename metadata_t,
-	Comparable key_t,
-	Comparable... keys_t>
-struct sub_iterator {
-
-	/// Is @e tree_pointer_t constant?
-	static constexpr bool is_constant = std::is_same_v<
-		tree_pointer_t,
-		const_pointer_t<data_t, metadata_t, key_t, keys_t...>>;
-
-	/// Shorthand for a non-constant pointer type.
-	using non_const_pointer_type = pointer_t<data_t, metadata_t, keys_t...>;
-	/// Shorthand for a constant pointer type.
-	using const_pointer_type = const_pointer_t<data_t, metadata_t, keys_t...>;
-
-	/// Shorthand for a non-constant iterator type.
-	using non_const_iterator_type = iterator_<
-		non_const_pointer_type,
-		typename ctree<data_t, metadata_t, keys_t...>::container_t::iterator,
-		data_t,
-		metadata_t,
-		keys_t...>;
-
-	/// Shorthand for a constant iterator type.
-	using const_iterator_type = iterator_<
-		const_pointer_type,
-		typename ctree<data_t, metadata_t, keys_t...>::container_t::
-			const_iterator,
-		data_t,
-		metadata_t,
-		keys_t...>;
-
-	/// Shorthand for the correct type of iterator over the current subtree.
-	using type = typename std::conditional_t<
-		is_constant,
-		const_iterator_type,
-		non_const_iterator_type>;
-};
-
-/**
- * @brief Shorthand for the type of iterator over the children of the current subtree.
- * @tparam tree_pointer_t Type of the pointer to the tree iterated on.
- * @tparam data_t Type of the values to add.
- * @tparam metadata_t Type of the metadata associated to the values.
- * @tparam key_t Type of the first key.
- * @tparam keys_t Type of the remaining keys.
- */
-template <
-	typename tree_pointer_t,
-	typename data_t,
-	typename metadata_t,
-	Comparable key_t,
-	Comparable... keys_t>
-using sub_iterator_t =
-	sub_iterator<tree_pointer_t, data_t, metadata_t, key_t, keys_t...>::type;
-
 /**
  * @brief Partial template specialization of the @ref iterator_ class.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam tree_pointer_t Type of the pointer to the tree iterated on.
  * @tparam container_iterator_t Type of the iterator over the keys of the tree iterated on.
  * @tparam data_t Type of the values to add.
  * @tparam metadata_t Type of the metadata associated to the values.
  */
 template <
+	template <typename> class allocator_t,
 	typename tree_pointer_t,
 	typename container_iterator_t,
 	typename data_t,
 	typename metadata_t>
-class iterator_<tree_pointer_t, container_iterator_t, data_t, metadata_t> {
+class iterator_<
+	allocator_t,
+	tree_pointer_t,
+	container_iterator_t,
+	data_t,
+	metadata_t> {
 public:
 
 	/// Shorthand for a useful type.
@@ -213,7 +161,9 @@ public:
 	template <
 		typename _inner_pointer_t = tree_pointer_t,
 		std::enable_if_t<
-			std::is_same_v<pointer_t<data_t, metadata_t>, _inner_pointer_t>,
+			std::is_same_v<
+				pointer_t<allocator_t, data_t, metadata_t>,
+				_inner_pointer_t>,
 			bool> = true>
 	leaf_element_t& operator* () noexcept
 	{
@@ -250,6 +200,16 @@ private:
 
 /**
  * @brief Partial template specialization of the @ref iterator_ class.
+ *
+ * The iterator keeps, for every level of the tree, a pointer to the node
+ * being iterated and the position of the current child (or element, at the
+ * leaves) in that node. Moving the iterator changes the position at the
+ * leaf and, only when the leaf is exhausted, finds the deepest level that
+ * can still move and descends from there.
+ *
+ * When the iteration is at the end, the position at every level is the
+ * number of children (or elements) of the last node of that level.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam tree_pointer_t Type of the pointer to the tree iterated on.
  * @tparam container_iterator_t Type of the iterator over the keys of the tree iterated on.
  * @tparam data_t Type of the values to add.
@@ -258,6 +218,7 @@ private:
  * @tparam keys_t Type of the remaining keys.
  */
 template <
+	template <typename> class allocator_t,
 	typename tree_pointer_t,
 	typename container_iterator_t,
 	typename data_t,
@@ -265,6 +226,7 @@ template <
 	Comparable key_t,
 	Comparable... keys_t>
 class iterator_<
+	allocator_t,
 	tree_pointer_t,
 	container_iterator_t,
 	data_t,
@@ -276,56 +238,92 @@ public:
 	/// Shorthand for a useful type.
 	using leaf_element_t = element_t<data_t, metadata_t>;
 
+private:
+
+	/// Number of keys of the tree. The leaves are at this depth.
+	static constexpr size_t num_keys = 1 + sizeof...(keys_t);
+
+	/// Is @e tree_pointer_t constant?
+	static constexpr bool is_constant =
+		std::is_const_v<std::remove_pointer_t<tree_pointer_t>>;
+
+	/// The type of the nodes at depth @e d.
+	template <size_t d>
+	using node_t = typename node_at<
+		basic_ctree<allocator_t, data_t, metadata_t, key_t, keys_t...>,
+		d>::type;
+
+	/// Pointer to a node at depth @e d.
+	template <size_t d>
+	using node_pointer_t =
+		std::conditional_t<is_constant, const node_t<d> *, node_t<d> *>;
+
+	/// Type of the positions within the nodes.
+	using size_type = typename node_t<0>::size_type;
+
+	/// The types of the pointers to the nodes of every level.
+	template <size_t... ds>
+	static auto make_nodes(std::index_sequence<ds...>)
+		-> std::tuple<node_pointer_t<ds>...>;
+
+	/// Pointers to the nodes of every level.
+	using nodes_t =
+		decltype(make_nodes(std::make_index_sequence<num_keys + 1>{}));
+
 public:
 
 	/// Set the pointer of the tree to iterate on.
 	void set_pointer(tree_pointer_t tree) noexcept
 	{
-		m_tree = tree;
+		std::get<0>(m_nodes) = tree;
 	}
 
 	/// Initialize the iteration at the beginning.
 	void to_begin() noexcept
 	{
-		if (m_tree->size() == 0) [[unlikely]] {
-			m_past_begin = true;
-			m_it = m_tree->end();
+		if (std::get<0>(m_nodes)->size() == 0) [[unlikely]] {
+			to_empty();
 			return;
 		}
 
 		m_past_begin = false;
-		m_it = m_tree->begin();
-		m_subtree_iterator.set_pointer(&m_it->second);
-		m_subtree_iterator.to_begin();
+		reset<true, 0>();
+		descend<true>(1);
 	}
 	/// Initialize the iteration at the end.
 	void to_end() noexcept
 	{
-		if (m_tree->size() == 0) [[unlikely]] {
-			m_past_begin = true;
-			m_it = m_tree->end();
+		if (std::get<0>(m_nodes)->size() == 0) [[unlikely]] {
+			to_empty();
 			return;
 		}
 
 		m_past_begin = false;
-		m_it = m_tree->end();
-		--m_it;
-		m_subtree_iterator.set_pointer(&m_it->second);
-		m_subtree_iterator.to_end();
+		reset<false, 0>();
+		descend<false>(1);
 	}
 
 	/// Advance one step in the iteration.
 	void operator++ () noexcept
 	{
-		m_past_begin = false;
-		++m_subtree_iterator;
-		if (m_subtree_iterator.end()) [[unlikely]] {
-			++m_it;
-			if (not shallow_end()) [[likely]] {
-				m_subtree_iterator.set_pointer(&m_it->second);
-				m_subtree_iterator.to_begin();
+		if (m_past_begin) [[unlikely]] {
+			m_past_begin = false;
+			return;
+		}
+		if (++m_pos[num_keys] < std::get<num_keys>(m_nodes)->size())
+			[[likely]] {
+			return;
+		}
+
+		const size_t d = deepest_movable<true>();
+		if (d == num_keys) [[unlikely]] {
+			// the end: every level is past its last child
+			for (size_t l = 0; l < num_keys; ++l) {
+				++m_pos[l];
 			}
+			return;
 		}
+		move<true>(d);
 	}
 	/**
 	 * @brief Move back one step in the iteration.
@@ -336,122 +334,204 @@ public:
 	 */
 	void operator-- () noexcept
 	{
-		--m_subtree_iterator;
-		if (m_subtree_iterator.past_begin()) [[unlikely]] {
-
-			if (shallow_begin()) [[unlikely]] {
-				m_past_begin = true;
-			}
-			else {
-				--m_it;
-				m_subtree_iterator.set_pointer(&m_it->second);
-				m_subtree_iterator.to_end();
+		if (end()) [[unlikely]] {
+			// back to the last child of every level
+			for (size_t l = 0; l <= num_keys; ++l) {
+				--m_pos[l];
 			}
+			return;
 		}
-		if (shallow_end()) {
-			--m_it;
+		if (m_pos[num_keys] > 0) [[likely]] {
+			--m_pos[num_keys];
+			return;
+		}
+
+		const size_t d = deepest_movable<false>();
+		if (d == num_keys) [[unlikely]] {
+			m_past_begin = true;
+			return;
 		}
+		move<false>(d);
 	}
 
 	/// Is the iteration at the beginning?
 	[[nodiscard]] bool begin() const noexcept
 	{
-		if (m_tree->size() == 0) [[unlikely]] {
+		if (std::get<0>(m_nodes)->size() == 0) [[unlikely]] {
 			return true;
 		}
-		return shallow_begin() and m_subtree_iterator.begin();
+		return not m_past_begin and
+			   std::all_of(
+				   m_pos.begin(),
+				   m_pos.end(),
+				   [](const size_type p) { return p == 0; }
+			   );
 	}
 	/// Is the iteration past the beginning?
 	[[nodiscard]] bool past_begin() const noexcept
 	{
-		if (m_tree->size() == 0) [[unlikely]] {
+		if (std::get<0>(m_nodes)->size() == 0) [[unlikely]] {
 			return true;
 		}
-		return shallow_past_begin() and m_subtree_iterator.past_begin();
+		return m_past_begin;
 	}
 	/// Is the iteration at the end?
 	[[nodiscard]] bool end() const noexcept
 	{
-		if (m_tree->size() == 0) [[unlikely]] {
-			return true;
-		}
-		return shallow_end() and m_subtree_iterator.end();
+		return m_pos[0] == std::get<0>(m_nodes)->num_keys();
 	}
 
 	/// Returns the current value of the iteration.
 	template <
-		typename _inner_pointer_t = tree_pointer_t,
-		std::enable_if_t<
-			std::is_same_v<
-				pointer_t<data_t, metadata_t, key_t, keys_t...>,
-				_inner_pointer_t>,
-			bool> = true>
+		bool _is_constant = is_constant,
+		std::enable_if_t<not _is_constant, bool> = true>
 	leaf_element_t& operator* () noexcept
 	{
-		return *m_subtree_iterator;
+		return *(std::get<num_keys>(m_nodes)->begin() + m_pos[num_keys]);
 	}
 	/// Returns the current value of the iteration.
 	const leaf_element_t& operator* () const noexcept
 	{
-		return *m_subtree_iterator;
+		return *(std::get<num_keys>(m_nodes)->begin() + m_pos[num_keys]);
 	}
 
 	/// Returns the current value of the iteration.
 	std::tuple<leaf_element_t, key_t, keys_t...> operator+ () const noexcept
 	{
-		std::tuple<leaf_element_t, keys_t...> subtree = +m_subtree_iterator;
-
-		std::tuple<leaf_element_t, key_t, keys_t...> current;
-		std::get<0>(current) = std::get<0>(std::move(subtree));
-		std::get<1>(current) = m_it->first;
-		move_tuple_into<2, 2 + sizeof...(keys_t)>(current, std::move(subtree));
-		return current;
+		return [&]<size_t... ds>(std::index_sequence<ds...>)
+		{
+			return std::tuple<leaf_element_t, key_t, keys_t...>(
+				**this, std::get<ds>(m_nodes)->get_key(m_pos[ds])...
+			);
+		}(std::make_index_sequence<num_keys>{});
 	}
 
 private:
 
-	template <size_t i, size_t total_size>
-	static constexpr void move_tuple_into(
-		std::tuple<leaf_element_t, key_t, keys_t...>& current,
-		std::tuple<leaf_element_t, keys_t...>&& subtree
-	) noexcept
+	/// Number of children (or elements) of the node at depth @e d.
+	template <size_t d>
+	[[nodiscard]] size_t count() const noexcept
 	{
-		if constexpr (i < total_size) {
-			std::get<i>(current) = std::get<i - 1>(std::move(subtree));
-			move_tuple_into<i + 1, total_size>(current, std::move(subtree));
+		if constexpr (d == num_keys) {
+			return std::get<d>(m_nodes)->size();
+		}
+		else {
+			return std::get<d>(m_nodes)->num_keys();
 		}
 	}
 
-	/// Is the iteration of this node at the beginning?
-	[[nodiscard]] bool shallow_begin() const noexcept
+	/// Places the iterator at the end of an empty tree.
+	void to_empty() noexcept
 	{
-		return not shallow_past_begin() and m_it == m_tree->begin();
+		m_past_begin = true;
+		m_pos.fill(0);
+		m_pos[0] = static_cast<size_type>(std::get<0>(m_nodes)->num_keys());
 	}
-	/// Is the iteration of this node past the beginning?
-	[[nodiscard]] bool shallow_past_begin() const noexcept
+
+	/**
+	 * @brief Places the position at depth @e d at the first (or last) child.
+	 *
+	 * Prefetches the children ahead of the position.
+	 */
+	template <bool forward, size_t d>
+	void reset() noexcept
 	{
-		return m_past_begin;
+		m_pos[d] = forward ? 0 : static_cast<size_type>(count<d>() - 1);
+		if constexpr (d < num_keys) {
+			const auto *const n = std::get<d>(m_nodes);
+			detail::prefetch_siblings<forward>(
+				n->begin() + m_pos[d], n->begin(), n->end()
+			);
+		}
+	}
+
+	/// Iterates on the child of the current position at depth @e d - 1.
+	template <bool forward, size_t d>
+	void enter() noexcept
+	{
+		auto *const parent = std::get<d - 1>(m_nodes);
+		std::get<d>(m_nodes) = &(parent->begin() + m_pos[d - 1])->second;
+		reset<forward, d>();
 	}
-	/// Is the iteration of this node at the end?
-	[[nodiscard]] bool shallow_end() const noexcept
+
+	/// Iterates on the first (or last) child of every level from @e d on.
+	template <bool forward>
+	void descend(const size_t d) noexcept
 	{
-		return m_it == m_tree->end();
+		[&]<size_t... ds>(std::index_sequence<ds...>)
+		{
+			((ds + 1 >= d ? enter<forward, ds + 1>() : void()), ...);
+		}(std::make_index_sequence<num_keys>{});
+	}
+
+	/**
+	 * @brief The deepest level above the leaves whose position can move.
+	 * @returns The depth of the level, or @ref num_keys if there is none.
+	 */
+	template <bool forward>
+	[[nodiscard]] size_t deepest_movable() const noexcept
+	{
+		size_t d = num_keys;
+		[&]<size_t... ds>(std::index_sequence<ds...>)
+		{
+			(... or
+			 (movable<forward, num_keys - 1 - ds>()
+				  ? (d = num_keys - 1 - ds, true)
+				  : false));
+		}(std::make_index_sequence<num_keys>{});
+		return d;
+	}
+
+	/// Can the position at depth @e d move?
+	template <bool forward, size_t d>
+	[[nodiscard]] bool movable() const noexcept
+	{
+		if constexpr (forward) {
+			return m_pos[d] + 1 < count<d>();
+		}
+		else {
+			return m_pos[d] > 0;
+		}
+	}
+
+	/// Moves the position at depth @e d and descends to the leaves.
+	template <bool forward>
+	void move(const size_t d) noexcept
+	{
+		[&]<size_t... ds>(std::index_sequence<ds...>)
+		{
+			(void)(... or
+				   (ds == d ? (move_level<forward, ds>(), true) : false));
+		}(std::make_index_sequence<num_keys>{});
+		descend<forward>(d + 1);
+	}
+
+	/// Moves the position at depth @e d one child forward (or backward).
+	template <bool forward, size_t d>
+	void move_level() noexcept
+	{
+		if constexpr (forward) {
+			++m_pos[d];
+		}
+		else {
+			--m_pos[d];
+		}
+		const auto *const n = std::get<d>(m_nodes);
+		detail::prefetch_sibling<forward>(
+			n->begin() + m_pos[d], n->begin(), n->end()
+		);
 	}
 
 protected:
 
-	/// Pointer to the tree iterated on.
-	tree_pointer_t m_tree;
+	/// Pointers to the nodes iterated on; the first is the tree.
+	nodes_t m_nodes;
 
-	/// Iterator to the key of @ref m_tree currently being iterated.
-	container_iterator_t m_it;
+	/// Position of the current child (or element) in every node.
+	std::array<size_type, num_keys + 1> m_pos{};
 
 	/// Has the iterator reached the beginning and tried to move back?
 	bool m_past_begin = false;
-
-	/// Iterator over the children of @ref m_tree.
-	sub_iterator_t<tree_pointer_t, data_t, metadata_t, key_t, keys_t...>
-		m_subtree_iterator;
 };
 
 } // namespace detail
@@ -459,37 +539,50 @@ protected:
 // --------------------------------------------------------------------------
 
 /**
- * @brief Partial template specialization of the @ref iterator class.
+ * @brief Partial template specialization of the @ref basic_iterator class.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam data_t Type of the values to add.
  * @tparam metadata_t Type of the metadata associated to the values.
  */
-template <typename data_t, typename metadata_t>
-class iterator<data_t, metadata_t>
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t>
+class basic_iterator<allocator_t, data_t, metadata_t>
 	: public detail::iterator_<
-		  detail::pointer_t<data_t, metadata_t>,
-		  typename ctree<data_t, metadata_t>::container_t::iterator,
+		  allocator_t,
+		  detail::pointer_t<allocator_t, data_t, metadata_t>,
+		  typename basic_ctree<allocator_t, data_t, metadata_t>::container_t::
+			  iterator,
 		  data_t,
 		  metadata_t> {
 public:
 };
 
 /**
- * @brief Partial template specialization of the @ref iterator class.
+ * @brief Partial template specialization of the @ref basic_iterator class.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam data_t Type of the values to add.
  * @tparam metadata_t Type of the metadata associated to the values.
  * @tparam key_t Type of the first key.
  * @tparam keys_t Type of the remaining keys.
  */
 template <
+	template <typename> class allocator_t,
 	typename data_t,
 	typename metadata_t,
 	Comparable key_t,
 	Comparable... keys_t>
-class iterator<data_t, metadata_t, key_t, keys_t...>
+class basic_iterator<allocator_t, data_t, metadata_t, key_t, keys_t...>
 	: public detail::iterator_<
-		  detail::pointer_t<data_t, metadata_t, key_t, keys_t...>,
-		  typename ctree<data_t, metadata_t, key_t, keys_t...>::container_t::
-			  iterator,
+		  allocator_t,
+		  detail::pointer_t<allocator_t, data_t, metadata_t, key_t, keys_t...>,
+		  typename basic_ctree<
+			  allocator_t,
+			  data_t,
+			  metadata_t,
+			  key_t,
+			  keys_t...>::container_t::iterator,
 		  data_t,
 		  metadata_t,
 		  key_t,
@@ -498,37 +591,55 @@ public:
 };
 
 /**
- * @brief Partial template specialization of the @ref const_iterator class.
+ * @brief Partial template specialization of the @ref basic_const_iterator class.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam data_t Type of the values to add.
  * @tparam metadata_t Type of the metadata associated to the values.
  */
-template <typename data_t, typename metadata_t>
-class const_iterator<data_t, metadata_t>
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t>
+class basic_const_iterator<allocator_t, data_t, metadata_t>
 	: public detail::iterator_<
-		  detail::const_pointer_t<data_t, metadata_t>,
-		  typename ctree<data_t, metadata_t>::container_t::const_iterator,
+		  allocator_t,
+		  detail::const_pointer_t<allocator_t, data_t, metadata_t>,
+		  typename basic_ctree<allocator_t, data_t, metadata_t>::container_t::
+			  const_iterator,
 		  data_t,
 		  metadata_t> {
 public:
 };
 
 /**
- * @brief Partial template specialization of the @ref const_iterator class.
+ * @brief Partial template specialization of the @ref basic_const_iterator class.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam data_t Type of the values to add.
  * @tparam metadata_t Type of the metadata associated to the values.
  * @tparam key_t Type of the first key.
  * @tparam keys_t Type of the remaining keys.
  */
 template <
+	template <typename> class allocator_t,
 	typename data_t,
 	typename metadata_t,
 	Comparable key_t,
 	Comparable... keys_t>
-class const_iterator<data_t, metadata_t, key_t, keys_t...>
+class basic_const_iterator<allocator_t, data_t, metadata_t, key_t, keys_t...>
 	: public detail::iterator_<
-		  detail::const_pointer_t<data_t, metadata_t, key_t, keys_t...>,
-		  typename ctree<data_t, metadata_t, key_t, keys_t...>::container_t::
-			  const_iterator,
+		  allocator_t,
+		  detail::const_pointer_t<
+			  allocator_t,
+			  data_t,
+			  metadata_t,
+			  key_t,
+			  keys_t...>,
+		  typename basic_ctree<
+			  allocator_t,
+			  data_t,
+			  metadata_t,
+			  key_t,
+			  keys_t...>::container_t::const_iterator,
 		  data_t,
 		  metadata_t,
 		  key_t,
@@ -0,0 +1,359 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <initializer_list>
+#include <type_traits>
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <span>
+
+// ctree includes
+#include <ctree/batch_predicate.hpp>
+
+namespace classtree {
+namespace detail {
+
+/**
+ * @brief Exponential (galloping) search.
+ *
+ * Finds the partition point of the range [@e first, @e last), which must be
+ * partitioned with respect to @e before. The search probes the positions
+ * @e first + 1, + 3, + 7, ... and then binary-searches the last gap, so its
+ * cost is logarithmic in the distance between @e first and the result.
+ * @param first Beginning of the range.
+ * @param last End of the range.
+ * @param before Predicate that is true for the elements before the result.
+ * @returns The first element of the range for which @e before is false.
+ */
+template <std::random_access_iterator iterator_t, typename predicate_t>
+[[nodiscard]] constexpr iterator_t
+gallop(iterator_t first, const iterator_t last, predicate_t&& before) noexcept
+{
+	std::ptrdiff_t step = 1;
+	while (last - first > step) {
+		const iterator_t probe = first + step;
+		if (not before(*probe)) {
+			return std::partition_point(first, probe, before);
+		}
+		first = probe + 1;
+		step *= 2;
+	}
+	return std::partition_point(first, last, before);
+}
+
+/**
+ * @brief Sets the bits [@e first, @e last) of a mask.
+ * @param mask A bitmask (see @ref batch_predicate).
+ * @param first First bit to set.
+ * @param last Last + 1 bit to set.
+ */
+constexpr void set_bits(
+	std::span<std::uint64_t> mask, std::size_t first, const std::size_t last
+) noexcept
+{
+	while (first < last) {
+		const std::size_t w = first / 64;
+		const std::size_t b = first % 64;
+		const std::size_t n = std::min<std::size_t>(64 - b, last - first);
+		const std::uint64_t bits =
+			n == 64 ? ~std::uint64_t{0} : ((std::uint64_t{1} << n) - 1);
+		mask[w] |= bits << b;
+		first += n;
+	}
+}
+
+} // namespace detail
+
+/**
+ * @brief A predicate that accepts the keys in a set of values.
+ *
+ * The values are sorted and unique. Range iterators match the values against
+ * the sorted keys of every node with a merge join that gallops over the keys
+ * (see @ref detail::gallop), so the cost of entering a node depends on the
+ * number of values, not on the number of keys of the node.
+ *
+ * Use @ref in_set to make this predicate.
+ * @tparam key_t Type of the key.
+ */
+template <typename key_t>
+struct key_set {
+	/// The values, sorted and without repeats.
+	std::vector<key_t> values;
+
+	/// Is @e k one of the values?
+	[[nodiscard]] bool operator() (const key_t& k) const noexcept
+	{
+		return std::binary_search(values.begin(), values.end(), k);
+	}
+
+	/**
+	 * @brief Sets the bits of the keys in the set.
+	 * @param first Iterator to the first (key, subtree) pair of a node.
+	 * @param last Iterator past the last (key, subtree) pair of a node.
+	 * @param mask Bitmask with enough words for all the keys, filled with
+	 * zeros.
+	 */
+	template <std::random_access_iterator iterator_t>
+	void fill_mask(
+		const iterator_t first,
+		const iterator_t last,
+		std::span<std::uint64_t> mask
+	) const noexcept
+	{
+		iterator_t it = first;
+		for (const key_t& v : values) {
+			it = detail::gallop(
+				it, last, [&](const auto& p) { return p.first < v; }
+			);
+			if (it == last) {
+				return;
+			}
+			if (it->first == v) {
+				const auto i = static_cast<std::size_t>(it - first);
+				mask[i / 64] |= std::uint64_t{1} << (i % 64);
+				++it;
+			}
+		}
+	}
+};
+
+/**
+ * @brief A predicate that accepts the keys in a union of closed intervals.
+ *
+ * The intervals are sorted, non-empty and disjoint. Range iterators find the
+ * limits of every interval among the sorted keys of a node with a galloping
+ * search (see @ref detail::gallop) and set the bits in between word by word.
+ *
+ * Use @ref in_intervals to make this predicate.
+ * @tparam key_t Type of the key.
+ */
+template <typename key_t>
+struct key_intervals {
+	/// The intervals [lo, hi], sorted and disjoint.
+	std::vector<std::pair<key_t, key_t>> intervals;
+
+	/// Is @e k within one of the intervals?
+	[[nodiscard]] bool operator() (const key_t& k) const noexcept
+	{
+		// first interval whose upper bound is not less than k
+		const auto it = std::partition_point(
+			intervals.begin(),
+			intervals.end(),
+			[&](const auto& I) { return I.second < k; }
+		);
+		return it != intervals.end() and not(k < it->first);
+	}
+
+	/**
+	 * @brief Sets the bits of the keys within the intervals.
+	 * @param first Iterator to the first (key, subtree) pair of a node.
+	 * @param last Iterator past the last (key, subtree) pair of a node.
+	 * @param mask Bitmask with enough words for all the keys, filled with
+	 * zeros.
+	 */
+	template <std::random_access_iterator iterator_t>
+	void fill_mask(
+		const iterator_t first,
+		const iterator_t last,
+		std::span<std::uint64_t> mask
+	) const noexcept
+	{
+		iterator_t it = first;
+		for (const auto& [lo, hi] : intervals) {
+			const iterator_t b = detail::gallop(
+				it, last, [&](const auto& p) { return p.first < lo; }
+			);
+			if (b == last) {
+				return;
+			}
+			it = detail::gallop(
+				b, last, [&](const auto& p) { return not(hi < p.first); }
+			);
+			detail::set_bits(
+				mask,
+				static_cast<std::size_t>(b - first),
+				static_cast<std::size_t>(it - first)
+			);
+		}
+	}
+};
+
+/**
+ * @brief Makes a predicate that accepts the keys in a set of values.
+ * @param values The values, in any order and possibly repeated.
+ * @returns A @ref key_set that can be passed to the functions that make range
+ * iterators.
+ */
+template <typename key_t>
+[[nodiscard]] key_set<key_t> in_set(std::vector<key_t> values)
+{
+	std::sort(values.begin(), values.end());
+	values.erase(std::unique(values.begin(), values.end()), values.end());
+	return {std::move(values)};
+}
+
+/**
+ * @brief Makes a predicate that accepts the keys in a set of values.
+ * @param values The values, in any order and possibly repeated.
+ * @returns A @ref key_set that can be passed to the functions that make range
+ * iterators.
+ */
+template <typename key_t>
+[[nodiscard]] key_set<key_t> in_set(std::initializer_list<key_t> values)
+{
+	return in_set(std::vector<key_t>(values));
+}
+
+/**
+ * @brief Makes a predicate that accepts the keys in a union of intervals.
+ *
+ * Empty intervals (those with @e hi < @e lo) are discarded, and overlapping
+ * intervals are merged.
+ * @param intervals The intervals [lo, hi], in any order.
+ * @returns A @ref key_intervals that can be passed to the functions that make
+ * range iterators.
+ */
+template <typename key_t>
+[[nodiscard]] key_intervals<key_t>
+in_intervals(std::vector<std::pair<key_t, key_t>> intervals)
+{
+	std::erase_if(
+		intervals, [](const auto& I) { return I.second < I.first; }
+	);
+	std::sort(intervals.begin(), intervals.end());
+
+	std::vector<std::pair<key_t, key_t>> merged;
+	for (auto& I : intervals) {
+		if (not merged.empty() and not(merged.back().second < I.first)) {
+			if (merged.back().second < I.second) {
+				merged.back().second = std::move(I.second);
+			}
+		}
+		else {
+			merged.push_back(std::move(I));
+		}
+	}
+	return {std::move(merged)};
+}
+
+/**
+ * @brief Makes a predicate that accepts the keys in a union of intervals.
+ *
+ * Empty intervals (those with @e hi < @e lo) are discarded, and overlapping
+ * intervals are merged.
+ * @param intervals The intervals [lo, hi], in any order.
+ * @returns A @ref key_intervals that can be passed to the functions that make
+ * range iterators.
+ */
+template <typename key_t>
+[[nodiscard]] key_intervals<key_t>
+in_intervals(std::initializer_list<std::pair<key_t, key_t>> intervals)
+{
+	return in_intervals(std::vector<std::pair<key_t, key_t>>(intervals));
+}
+
+/// Is @e T a @ref key_set or a @ref key_intervals?
+template <typename T>
+constexpr bool is_sorted_predicate_v = false;
+
+template <typename key_t>
+constexpr bool is_sorted_predicate_v<key_set<key_t>> = true;
+
+template <typename key_t>
+constexpr bool is_sorted_predicate_v<key_intervals<key_t>> = true;
+
+namespace detail {
+
+/**
+ * @brief Evaluates the function of a level over the keys of a node.
+ *
+ * The function is either a predicate over a key, a @ref batch_predicate, or
+ * a sorted predicate (see @ref is_sorted_predicate_v).
+ * @param n A node of a tree.
+ * @param f The function.
+ * @param mask The bitmask of the keys of @e n that match @e f (see
+ * @ref batch_predicate).
+ */
+template <typename node_t, typename func_t>
+void fill_key_mask(
+	const node_t& n, func_t& f, std::vector<std::uint64_t>& mask
+)
+{
+	using callable_t = std::remove_cvref_t<func_t>;
+
+	const std::size_t num_keys = n.num_keys();
+	mask.assign((num_keys + 63) / 64, 0);
+	if constexpr (is_batch_predicate_v<callable_t>) {
+		using key_t = std::remove_cvref_t<decltype(n.get_key(0))>;
+		std::vector<key_t> keys;
+		keys.reserve(num_keys);
+		for (const auto& [k, _] : n) {
+			keys.push_back(k);
+		}
+		f.func(std::span<const key_t>(keys), std::span(mask));
+	}
+	else if constexpr (is_sorted_predicate_v<callable_t>) {
+		f.fill_mask(n.begin(), n.end(), std::span(mask));
+	}
+	else {
+		for (std::size_t i = 0; i < num_keys; ++i) {
+			if (f(n.get_key(i))) {
+				mask[i / 64] |= std::uint64_t{1} << (i % 64);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Evaluates the function of a level over one key.
+ *
+ * Same as @ref fill_key_mask, for a single key.
+ * @param k The key.
+ * @param f The function.
+ * @returns Whether @e k matches @e f.
+ */
+template <typename key_t, typename func_t>
+[[nodiscard]] bool key_matches(const key_t& k, func_t& f)
+{
+	using callable_t = std::remove_cvref_t<func_t>;
+
+	if constexpr (is_batch_predicate_v<callable_t>) {
+		std::uint64_t mask = 0;
+		f.func(
+			std::span<const key_t>(&k, 1), std::span<std::uint64_t>(&mask, 1)
+		);
+		return (mask & 1) != 0;
+	}
+	else {
+		return static_cast<bool>(f(k));
+	}
+}
+
+} // namespace detail
+} // namespace classtree
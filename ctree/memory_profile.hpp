@@ -24,9 +24,27 @@
 #pragma once
 
 // C++ includes
+#if defined DEBUG
+#include <cassert>
+#endif
+#include <type_traits>
+#include <spanstream>
+#include <algorithm>
+#include <charconv>
+#include <optional>
 #include <fstream>
+#include <numeric>
+#include <cstddef>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <cmath>
+#include <span>
 
 // ctree includes
+#include <ctree/growth_policy.hpp>
+#include <ctree/executor.hpp>
 #include <ctree/type_traits.hpp>
 #include <ctree/ctree.hpp>
 
@@ -41,6 +59,7 @@ namespace detail {
  * outputs: the number of keys and their value. For each leaf node, outputs the
  * number of elements in the leaf.
  * @tparam output_t Type of the output stream.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam data_t Type of the data stored in the leaves of the tree.
  * @tparam metadata_t Type of the metadata stored in the leaves of the tree.
  * @tparam keys_t Types of the keys of the tree.
@@ -49,11 +68,13 @@ namespace detail {
  */
 template <
 	typename output_t,
+	template <typename> class allocator_t,
 	typename data_t,
 	typename metadata_t,
 	Comparable... keys_t>
 void output_profile(
-	const ctree<data_t, metadata_t, keys_t...>& t, output_t& fout
+	const basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	output_t& fout
 )
 {
 	if constexpr (sizeof...(keys_t) == 0) {
@@ -83,6 +104,7 @@ void output_profile(
  * memory profile of the tree (see @ref detail::output_profile).
  * @tparam adjust_alignment Output size in bytes taking alignment into account.
  * @tparam output_t Type of the output stream.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam data_t Type of the data stored in the leaves of the tree.
  * @tparam metadata_t Type of the metadata stored in the leaves of the tree.
  * @tparam keys_t Types of the keys of the tree.
@@ -92,11 +114,13 @@ void output_profile(
 template <
 	bool adjust_alignment,
 	typename output_t,
+	template <typename> class allocator_t,
 	typename data_t,
 	typename metadata_t,
 	Comparable... keys_t>
 void output_profile(
-	const ctree<data_t, metadata_t, keys_t...>& t, output_t& fout
+	const basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	output_t& fout
 )
 {
 	fout << t.template total_bytes<adjust_alignment>() << ' ';
@@ -108,15 +132,21 @@ void output_profile(
  *
  * The memory profile is the total number of bytes of the tree plus the internal
  * memory profile of the tree (see @ref detail::output_profile).
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam data_t Type of the data stored in the leaves of the tree.
  * @tparam metadata_t Type of the metadata stored in the leaves of the tree.
  * @tparam Ts Types of the keys of the tree.
  * @param t The tree whose memory profile is to be written to @e fout.
  * @param filename The name of the file to write to.
  */
-template <typename data_t, typename metadata_t, Comparable... keys_t>
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	Comparable... keys_t>
 [[nodiscard]] bool output_profile(
-	const ctree<data_t, metadata_t, keys_t...>& t, const std::string& filename
+	const basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	const std::string& filename
 )
 {
 	std::ofstream fout(filename);
@@ -133,53 +163,60 @@ namespace detail {
 /**
  * @brief Reserves memory for this leaf node
  *
- * Uses the memory resource allocator passed as parameter.
+ * Uses the allocator passed as parameter.
  * @tparam istream_t Type of the input stream.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam data_t Type of the values to add.
  * @tparam metadata_t Type of the metadata associated to the values.
  * @param is Stream to read the memory profile from.
- * @param mem_res Memory resource allocator.
+ * @param alloc Allocator.
  */
-template <typename istream_t, typename data_t, typename metadata_t>
+template <
+	typename istream_t,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t>
 void initialize_leaf(
-	ctree<data_t, metadata_t>& t,
+	basic_ctree<allocator_t, data_t, metadata_t>& t,
 	istream_t& is,
-	std::pmr::memory_resource *mem_res
+	const allocator_t<std::byte>& alloc
 )
 {
-	size_t size;
+	size_t size = 0;
 	is >> size;
 
-	t.set_allocator(mem_res);
+	t.set_allocator(alloc);
 	t.reserve(size);
 }
 
 /**
  * @brief Reserves memory for this leaf node
  *
- * Uses the memory resource allocator passed as parameter.
+ * Uses the allocator passed as parameter.
  * @tparam istream_t Type of the input stream.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam data_t Type of the values to add.
  * @tparam metadata_t Type of the metadata associated to the values.
  * @tparam keys_t Type of the remaining keys.
  * @param is Stream to read the memory profile from.
- * @param mem_res Memory resource allocator.
+ * @param alloc Allocator.
  */
 template <
 	typename istream_t,
+	template <typename> class allocator_t,
 	typename data_t,
 	typename metadata_t,
 	typename... keys_t>
 void initialize_internal(
-	ctree<data_t, metadata_t, keys_t...>& t,
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
 	istream_t& is,
-	std::pmr::memory_resource *mem_res
+	const allocator_t<std::byte>& alloc
 )
 {
-	size_t size;
+	size_t size = 0;
 	is >> size;
 
-	t.set_allocator(mem_res);
+	t.set_allocator(alloc);
 	t.resize(size);
 
 	const auto it_end = t.end();
@@ -193,10 +230,10 @@ void initialize_internal(
 	it = t.begin();
 	while (it != it_end) {
 		if constexpr (sizeof...(keys_t) == 1) {
-			detail::initialize_leaf(it->second, is, mem_res);
+			detail::initialize_leaf(it->second, is, alloc);
 		}
 		else {
-			detail::initialize_internal(it->second, is, mem_res);
+			detail::initialize_internal(it->second, is, alloc);
 		}
 		++it;
 	}
@@ -207,28 +244,664 @@ void initialize_internal(
 /**
  * @brief Reserves memory for this leaf node
  *
- * Uses the memory resource allocator passed as parameter.
+ * Uses the allocator passed as parameter. When the tree uses polymorphic
+ * allocators, a pointer to a memory resource can be passed instead.
  * @tparam istream_t Type of the input stream.
  * @param is Stream to read the memory profile from.
- * @param mem_res Memory resource allocator.
+ * @param alloc Allocator. By default, a default-constructed allocator (for
+ * polymorphic allocators, one that uses @e std::pmr::get_default_resource()).
  */
 template <
 	typename istream_t,
+	template <typename> class allocator_t,
 	typename data_t,
 	typename metadata_t,
 	typename... keys_t>
 void initialize(
-	ctree<data_t, metadata_t, keys_t...>& t,
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	istream_t& is,
+	const std::type_identity_t<allocator_t<std::byte>>& alloc = {}
+)
+{
+	t.clear();
+	if constexpr (sizeof...(keys_t) == 0) {
+		detail::initialize_leaf(t, is, alloc);
+	}
+	else {
+		detail::initialize_internal(t, is, alloc);
+	}
+}
+
+namespace detail {
+
+/// Skips the white spaces at @e p.
+[[nodiscard]] inline const char *
+skip_spaces(const char *p, const char *const end) noexcept
+{
+	while (p != end and std::isspace(static_cast<unsigned char>(*p))) {
+		++p;
+	}
+	return p;
+}
+
+/// Skips the token (a key of the profile) at @e p.
+[[nodiscard]] inline const char *
+skip_token(const char *p, const char *const end) noexcept
+{
+	p = skip_spaces(p, end);
+	while (p != end and not std::isspace(static_cast<unsigned char>(*p))) {
+		++p;
+	}
+	return p;
+}
+
+/**
+ * @brief Skips the internal memory profile of a subtree.
+ *
+ * Only the sizes of the nodes are parsed; the keys are skipped as tokens.
+ * @tparam num_keys Number of keys of the subtree.
+ * @param p Beginning of the profile of the subtree.
+ * @param end End of the text that contains the profile.
+ * @returns The end of the profile of the subtree, or a null pointer if the
+ * profile is malformed.
+ */
+template <std::size_t num_keys>
+[[nodiscard]] const char *
+skip_profile(const char *p, const char *const end) noexcept
+{
+	p = skip_spaces(p, end);
+	std::size_t size = 0;
+	const auto [q, ec] = std::from_chars(p, end, size);
+	if (ec != std::errc{}) {
+		return nullptr;
+	}
+	p = q;
+
+	if constexpr (num_keys > 0) {
+		// every key and every subtree takes at least one character
+		if (size > static_cast<std::size_t>(end - p)) {
+			return nullptr;
+		}
+		for (std::size_t i = 0; i < size; ++i) {
+			p = skip_spaces(p, end);
+			if (p == end) {
+				return nullptr;
+			}
+			p = skip_token(p, end);
+		}
+		for (std::size_t i = 0; i < size and p != nullptr; ++i) {
+			p = skip_profile<num_keys - 1>(p, end);
+		}
+	}
+	return p;
+}
+
+} // namespace detail
+
+/**
+ * @brief Reserves memory for a tree using several threads.
+ *
+ * Same as @ref initialize, in two passes. The first pass reads the rest of
+ * the stream (up to the first null character) and finds where the profile
+ * of every subtree of the root begins. When the stream can be repositioned
+ * (@e tellg does not fail), it is then moved back to the end of the
+ * profile, as after @ref initialize; otherwise, it is consumed. The tree is
+ * left empty when the profile is malformed. The second pass
+ * initializes the subtrees of the root in parallel, the largest first, with
+ * the executor @e e. Worker @e w allocates the nodes it initializes with
+ * @e allocs[w], so that every worker can have its own memory resource (for
+ * example, a @e std::pmr::monotonic_buffer_resource). The root is allocated
+ * with @e allocs[0].
+ * @tparam istream_t Type of the input stream.
+ * @param is Stream to read the memory profile from.
+ * @param e The executor.
+ * @param allocs One allocator per worker of @e e.
+ */
+template <
+	typename istream_t,
+	Executor executor_t,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t>
+void initialize_parallel(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	istream_t& is,
+	executor_t& e,
+	const std::span<const std::type_identity_t<allocator_t<std::byte>>> allocs
+)
+{
+#if defined DEBUG
+	assert(not allocs.empty() and allocs.size() >= e.num_workers());
+#endif
+
+	if constexpr (sizeof...(keys_t) == 0) {
+		initialize(t, is, allocs[0]);
+	}
+	else {
+		t.clear();
+
+		// the rest of the stream (profiles do not contain null characters)
+		const auto start = is.tellg();
+		std::string text;
+		std::getline(is, text, '\0');
+		std::ispanstream root{std::span<const char>(text)};
+		const char *const begin = text.data();
+		const char *const end = begin + text.size();
+
+		// moves the stream back to the end of the profile, when it can
+		const auto seek = [&](const char *const p)
+		{
+			if (start != decltype(start)(-1)) {
+				is.clear();
+				is.seekg(start + (p - begin));
+			}
+		};
+
+		size_t size = 0;
+		root >> size;
+		// every key of the root takes at least one character
+		if (root.fail() or size > text.size()) {
+			return;
+		}
+		t.set_allocator(allocs[0]);
+		t.resize(size);
+
+		const auto it_end = t.end();
+		auto it = t.begin();
+		while (it != it_end) {
+			root >> it->first;
+			++it;
+		}
+		if (root.fail()) {
+			// malformed profile
+			t.clear();
+			return;
+		}
+
+		// first pass: offsets of the profiles of the subtrees, after the
+		// size and the keys of the root
+		const char *p = detail::skip_token(begin, end);
+		for (size_t i = 0; i < size; ++i) {
+			p = detail::skip_token(p, end);
+		}
+		if (size == 0) {
+			seek(p);
+			return;
+		}
+
+		std::vector<const char *> offsets(size + 1);
+		offsets[0] = p;
+		for (size_t i = 0; i < size; ++i) {
+			offsets[i + 1] =
+				detail::skip_profile<sizeof...(keys_t) - 1>(offsets[i], end);
+			if (offsets[i + 1] == nullptr) {
+				// malformed profile
+				t.clear();
+				return;
+			}
+		}
+		seek(offsets[size]);
+
+		std::vector<size_t> order(size);
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(
+			order.begin(),
+			order.end(),
+			[&](const size_t i, const size_t j)
+			{
+				return offsets[i + 1] - offsets[i] > offsets[j + 1] - offsets[j];
+			}
+		);
+
+		// second pass: the subtrees of the root, in parallel
+		e.bulk(
+			size,
+			[&](const size_t w, const size_t j)
+			{
+				const size_t i = order[j];
+				std::ispanstream sub(
+					std::span<const char>(offsets[i], offsets[i + 1])
+				);
+				if constexpr (sizeof...(keys_t) == 1) {
+					detail::initialize_leaf(t.get_child(i), sub, allocs[w]);
+				}
+				else {
+					detail::initialize_internal(t.get_child(i), sub, allocs[w]);
+				}
+			}
+		);
+	}
+}
+
+/**
+ * @brief Reserves memory for a tree using several threads.
+ *
+ * Same as @ref initialize_parallel with a @ref thread_executor of
+ * @e allocs.size() threads.
+ * @tparam istream_t Type of the input stream.
+ * @param is Stream to read the memory profile from.
+ * @param allocs One allocator per thread. Must not be empty.
+ */
+template <
+	typename istream_t,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t>
+void initialize_parallel(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
 	istream_t& is,
-	std::pmr::memory_resource *mem_res = std::pmr::get_default_resource()
+	const std::span<const std::type_identity_t<allocator_t<std::byte>>> allocs
+)
+{
+	thread_executor e(allocs.size());
+	initialize_parallel(t, is, e, allocs);
+}
+
+/**
+ * @brief Reserves memory for a tree using several threads.
+ *
+ * Same as @ref initialize_parallel with the allocator @e alloc in every
+ * thread. The allocator must be thread-safe (the default memory resource
+ * is).
+ * @tparam istream_t Type of the input stream.
+ * @param is Stream to read the memory profile from.
+ * @param num_threads Number of threads. Must be at least 1.
+ * @param alloc Allocator.
+ */
+template <
+	typename istream_t,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t>
+void initialize_parallel(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	istream_t& is,
+	const size_t num_threads,
+	const std::type_identity_t<allocator_t<std::byte>>& alloc = {}
+)
+{
+	const std::vector<allocator_t<std::byte>> allocs(num_threads, alloc);
+	initialize_parallel(
+		t, is, std::span<const allocator_t<std::byte>>(allocs)
+	);
+}
+
+namespace detail {
+
+/**
+ * @brief Gathers the fan-out of every node of a tree, per level.
+ * @param t The tree.
+ * @param fan_outs The fan-outs of the nodes of every level, from the level
+ * of @e t downwards.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	Comparable... keys_t>
+void gather_fan_outs(
+	const basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	std::span<std::vector<size_t>> fan_outs
+)
+{
+	if constexpr (sizeof...(keys_t) == 0) {
+		fan_outs[0].push_back(t.size());
+	}
+	else {
+		fan_outs[0].push_back(t.num_keys());
+		for (const auto& [_, child] : t) {
+			gather_fan_outs(child, fan_outs.subspan(1));
+		}
+	}
+}
+
+} // namespace detail
+
+/**
+ * @brief Learns a growth policy from the shape of a tree.
+ *
+ * For every level, the initial capacity is the median fan-out of the nodes
+ * of the level, so that most nodes are allocated once. When the fan-outs
+ * are concentrated (the 90th percentile is at most twice the median) the
+ * nodes grow by a factor of 1.5, which wastes less memory in the few nodes
+ * that outgrow the median. Otherwise they double their capacity, so that
+ * wide nodes are reallocated only a logarithmic number of times.
+ * @param t A tree built with data representative of future trees.
+ * @returns A growth policy with one level per key plus the leaves.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	Comparable... keys_t>
+[[nodiscard]] growth_policy learn_growth_policy(
+	const basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t
+)
+{
+	std::vector<std::vector<size_t>> fan_outs(sizeof...(keys_t) + 1);
+	detail::gather_fan_outs(t, std::span(fan_outs));
+
+	growth_policy policy;
+	policy.levels.resize(fan_outs.size());
+	for (size_t l = 0; l < fan_outs.size(); ++l) {
+		std::vector<size_t>& f = fan_outs[l];
+		std::erase(f, 0);
+		if (f.empty()) {
+			continue;
+		}
+		std::sort(f.begin(), f.end());
+
+		const size_t median = f[f.size() / 2];
+		const size_t p90 = f[(f.size() * 9) / 10];
+		policy.levels[l].initial = median;
+		policy.levels[l].factor = p90 <= 2 * median ? 1.5 : 2.0;
+	}
+	return policy;
+}
+
+/**
+ * @brief Writes a growth policy to an output stream.
+ *
+ * The format is the number of levels followed by the initial capacity and
+ * the growth factor of every level.
+ * @param policy The growth policy.
+ * @param fout The output stream.
+ */
+template <typename output_t>
+	requires(not std::is_convertible_v<output_t&, const std::string&>)
+void output_growth_policy(const growth_policy& policy, output_t& fout)
+{
+	fout << policy.levels.size() << '\n';
+	for (const level_growth& l : policy.levels) {
+		fout << l.initial << ' ' << l.factor << '\n';
+	}
+}
+
+/**
+ * @brief Writes a growth policy to a file.
+ *
+ * The policy of a tree is usually stored next to its memory profile (see
+ * @ref output_profile).
+ * @param policy The growth policy.
+ * @param filename The name of the file to write to.
+ * @returns False if the file could not be opened.
+ */
+[[nodiscard]] inline bool output_growth_policy(
+	const growth_policy& policy, const std::string& filename
+)
+{
+	std::ofstream fout(filename);
+	if (not fout.is_open()) {
+		return false;
+	}
+	output_growth_policy(policy, fout);
+	return true;
+}
+
+/**
+ * @brief Reads a growth policy from an input stream.
+ * @param is The input stream, in the format of @ref output_growth_policy.
+ * @returns The growth policy, or nothing if the stream is malformed or a
+ * level exceeds @ref level_growth::max_initial or
+ * @ref level_growth::max_factor.
+ */
+template <typename istream_t>
+	requires(not std::is_convertible_v<istream_t&, const std::string&>)
+[[nodiscard]] std::optional<growth_policy> input_growth_policy(istream_t& is)
+{
+	size_t n;
+	if (not(is >> n)) {
+		return {};
+	}
+
+	// the levels are appended as they are read, so that a malformed number
+	// of levels does not allocate memory
+	growth_policy policy;
+	for (size_t i = 0; i < n; ++i) {
+		level_growth l;
+		if (not(is >> l.initial >> l.factor) or
+			l.initial > level_growth::max_initial or
+			not(l.factor > 1.0 and l.factor <= level_growth::max_factor)) {
+			return {};
+		}
+		policy.levels.push_back(l);
+	}
+	return policy;
+}
+
+/**
+ * @brief Reads a growth policy from a file.
+ * @param filename The name of the file to read from.
+ * @returns The growth policy, or nothing if the file could not be opened
+ * or is malformed.
+ */
+[[nodiscard]] inline std::optional<growth_policy>
+input_growth_policy(const std::string& filename)
+{
+	std::ifstream fin(filename);
+	if (not fin.is_open()) {
+		return {};
+	}
+	return input_growth_policy(fin);
+}
+
+/**
+ * @brief Estimated shape of a tree.
+ *
+ * See @ref estimate_shape.
+ */
+struct shape_estimate {
+	/// Number of elements of the tree.
+	std::size_t num_elements = 0;
+	/**
+	 * @brief Number of nodes per level.
+	 *
+	 * Level 0 is the root, and the last level (the number of keys) holds the
+	 * leaves.
+	 */
+	std::vector<double> num_nodes;
+	/// Bytes allocated by the nodes (as in @e total_bytes<false>).
+	std::size_t num_bytes = 0;
+
+	/**
+	 * @brief Average fan-out of the nodes of a level.
+	 *
+	 * For the leaves, the average number of elements per leaf.
+	 * @param l Level.
+	 */
+	[[nodiscard]] double fan_out(const std::size_t l) const noexcept
+	{
+		const double children = l + 1 < num_nodes.size()
+									? num_nodes[l + 1]
+									: static_cast<double>(num_elements);
+		return num_nodes[l] > 0 ? children / num_nodes[l] : 0;
+	}
+
+	/**
+	 * @brief A growth policy that reserves the average fan-out of every level.
+	 *
+	 * Nodes that outgrow the average double their capacity.
+	 */
+	[[nodiscard]] growth_policy policy() const
+	{
+		growth_policy p;
+		p.levels.resize(num_nodes.size());
+		for (std::size_t l = 0; l < num_nodes.size(); ++l) {
+			const auto f = static_cast<std::size_t>(std::lround(fan_out(l)));
+			p.levels[l].initial = std::max<std::size_t>(1, f);
+		}
+		return p;
+	}
+};
+
+namespace detail {
+
+/**
+ * @brief Are the first @e n keys of two tuples equal?
+ * @param a A tuple of keys.
+ * @param b A tuple of keys.
+ * @param n Number of keys to compare.
+ */
+template <typename... keys_t>
+[[nodiscard]] bool equal_prefix(
+	const std::tuple<keys_t...>& a,
+	const std::tuple<keys_t...>& b,
+	const std::size_t n
+) noexcept
+{
+	return [&]<std::size_t... I>(std::index_sequence<I...>)
+	{
+		return ((I >= n or std::get<I>(a) == std::get<I>(b)) and ...);
+	}(std::make_index_sequence<sizeof...(keys_t)>{});
+}
+
+/**
+ * @brief Bytes allocated by the children of the nodes of every level.
+ * @param nodes Number of nodes per level, from the level of @e tree_t
+ * downwards.
+ * @param num_elements Number of elements in the leaves.
+ */
+template <typename tree_t>
+[[nodiscard]] double estimate_bytes(
+	const std::span<const double> nodes, const std::size_t num_elements
+) noexcept
+{
+	if constexpr (requires { typename tree_t::child_t; }) {
+		constexpr auto bytes =
+			static_cast<double>(sizeof(typename tree_t::subtree_t));
+		return nodes[1] * bytes +
+			   estimate_bytes<typename tree_t::child_t>(
+				   nodes.subspan(1), num_elements
+			   );
+	}
+	else {
+		constexpr auto bytes =
+			static_cast<double>(sizeof(typename tree_t::leaf_element_t));
+		return static_cast<double>(num_elements) * bytes;
+	}
+}
+
+} // namespace detail
+
+/**
+ * @brief Estimates the shape of a tree from a sample of its keys.
+ *
+ * The number of distinct prefixes of the keys of every length (that is, the
+ * number of nodes of every level) is extrapolated to the full data set. Let
+ * @e n be the size of the sample, @e N the number of elements, @e d the
+ * number of distinct prefixes in the sample and \f$f_j\f$ the number of
+ * prefixes that appear exactly @e j times in the sample. When the sample
+ * covers most of the prefixes (the Good-Turing coverage \f$1 - f_1/n\f$ is
+ * at least 0.9), the number of prefixes is estimated with the bias-corrected
+ * Chao1 estimator \f$d + f_1(f_1 - 1) / (2(f_2 + 1))\f$. Otherwise, it is
+ * estimated with the Guaranteed-Error Estimator
+ * \f$\sqrt{N/n}\, f_1 + \sum_{j \ge 2} f_j\f$. The estimate is exact when
+ * the sample is the whole data set.
+ *
+ * Use @ref pre_shape and @ref shape_estimate::policy to build the tree with
+ * fewer reallocations.
+ * @tparam tree_t Type of the tree.
+ * @param sample Keys of a random sample of the elements (for example, the
+ * first elements of a stream).
+ * @param num_elements The number of elements of the full data set.
+ * @returns The estimated shape of the tree.
+ */
+template <typename tree_t, Comparable... keys_t>
+[[nodiscard]] shape_estimate estimate_shape(
+	std::vector<std::tuple<keys_t...>> sample, const std::size_t num_elements
+)
+{
+	constexpr std::size_t num_keys = sizeof...(keys_t);
+
+	shape_estimate e;
+	e.num_elements = num_elements;
+	e.num_nodes.assign(num_keys + 1, 0);
+	e.num_nodes[0] = 1;
+
+	const std::size_t n = sample.size();
+	if (n == 0 or num_elements == 0) {
+		e.num_nodes[0] = 0;
+		return e;
+	}
+
+	std::sort(sample.begin(), sample.end());
+	const double scale = std::sqrt(
+		static_cast<double>(num_elements) / static_cast<double>(n)
+	);
+
+	for (std::size_t l = 1; l <= num_keys; ++l) {
+		// frequencies of the prefixes of length l
+		std::size_t f1 = 0;
+		std::size_t f2 = 0;
+		std::size_t rest = 0;
+		for (std::size_t i = 0; i < n;) {
+			std::size_t j = i + 1;
+			while (j < n and detail::equal_prefix(sample[i], sample[j], l)) {
+				++j;
+			}
+			f1 += (j - i == 1);
+			f2 += (j - i == 2);
+			rest += (j - i > 1);
+			i = j;
+		}
+
+		const auto F1 = static_cast<double>(f1);
+		const auto F2 = static_cast<double>(f2);
+		const auto d = static_cast<double>(f1 + rest);
+
+		double D;
+		if (n >= num_elements) {
+			D = d;
+		}
+		else if (F1 <= 0.1 * static_cast<double>(n)) {
+			// Chao1
+			D = d + F1 * (F1 - 1) / (2 * (F2 + 1));
+		}
+		else {
+			// Guaranteed-Error Estimator
+			D = scale * F1 + d - F1;
+		}
+		// a sample larger than 'num_elements' may have more prefixes
+		const double lo = std::max(d, e.num_nodes[l - 1]);
+		const double hi = std::max(lo, static_cast<double>(num_elements));
+		e.num_nodes[l] = std::clamp(D, lo, hi);
+	}
+
+	e.num_bytes = static_cast<std::size_t>(std::llround(
+		detail::estimate_bytes<tree_t>(std::span(e.num_nodes), num_elements)
+	));
+	return e;
+}
+
+/**
+ * @brief Prepares an empty tree for the ingest of a data set.
+ *
+ * Clears the tree and reserves the estimated number of children of the
+ * root. The remaining nodes are sized as they are created by adding the
+ * elements with @ref basic_ctree::add_with_policy and the policy
+ * @ref shape_estimate::policy.
+ * @param t The tree.
+ * @param e The estimated shape of the tree (see @ref estimate_shape).
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	Comparable... keys_t>
+void pre_shape(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	const shape_estimate& e
 )
 {
 	t.clear();
 	if constexpr (sizeof...(keys_t) == 0) {
-		detail::initialize_leaf(t, is, mem_res);
+		t.reserve(e.num_elements);
 	}
 	else {
-		detail::initialize_internal(t, is, mem_res);
+		t.reserve(static_cast<std::size_t>(std::lround(e.num_nodes[1])));
 	}
 }
 
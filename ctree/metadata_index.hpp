@@ -0,0 +1,342 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <type_traits>
+#include <functional>
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <ranges>
+#include <vector>
+#include <tuple>
+#include <set>
+
+// ctree includes
+#include <ctree/concepts.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/ctree.hpp>
+#include <ctree/search.hpp>
+
+namespace classtree {
+
+/**
+ * @brief A tree with a secondary index on a projection of the metadata.
+ * @tparam tree_t Type of the tree.
+ * @tparam projection_t Type of the projection of the metadata.
+ */
+template <typename tree_t, typename projection_t>
+class indexed_ctree;
+
+/**
+ * @brief A tree with a secondary index on a projection of the metadata.
+ *
+ * The index maps the value of the projection of the metadata of every
+ * element (for example, the number of occurrences) to the location of the
+ * element: its keys and its data. Locations do not change when elements are
+ * inserted, and they are resolved with @ref find in time logarithmic in the
+ * sizes of the nodes in the path to the element.
+ *
+ * The index is kept up to date when elements are added (including when the
+ * metadata of an element is merged with that of a repeat) and when trees
+ * are merged into this one. If the metadata is modified by other means,
+ * call @ref rebuild.
+ * @tparam allocator_t Allocator template used in every node of the tree.
+ * @tparam data_t Type of the data stored in the leaves of the tree.
+ * @tparam metadata_t Type of the metadata stored in the leaves of the tree.
+ * @tparam keys_t Types of the keys of the tree.
+ * @tparam projection_t Type of the projection of the metadata.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t,
+	typename projection_t>
+	requires(
+		not std::is_void_v<metadata_t> and LessthanComparable<data_t> and
+		std::invocable<const projection_t&, const metadata_t&>
+	)
+class indexed_ctree<
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>,
+	projection_t> {
+public:
+
+	/// Type of the tree.
+	using tree_t = basic_ctree<allocator_t, data_t, metadata_t, keys_t...>;
+	/// Type of the elements in the leaves.
+	using leaf_element_t = element_t<data_t, metadata_t>;
+	/// Type of the values of the projection.
+	using value_t = std::remove_cvref_t<
+		std::invoke_result_t<const projection_t&, const metadata_t&>>;
+
+	/// An entry of the index.
+	struct entry {
+		/// Value of the projection of the metadata.
+		value_t value;
+		/// Keys of the element.
+		std::tuple<keys_t...> keys;
+		/// Data of the element.
+		data_t data;
+	};
+
+	/// Order of the entries: by value, and then by location.
+	struct entry_less {
+		/// Enables heterogeneous lookups by value.
+		using is_transparent = void;
+
+		[[nodiscard]] bool
+		operator() (const entry& a, const entry& b) const noexcept
+		{
+			return std::tie(a.value, a.keys, a.data) <
+				   std::tie(b.value, b.keys, b.data);
+		}
+		[[nodiscard]] bool
+		operator() (const entry& a, const value_t& v) const noexcept
+		{
+			return a.value < v;
+		}
+		[[nodiscard]] bool
+		operator() (const value_t& v, const entry& a) const noexcept
+		{
+			return v < a.value;
+		}
+	};
+
+	/// Type of the index.
+	using index_t = std::multiset<entry, entry_less>;
+
+public:
+
+	/// Constructor with a projection.
+	explicit indexed_ctree(projection_t projection = {})
+		: m_projection(std::move(projection))
+	{ }
+
+	/// Constructor with a tree and a projection. Builds the index.
+	explicit indexed_ctree(tree_t&& t, projection_t projection = {})
+		: m_tree(std::move(t)),
+		  m_projection(std::move(projection))
+	{
+		rebuild();
+	}
+
+	/**
+	 * @brief Adds an element to the tree and to the index.
+	 *
+	 * Same as @ref basic_ctree::add.
+	 * @tparam unique Store the element when there are no repeats.
+	 * @param value Element to add.
+	 * @param ks Keys of the element.
+	 * @returns True if the element was not found and added.
+	 */
+	template <bool unique = true>
+	bool add(leaf_element_t&& value, keys_t... ks)
+	{
+		const leaf_element_t *const old =
+			unique ? find(value.data, ks...) : nullptr;
+		const metadata_t& m = old == nullptr ? value.metadata : old->metadata;
+		entry e{project(m), {ks...}, value.data};
+
+		m_tree.template add<unique>(std::move(value), std::move(ks)...);
+		if (old == nullptr) {
+			m_index.insert(std::move(e));
+			return true;
+		}
+		// the metadata of the element was merged
+		update(std::move(e));
+		return false;
+	}
+
+	/**
+	 * @brief Merges another tree into this tree.
+	 *
+	 * Same as @ref basic_ctree::merge.
+	 * @tparam unique Store the elements of the new tree so that there are no
+	 * repeats.
+	 * @param t The tree to be merged into this tree.
+	 * @returns The difference of the new size and the old size.
+	 */
+	template <bool unique = true>
+	std::size_t merge(tree_t&& t)
+	{
+		// the elements of 't', the value of the projection of their metadata
+		// and whether they are repeats of elements of this tree
+		std::vector<std::pair<entry, bool>> merged;
+		merged.reserve(t.size());
+		auto it = t.get_const_iterator_begin();
+		while (not it.end()) {
+			std::apply(
+				[&](const leaf_element_t& e, const keys_t&...ks)
+				{
+					const leaf_element_t *const old =
+						unique ? find(e.data, ks...) : nullptr;
+					const metadata_t& m =
+						old == nullptr ? e.metadata : old->metadata;
+					merged.emplace_back(
+						entry{project(m), {ks...}, e.data}, old != nullptr
+					);
+				},
+				+it
+			);
+			++it;
+		}
+
+		const std::size_t added = m_tree.template merge<unique>(std::move(t));
+		for (auto& [e, repeat] : merged) {
+			if (repeat) {
+				update(std::move(e));
+			}
+			else {
+				m_index.insert(std::move(e));
+			}
+		}
+		return added;
+	}
+
+	/// Rebuilds the index from the contents of the tree.
+	void rebuild()
+	{
+		m_index.clear();
+		auto it = m_tree.get_const_iterator_begin();
+		while (not it.end()) {
+			std::apply(
+				[&](const leaf_element_t& e, const keys_t&...ks)
+				{
+					m_index.insert(entry{project(e.metadata), {ks...}, e.data});
+				},
+				+it
+			);
+			++it;
+		}
+	}
+
+	/// Removes all elements.
+	void clear() noexcept
+	{
+		m_tree.clear();
+		m_index.clear();
+	}
+
+	/**
+	 * @brief The element with some data under some keys.
+	 * @param data Data of the element.
+	 * @param ks Keys of the element.
+	 * @returns A pointer to the element, or null if there is none. The
+	 * pointer is invalidated when elements are added.
+	 */
+	[[nodiscard]] const leaf_element_t *
+	find(const data_t& data, const keys_t&...ks) const noexcept
+	{
+		return detail::find_in<data_t, metadata_t>(m_tree, data, ks...);
+	}
+
+	/// The element of an entry of the index (see @ref find).
+	[[nodiscard]] const leaf_element_t *find(const entry& e) const noexcept
+	{
+		return std::apply(
+			[&](const keys_t&...ks) { return find(e.data, ks...); }, e.keys
+		);
+	}
+
+	/// The entries of the elements whose projection equals @e v.
+	[[nodiscard]] auto equal(const value_t& v) const
+	{
+		const auto [first, last] = m_index.equal_range(v);
+		return std::ranges::subrange(first, last);
+	}
+
+	/// The entries of the elements whose projection is in [@e lo, @e hi].
+	[[nodiscard]] auto between(const value_t& lo, const value_t& hi) const
+	{
+		return std::ranges::subrange(
+			m_index.lower_bound(lo), m_index.upper_bound(hi)
+		);
+	}
+
+	/// The number of elements whose projection equals @e v.
+	[[nodiscard]] std::size_t count(const value_t& v) const
+	{
+		return m_index.count(v);
+	}
+
+	/// The tree.
+	[[nodiscard]] const tree_t& tree() const noexcept
+	{
+		return m_tree;
+	}
+	/// The index.
+	[[nodiscard]] const index_t& index() const noexcept
+	{
+		return m_index;
+	}
+	/// The number of elements.
+	[[nodiscard]] std::size_t size() const noexcept
+	{
+		return m_tree.size();
+	}
+
+private:
+
+	/// Value of the projection of @e m.
+	[[nodiscard]] value_t project(const metadata_t& m) const
+	{
+		return std::invoke(m_projection, m);
+	}
+
+	/**
+	 * @brief Updates the entry of an element whose metadata changed.
+	 * @param e The entry of the element before the change.
+	 */
+	void update(entry&& e)
+	{
+		const leaf_element_t *const x = find(e);
+		if (x == nullptr) [[unlikely]] {
+			return;
+		}
+		value_t after = project(x->metadata);
+		if (e.value == after) {
+			return;
+		}
+
+		const auto it = m_index.find(e);
+		if (it != m_index.end()) {
+			m_index.erase(it);
+		}
+		e.value = std::move(after);
+		m_index.insert(std::move(e));
+	}
+
+private:
+
+	/// The tree.
+	tree_t m_tree;
+	/// The projection of the metadata.
+	[[no_unique_address]] projection_t m_projection;
+	/// The index.
+	index_t m_index;
+};
+
+} // namespace classtree
@@ -0,0 +1,292 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include <tuple>
+
+// ctree includes
+#include <ctree/ctree.hpp>
+
+namespace classtree {
+
+/**
+ * @brief Target value of an arithmetic key in a nearest-neighbour query.
+ *
+ * The contribution of a key @e k to the distance is
+ * \f$w \cdot (k - value)^2\f$, where @e w is the weight.
+ * @tparam T Type of the value.
+ */
+template <typename T>
+	requires std::is_arithmetic_v<T>
+struct target {
+	/// Target value.
+	T value;
+	/// Weight of the key in the distance.
+	double weight = 1.0;
+};
+
+/// A key that does not take part in a nearest-neighbour query.
+struct any_key { };
+
+/**
+ * @brief One of the results of a nearest-neighbour query.
+ * @tparam data_t Type of the data.
+ * @tparam metadata_t Type of the metadata.
+ * @tparam keys_t Types of the keys.
+ */
+template <typename data_t, typename metadata_t, typename... keys_t>
+struct neighbour {
+	/// Weighted squared distance between the keys and the query.
+	double distance;
+	/// The element, stored in the tree.
+	const element_t<data_t, metadata_t> *element;
+	/// The keys of the element.
+	std::tuple<keys_t...> keys;
+};
+
+namespace detail {
+
+/**
+ * @brief The @e k results closest to the query found so far.
+ *
+ * The results are kept in a max-heap on the distance.
+ * @tparam result_t Type of the results.
+ */
+template <typename result_t>
+struct nearest_heap {
+	/// Maximum amount of results.
+	std::size_t k;
+	/// The heap.
+	std::vector<result_t> results;
+
+	/// Compares two results by distance.
+	[[nodiscard]] static bool
+	closer(const result_t& r1, const result_t& r2) noexcept
+	{
+		return r1.distance < r2.distance;
+	}
+
+	/// Distance that any new result has to improve.
+	[[nodiscard]] double bound() const noexcept
+	{
+		return results.size() < k ? std::numeric_limits<double>::infinity()
+								  : results.front().distance;
+	}
+
+	/// Adds a result, replacing the farthest if the heap is full.
+	void push(result_t&& r) noexcept
+	{
+		if (results.size() == k) {
+			std::pop_heap(results.begin(), results.end(), closer);
+			results.back() = std::move(r);
+		}
+		else {
+			results.push_back(std::move(r));
+		}
+		std::push_heap(results.begin(), results.end(), closer);
+	}
+};
+
+/**
+ * @brief Nearest-neighbour search over a leaf.
+ *
+ * All the elements of a leaf are at distance @e partial of the query.
+ */
+template <
+	std::size_t level,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename keys_tuple_t,
+	typename result_t>
+void nearest_search(
+	const basic_ctree<allocator_t, data_t, metadata_t>& t,
+	const double partial,
+	keys_tuple_t& path,
+	nearest_heap<result_t>& heap
+) noexcept
+{
+	for (const auto& e : t) {
+		if (not(partial < heap.bound())) {
+			return;
+		}
+		heap.push(result_t{partial, &e, path});
+	}
+}
+
+/**
+ * @brief Nearest-neighbour search over an internal node.
+ *
+ * When the key of this level is part of the query, the children are visited
+ * from the closest to the farthest key, starting at the position of the target
+ * value in the sorted keys and moving outwards. The search stops as soon as
+ * the closest unvisited key cannot improve the current @e k results, so
+ * entire subtrees are pruned.
+ */
+template <
+	std::size_t level,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename keys_tuple_t,
+	typename result_t,
+	typename spec_t,
+	typename... specs_t,
+	Comparable key_t,
+	Comparable... keys_t>
+void nearest_search(
+	const basic_ctree<allocator_t, data_t, metadata_t, key_t, keys_t...>& t,
+	const double partial,
+	keys_tuple_t& path,
+	nearest_heap<result_t>& heap,
+	const spec_t& spec,
+	const specs_t&...specs
+) noexcept
+{
+	const auto visit = [&](const auto& child, const double d)
+	{
+		std::get<level>(path) = child.first;
+		nearest_search<level + 1>(child.second, d, path, heap, specs...);
+	};
+
+	if constexpr (std::is_same_v<spec_t, any_key>) {
+		for (const auto& child : t) {
+			if (not(partial < heap.bound())) {
+				return;
+			}
+			visit(child, partial);
+		}
+	}
+	else {
+		static_assert(
+			std::is_arithmetic_v<key_t>,
+			"Only arithmetic keys can take part in a nearest-neighbour query."
+		);
+
+		const auto distance = [&](const key_t& k) -> double
+		{
+			const double diff =
+				static_cast<double>(k) - static_cast<double>(spec.value);
+			return partial + spec.weight * diff * diff;
+		};
+
+		const auto first = t.begin();
+		const auto last = t.end();
+		auto right = std::partition_point(
+			first,
+			last,
+			[&](const auto& child) -> bool
+			{
+				return static_cast<double>(child.first) <
+					   static_cast<double>(spec.value);
+			}
+		);
+		auto left = right;
+
+		while (left != first or right != last) {
+			// the closest of the two candidates
+			const bool go_left =
+				right == last or
+				(left != first and
+				 distance((left - 1)->first) < distance(right->first));
+
+			const auto& child = go_left ? *(left - 1) : *right;
+			const double d = distance(child.first);
+			if (not(d < heap.bound())) {
+				// the other candidate is not closer
+				return;
+			}
+			visit(child, d);
+
+			if (go_left) {
+				--left;
+			}
+			else {
+				++right;
+			}
+		}
+	}
+}
+
+} // namespace detail
+
+/**
+ * @brief The @e k elements of a tree whose keys are the closest to a query.
+ *
+ * The query has one term per key: either a @ref target (the key takes part in
+ * the distance, and must be arithmetic) or @ref any_key (the key is ignored).
+ * The distance between the keys of an element and the query is the weighted
+ * squared Euclidean distance
+ * \f$\sum_i w_i \cdot (k_i - v_i)^2\f$
+ * over the keys that take part in the query.
+ *
+ * The search is a depth-first branch and bound: the children of every node
+ * are visited from the closest to the farthest key, and the search of a node
+ * stops when its closest unvisited key cannot improve the current @e k
+ * results.
+ * @param t The tree.
+ * @param k The number of elements to find.
+ * @param specs One term of the query per key.
+ * @returns At most @e k elements, sorted by increasing distance. Ties are
+ * broken arbitrarily.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	Comparable... keys_t,
+	typename... specs_t>
+	requires(sizeof...(specs_t) == sizeof...(keys_t))
+[[nodiscard]] std::vector<neighbour<data_t, metadata_t, keys_t...>> nearest(
+	const basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	const std::size_t k,
+	const specs_t&...specs
+)
+{
+	using result_t = neighbour<data_t, metadata_t, keys_t...>;
+
+	detail::nearest_heap<result_t> heap{k, {}};
+	if (k == 0) {
+		return {};
+	}
+	heap.results.reserve(std::min(k, t.size()));
+
+	std::tuple<keys_t...> path;
+	detail::nearest_search<0>(t, 0.0, path, heap, specs...);
+
+	std::sort_heap(
+		heap.results.begin(),
+		heap.results.end(),
+		detail::nearest_heap<result_t>::closer
+	);
+	return std::move(heap.results);
+}
+
+} // namespace classtree
@@ -0,0 +1,271 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#if defined DEBUG
+#include <cassert>
+#endif
+#include <type_traits>
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <span>
+#include <bit>
+
+namespace classtree {
+
+/**
+ * @brief Integer types that can be stored in a @ref packed_column.
+ * @tparam T Type.
+ */
+template <typename T>
+concept Packable = std::integral<T> and not std::same_as<T, bool> and
+				   sizeof(T) <= sizeof(std::uint64_t);
+
+/**
+ * @brief An immutable sequence of integers compressed by blocks.
+ *
+ * The values are split into blocks of @ref block_size consecutive values.
+ * Every block is stored with frame-of-reference encoding: the minimum of
+ * the block is kept in the header of the block, and every value is stored as
+ * its difference to the minimum with the smallest number of bits @e w that
+ * fits all the differences of the block. The values of a block take exactly
+ * @e w 64-bit words, that is, a cache line when @e w is at most 8.
+ *
+ * Every value is decoded in constant time. The headers also keep the first
+ * value of every block, so that a sorted range is searched on the headers
+ * first and then within a single block (see @ref lower_bound).
+ * @tparam T Type of the values.
+ */
+template <Packable T>
+class packed_column {
+public:
+
+	/// Type of the values.
+	using value_type = T;
+
+	/// Number of values in a block.
+	static constexpr std::size_t block_size = 64;
+
+public:
+
+	/// Default constructor.
+	packed_column() noexcept = default;
+
+	/**
+	 * @brief Constructor from a sequence of values.
+	 * @param values The values.
+	 */
+	explicit packed_column(const std::span<const T> values)
+		: m_size(values.size())
+	{
+		m_headers.reserve((values.size() + block_size - 1) / block_size);
+		for (std::size_t b = 0; b < values.size(); b += block_size) {
+			const std::size_t e = std::min(b + block_size, values.size());
+			const auto [min, max] = std::minmax_element(
+				values.begin() + static_cast<std::ptrdiff_t>(b),
+				values.begin() + static_cast<std::ptrdiff_t>(e)
+			);
+
+			const header h{
+				.base = *min,
+				.first = values[b],
+				.offset = m_words.size(),
+				.width = static_cast<std::uint8_t>(
+					std::bit_width(difference(*max, *min))
+				)
+			};
+			m_words.resize(m_words.size() + h.width, 0);
+			for (std::size_t i = b; i < e; ++i) {
+				write(h, i - b, difference(values[i], h.base));
+			}
+			m_headers.push_back(h);
+		}
+	}
+
+	/// The number of values.
+	[[nodiscard]] std::size_t size() const noexcept
+	{
+		return m_size;
+	}
+
+	/// Is this column empty?
+	[[nodiscard]] bool empty() const noexcept
+	{
+		return m_size == 0;
+	}
+
+	/// The @e i-th value.
+	[[nodiscard]] T operator[] (const std::size_t i) const noexcept
+	{
+#if defined DEBUG
+		assert(i < m_size);
+#endif
+		const header& h = m_headers[i / block_size];
+		return add(h.base, read(h, i % block_size));
+	}
+
+	/**
+	 * @brief The first position in a sorted range with a value not less
+	 * than @e v.
+	 *
+	 * The block that contains the position is found with a binary search
+	 * over the first values of the blocks, and only that block is decoded.
+	 * @param first First position of the range.
+	 * @param last Last + 1 position of the range.
+	 * @param v Value.
+	 * @returns The position, or @e last if there is none.
+	 */
+	[[nodiscard]] std::size_t lower_bound(
+		const std::size_t first, const std::size_t last, const T v
+	) const noexcept
+	{
+		if (first == last) {
+			return last;
+		}
+
+		// the last block whose first value is less than 'v'; the first block
+		// of the range may start before 'first'
+		const std::size_t fb = first / block_size;
+		const std::size_t lb = (last - 1) / block_size;
+		const auto it = std::partition_point(
+			m_headers.begin() + static_cast<std::ptrdiff_t>(fb + 1),
+			m_headers.begin() + static_cast<std::ptrdiff_t>(lb + 1),
+			[&](const header& h) { return h.first < v; }
+		);
+		const std::size_t b =
+			static_cast<std::size_t>(it - m_headers.begin()) - 1;
+
+		const header& h = m_headers[b];
+		std::size_t lo = std::max(first, b * block_size) - b * block_size;
+		std::size_t hi = std::min(last, (b + 1) * block_size) - b * block_size;
+		if (v < h.base) {
+			return b * block_size + lo;
+		}
+		const std::uint64_t d = difference(v, h.base);
+		while (lo < hi) {
+			const std::size_t mid = lo + (hi - lo) / 2;
+			if (read(h, mid) < d) {
+				lo = mid + 1;
+			}
+			else {
+				hi = mid;
+			}
+		}
+		return b * block_size + lo;
+	}
+
+	/// The number of bytes used by this column.
+	[[nodiscard]] std::size_t bytes() const noexcept
+	{
+		return sizeof(packed_column) + m_headers.capacity() * sizeof(header) +
+			   m_words.capacity() * sizeof(std::uint64_t);
+	}
+
+private:
+
+	/// The header of a block.
+	struct header {
+		/// The minimum value of the block.
+		T base;
+		/// The first value of the block.
+		T first;
+		/// Position of the first word of the block.
+		std::size_t offset;
+		/// Number of bits of every value of the block.
+		std::uint8_t width;
+	};
+
+	/// Unsigned type of the same width as @e T.
+	using unsigned_t = std::make_unsigned_t<T>;
+
+	/**
+	 * @brief The difference @e v - @e base, with @e v not less than @e base.
+	 *
+	 * The difference is computed in @ref unsigned_t, so that signed values
+	 * of a block that spans zero do not need more bits than the same range
+	 * of non-negative values.
+	 */
+	[[nodiscard]] static std::uint64_t
+	difference(const T v, const T base) noexcept
+	{
+		return static_cast<unsigned_t>(
+			static_cast<unsigned_t>(v) - static_cast<unsigned_t>(base)
+		);
+	}
+	/// The value @e base + @e d, inverse of @ref difference.
+	[[nodiscard]] static T add(const T base, const std::uint64_t d) noexcept
+	{
+		return static_cast<T>(static_cast<unsigned_t>(
+			static_cast<unsigned_t>(base) + static_cast<unsigned_t>(d)
+		));
+	}
+
+	/// The @e j-th difference of the block of @e h.
+	[[nodiscard]] std::uint64_t
+	read(const header& h, const std::size_t j) const noexcept
+	{
+		if (h.width == 0) {
+			return 0;
+		}
+		const std::size_t bit = j * h.width;
+		const std::size_t shift = bit % 64;
+		const std::uint64_t *const w = m_words.data() + h.offset + bit / 64;
+		std::uint64_t v = w[0] >> shift;
+		if (shift + h.width > 64) {
+			v |= w[1] << (64 - shift);
+		}
+		return h.width == 64 ? v : v & ((std::uint64_t{1} << h.width) - 1);
+	}
+
+	/// Writes the @e j-th difference of the block of @e h.
+	void
+	write(const header& h, const std::size_t j, const std::uint64_t v) noexcept
+	{
+		if (h.width == 0) {
+			return;
+		}
+		const std::size_t bit = j * h.width;
+		const std::size_t shift = bit % 64;
+		std::uint64_t *const w = m_words.data() + h.offset + bit / 64;
+		w[0] |= v << shift;
+		if (shift + h.width > 64) {
+			w[1] |= v >> (64 - shift);
+		}
+	}
+
+private:
+
+	/// The headers of the blocks.
+	std::vector<header> m_headers;
+	/// The bits of the values of all blocks.
+	std::vector<std::uint64_t> m_words;
+	/// The number of values.
+	std::size_t m_size = 0;
+};
+
+} // namespace classtree
@@ -0,0 +1,402 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <array>
+#include <tuple>
+#include <span>
+
+// ctree includes
+#include <ctree/packed_column.hpp>
+#include <ctree/concepts.hpp>
+#include <ctree/ctree.hpp>
+#include <ctree/types.hpp>
+
+namespace classtree {
+namespace detail {
+
+/**
+ * @brief A sequence of keys that are not compressed.
+ *
+ * It has the same interface as @ref packed_column.
+ * @tparam T Type of the keys.
+ */
+template <typename T>
+class plain_column {
+public:
+
+	/// Default constructor.
+	plain_column() noexcept = default;
+	/// Constructor from a sequence of values.
+	explicit plain_column(std::vector<T>&& values) noexcept
+		: m_values(std::move(values))
+	{ }
+
+	/// The number of values.
+	[[nodiscard]] std::size_t size() const noexcept
+	{
+		return m_values.size();
+	}
+	/// The @e i-th value.
+	[[nodiscard]] const T& operator[] (const std::size_t i) const noexcept
+	{
+		return m_values[i];
+	}
+	/// The first position in a sorted range with a value not less than @e v.
+	[[nodiscard]] std::size_t lower_bound(
+		const std::size_t first, const std::size_t last, const T& v
+	) const noexcept
+	{
+		const auto it = std::lower_bound(
+			m_values.begin() + static_cast<std::ptrdiff_t>(first),
+			m_values.begin() + static_cast<std::ptrdiff_t>(last),
+			v
+		);
+		return static_cast<std::size_t>(it - m_values.begin());
+	}
+	/// The number of bytes used by this column.
+	[[nodiscard]] std::size_t bytes() const noexcept
+	{
+		return sizeof(plain_column) + m_values.capacity() * sizeof(T);
+	}
+
+private:
+
+	/// The values.
+	std::vector<T> m_values;
+};
+
+/// The column of the keys of type @e T of a @ref packed_ctree.
+template <typename T>
+struct key_column {
+	using type = plain_column<T>;
+};
+/// The column of integer keys of a @ref packed_ctree.
+template <Packable T>
+struct key_column<T> {
+	using type = packed_column<T>;
+};
+
+/// Shorthand for @ref key_column.
+template <typename T>
+using key_column_t = typename key_column<T>::type;
+
+} // namespace detail
+
+/**
+ * @brief An immutable Classification Tree with compressed keys.
+ *
+ * This tree is made from a @ref basic_ctree and stores the same elements
+ * under the same keys. The nodes of every level are laid out one after the
+ * other, in order: level @e l is a column with the keys of all its nodes,
+ * and a column of offsets with the position of the first key of the child
+ * of every key in level @e l + 1 (the position of the first element, in the
+ * last level). The keys of a node are a contiguous and sorted range of its
+ * column.
+ *
+ * Integer keys and the offsets are stored in @ref packed_column, so that
+ * their size depends on how close consecutive values are rather than on the
+ * width of their type. Other keys are stored as they are.
+ * @tparam data_t Type of the values stored.
+ * @tparam metadata_t Type of the metadata associated to the values.
+ * @tparam keys_t The types of the keys.
+ */
+template <typename data_t, typename metadata_t, Comparable... keys_t>
+	requires(sizeof...(keys_t) > 0)
+class packed_ctree {
+public:
+
+	/// Shorthand for a useful type.
+	using leaf_element_t = element_t<data_t, metadata_t>;
+
+	/// Number of keys.
+	static constexpr std::size_t num_levels = sizeof...(keys_t);
+
+	/// Direct access to a nice property of @ref element_t.
+	static constexpr bool is_compound = Compound<data_t, metadata_t>;
+
+public:
+
+	/// Default constructor.
+	packed_ctree() noexcept = default;
+
+	/**
+	 * @brief Constructor from a tree.
+	 * @param t The tree.
+	 */
+	template <template <typename> class allocator_t>
+	explicit packed_ctree(
+		const basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t
+	)
+	{
+		std::tuple<std::vector<keys_t>...> keys;
+		std::array<std::vector<std::uint64_t>, num_levels> offsets;
+		m_elements.reserve(t.size());
+		gather<0>(t, keys, offsets);
+
+		// the offset past the last key of every level
+		[&]<std::size_t... I>(std::index_sequence<I...>)
+		{
+			(offsets[I].push_back(
+				 I + 1 < num_levels
+					 ? std::get<std::min(I + 1, num_levels - 1)>(keys).size()
+					 : m_elements.size()
+			 ),
+			 ...);
+			((std::get<I>(m_keys) =
+				  make_column<keys_t>(std::move(std::get<I>(keys)))),
+			 ...);
+		}(std::make_index_sequence<num_levels>{});
+
+		for (std::size_t l = 0; l < num_levels; ++l) {
+			m_offsets[l] = packed_column<std::uint64_t>(offsets[l]);
+		}
+	}
+
+	/// The number of elements in this tree.
+	[[nodiscard]] std::size_t size() const noexcept
+	{
+		return m_elements.size();
+	}
+
+	/// The elements of this tree, in the order of the leaves.
+	[[nodiscard]] std::span<const leaf_element_t> elements() const noexcept
+	{
+		return m_elements;
+	}
+
+	/**
+	 * @brief The elements classified under the given keys.
+	 * @param ks The values of the keys.
+	 * @returns The (possibly empty) range of elements with keys @e ks.
+	 */
+	[[nodiscard]] std::span<const leaf_element_t>
+	leaf(const keys_t&...ks) const noexcept
+	{
+		const auto [first, last] = find_leaf<0>(0, level_size(0), ks...);
+		return std::span<const leaf_element_t>(m_elements)
+			.subspan(first, last - first);
+	}
+
+	/**
+	 * @brief Is there any element classified under the given keys?
+	 * @param ks The values of the keys.
+	 */
+	[[nodiscard]] bool has_keys(const keys_t&...ks) const noexcept
+	{
+		return not leaf(ks...).empty();
+	}
+
+	/**
+	 * @brief Finds an element.
+	 * @param d The data of the element.
+	 * @param ks The values of the keys of the element.
+	 * @returns A pointer to the element, or a null pointer if it does not
+	 * exist.
+	 */
+	[[nodiscard]] const leaf_element_t *
+	find(const data_t& d, const keys_t&...ks) const noexcept
+	{
+		const std::span<const leaf_element_t> l = leaf(ks...);
+		if constexpr (LessthanComparable<data_t>) {
+			const auto it = std::partition_point(
+				l.begin(),
+				l.end(),
+				[&](const leaf_element_t& e) { return data_of(e) < d; }
+			);
+			return it != l.end() and data_of(*it) == d ? &*it : nullptr;
+		}
+		else {
+			for (const leaf_element_t& e : l) {
+				if (data_of(e) == d) {
+					return &e;
+				}
+			}
+			return nullptr;
+		}
+	}
+
+	/**
+	 * @brief Calls a function on every element and its keys.
+	 * @param f Function called as f(element, keys...), in the order of the
+	 * leaves.
+	 */
+	template <typename function_t>
+	void for_each(function_t&& f) const
+	{
+		visit<0>(0, level_size(0), f);
+	}
+
+	/// The number of bytes used by the keys and the offsets of all levels.
+	[[nodiscard]] std::size_t key_bytes() const noexcept
+	{
+		std::size_t bytes = 0;
+		std::apply(
+			[&](const auto&...c) { ((bytes += c.bytes()), ...); }, m_keys
+		);
+		for (const auto& o : m_offsets) {
+			bytes += o.bytes();
+		}
+		return bytes;
+	}
+
+	/// The number of bytes used by this tree.
+	[[nodiscard]] std::size_t total_bytes() const noexcept
+	{
+		return sizeof(packed_ctree) + key_bytes() +
+			   m_elements.capacity() * sizeof(leaf_element_t);
+	}
+
+private:
+
+	/// Returns the data of an element.
+	[[nodiscard]] static const data_t& data_of(const leaf_element_t& e
+	) noexcept
+	{
+		if constexpr (is_compound) {
+			return e.data;
+		}
+		else {
+			return e;
+		}
+	}
+
+	/// Makes the column of keys of type @e T.
+	template <typename T>
+	[[nodiscard]] static detail::key_column_t<T>
+	make_column(std::vector<T>&& values)
+	{
+		if constexpr (Packable<T>) {
+			return packed_column<T>(values);
+		}
+		else {
+			return detail::plain_column<T>(std::move(values));
+		}
+	}
+
+	/// The number of keys in a level.
+	[[nodiscard]] std::size_t level_size(const std::size_t l) const noexcept
+	{
+		// the offsets have one more value than the keys
+		return m_offsets[l].empty() ? 0 : m_offsets[l].size() - 1;
+	}
+
+	/// Collects the keys and the offsets of every level, and the elements.
+	template <std::size_t level, typename node_t>
+	void gather(
+		const node_t& n,
+		std::tuple<std::vector<keys_t>...>& keys,
+		std::array<std::vector<std::uint64_t>, num_levels>& offsets
+	)
+	{
+		if constexpr (level == num_levels) {
+			m_elements.insert(m_elements.end(), n.begin(), n.end());
+		}
+		else {
+			for (const auto& [k, c] : n) {
+				std::get<level>(keys).push_back(k);
+				if constexpr (level + 1 < num_levels) {
+					offsets[level].push_back(std::get<level + 1>(keys).size());
+				}
+				else {
+					offsets[level].push_back(m_elements.size());
+				}
+				gather<level + 1>(c, keys, offsets);
+			}
+		}
+	}
+
+	/**
+	 * @brief The range of elements under some keys.
+	 * @param first First position of the node in its level.
+	 * @param last Last + 1 position of the node in its level.
+	 * @param k Key of this level.
+	 * @param ks Keys of the next levels.
+	 */
+	template <std::size_t level, typename key_t, typename... rest_t>
+	[[nodiscard]] std::pair<std::size_t, std::size_t> find_leaf(
+		const std::size_t first,
+		const std::size_t last,
+		const key_t& k,
+		const rest_t&...ks
+	) const noexcept
+	{
+		const auto& column = std::get<level>(m_keys);
+		const std::size_t i = column.lower_bound(first, last, k);
+		if (i == last or not(column[i] == k)) {
+			return {0, 0};
+		}
+		const std::size_t child_first = m_offsets[level][i];
+		const std::size_t child_last = m_offsets[level][i + 1];
+		if constexpr (level + 1 == num_levels) {
+			return {child_first, child_last};
+		}
+		else {
+			return find_leaf<level + 1>(child_first, child_last, ks...);
+		}
+	}
+
+	/// Visits the elements of the nodes in the range [first, last).
+	template <std::size_t level, typename function_t, typename... prefix_t>
+	void visit(
+		const std::size_t first,
+		const std::size_t last,
+		function_t& f,
+		const prefix_t&...prefix
+	) const
+	{
+		const auto& column = std::get<level>(m_keys);
+		for (std::size_t i = first; i < last; ++i) {
+			const auto k = column[i];
+			const std::size_t child_first = m_offsets[level][i];
+			const std::size_t child_last = m_offsets[level][i + 1];
+			if constexpr (level + 1 == num_levels) {
+				for (std::size_t j = child_first; j < child_last; ++j) {
+					f(m_elements[j], prefix..., k);
+				}
+			}
+			else {
+				visit<level + 1>(child_first, child_last, f, prefix..., k);
+			}
+		}
+	}
+
+private:
+
+	/// The keys of every level.
+	std::tuple<detail::key_column_t<keys_t>...> m_keys;
+	/// The offsets of every level.
+	std::array<packed_column<std::uint64_t>, num_levels> m_offsets;
+	/// The elements, in the order of the leaves.
+	std::vector<leaf_element_t> m_elements;
+};
+
+} // namespace classtree
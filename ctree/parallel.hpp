@@ -0,0 +1,85 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <exception>
+#include <cstddef>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace classtree {
+namespace detail {
+
+/**
+ * @brief Runs @e num_tasks tasks on @e num_threads threads.
+ *
+ * The calling thread is one of the threads. The tasks are handed out in
+ * increasing order of index, one at a time, to the first thread that is
+ * idle. If a task throws, the thread that ran it stops and the exception
+ * is rethrown once all threads have finished.
+ * @param num_tasks Number of tasks.
+ * @param num_threads Number of threads. Must be at least 1.
+ * @param work Function called as @e work(w,i) to run the @e i-th task on
+ * the @e w-th thread.
+ */
+template <typename work_t>
+void parallel_for(
+	const std::size_t num_tasks, const std::size_t num_threads, const work_t& work
+)
+{
+	std::atomic<std::size_t> next{0};
+	std::vector<std::exception_ptr> errors(num_threads);
+
+	const auto run = [&](const std::size_t w)
+	{
+		try {
+			for (std::size_t i = next++; i < num_tasks; i = next++) {
+				work(w, i);
+			}
+		}
+		catch (...) {
+			errors[w] = std::current_exception();
+		}
+	};
+
+	{
+		std::vector<std::jthread> threads;
+		threads.reserve(num_threads - 1);
+		for (std::size_t w = 1; w < num_threads; ++w) {
+			threads.emplace_back(run, w);
+		}
+		run(0);
+	}
+
+	for (const std::exception_ptr& e : errors) {
+		if (e) {
+			std::rethrow_exception(e);
+		}
+	}
+}
+
+} // namespace detail
+} // namespace classtree
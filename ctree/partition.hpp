@@ -0,0 +1,437 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#if defined DEBUG
+#include <cassert>
+#endif
+#include <type_traits>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <span>
+
+// ctree includes
+#include <ctree/bulk_load.hpp>
+#include <ctree/ctree.hpp>
+
+namespace classtree {
+namespace detail {
+
+/**
+ * @brief Builds a tree from subtrees given in increasing order of keys.
+ * @tparam tree_t Type of the tree.
+ */
+template <typename tree_t>
+class ordered_builder;
+
+/**
+ * @brief Builds a tree from subtrees given in increasing order of keys.
+ *
+ * The subtrees are moved into the tree, never copied. The builder keeps
+ * the last node of every level open (the rightmost path of the tree) and
+ * appends it to its parent once no more subtrees can be added to it, so
+ * that the sizes of the nodes are correct without walking the tree.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t>
+class ordered_builder<basic_ctree<allocator_t, data_t, metadata_t, keys_t...>> {
+public:
+	/// The type of the tree built.
+	using tree_t = basic_ctree<allocator_t, data_t, metadata_t, keys_t...>;
+	/// Number of keys of the tree.
+	static constexpr std::size_t num_keys = sizeof...(keys_t);
+
+	/// The type of the nodes at depth @e d.
+	template <std::size_t d>
+	using node_t = typename node_at<tree_t, d>::type;
+	/// The type of the @e l-th key.
+	template <std::size_t l>
+	using key_t = std::tuple_element_t<l, std::tuple<keys_t...>>;
+
+public:
+	/// Default constructor.
+	ordered_builder() noexcept = default;
+
+	/**
+	 * @brief Constructor with the allocator of the tree built.
+	 * @param alloc The allocator of the root, usually the one of the tree
+	 * whose subtrees are added.
+	 */
+	explicit ordered_builder(
+		const typename tree_t::container_allocator_t& alloc
+	)
+	{
+		m_root.set_allocator(alloc);
+	}
+
+	/// Reserves memory for the children of the root.
+	void reserve(const std::size_t n)
+	{
+		m_root.reserve(n);
+	}
+
+	/**
+	 * @brief Adds a subtree to the tree.
+	 *
+	 * The keys of the subtree must not be less than the keys of the last
+	 * subtree added. When the path of the subtree is the path of the last
+	 * node added at its depth, the children of the subtree are added to
+	 * that node.
+	 * @tparam d Depth of the subtree. Must be at least 1.
+	 * @param c The subtree. Its children are moved.
+	 * @param path The keys of the path to the subtree (the @e d first keys).
+	 */
+	template <std::size_t d, typename path_t>
+	void place(node_t<d>&& c, const path_t& path)
+	{
+		static_assert(1 <= d and d <= num_keys);
+		static_assert(std::tuple_size_v<path_t> == d);
+
+		const std::size_t j = num_open<0, d>(path);
+		if (j == d) {
+			// the slot of the subtree is open: concatenate the subtrees
+			auto& slot = std::get<d - 1>(m_open)->second;
+			if constexpr (d == num_keys) {
+				slot.template merge<false>(std::move(c));
+			}
+			else {
+				for (auto& [k, cc] : c) {
+					place<d + 1>(
+						std::move(cc), std::tuple_cat(path, std::tie(k))
+					);
+				}
+			}
+			return;
+		}
+
+		close(j);
+		[&]<std::size_t... l>(std::index_sequence<l...>)
+		{
+			((l >= j ? open_level<l>(std::get<l>(path)) : void()), ...);
+		}(std::make_index_sequence<d - 1>{});
+		std::get<d - 1>(m_open).emplace(std::get<d - 1>(path), std::move(c));
+	}
+
+	/**
+	 * @brief The tree built.
+	 *
+	 * The builder is left empty.
+	 */
+	[[nodiscard]] tree_t finish()
+	{
+		close(0);
+		return std::move(m_root);
+	}
+
+private:
+	template <std::size_t... l>
+	static auto open_slots(std::index_sequence<l...>) -> std::tuple<
+		std::optional<std::pair<key_t<l>, node_t<l + 1>>>...>;
+
+	/// The parent of the open node at depth @e l + 1.
+	template <std::size_t l>
+	[[nodiscard]] node_t<l>& parent() noexcept
+	{
+		if constexpr (l == 0) {
+			return m_root;
+		}
+		else {
+			return std::get<l - 1>(m_open)->second;
+		}
+	}
+
+	/**
+	 * @brief The number of levels, from the top, whose open node has the
+	 * key values of @e path.
+	 *
+	 * When a level has no open node and the last child of its parent has
+	 * the key value of @e path, that child is opened again (the parent was
+	 * added as a whole).
+	 */
+	template <std::size_t l, std::size_t d, typename path_t>
+	[[nodiscard]] std::size_t num_open(const path_t& path)
+	{
+		if constexpr (l == d) {
+			return d;
+		}
+		else {
+			auto& slot = std::get<l>(m_open);
+			if (not slot.has_value()) {
+				auto& p = parent<l>();
+				if (p.num_keys() == 0 or
+					not (p.get_key(p.num_keys() - 1) == std::get<l>(path))) {
+					return l;
+				}
+				key_t<l> k = p.get_key(p.num_keys() - 1);
+				auto c = p.extract(k);
+				slot.emplace(std::move(k), std::move(c));
+			}
+			else if (not (slot->first == std::get<l>(path))) {
+				return l;
+			}
+			return num_open<l + 1, d>(path);
+		}
+	}
+
+	/// Opens a new node at level @e l.
+	template <std::size_t l>
+	void open_level(const key_t<l>& k)
+	{
+		std::get<l>(m_open).emplace(k, parent<l>().new_child());
+	}
+
+	/// Appends the open nodes at levels @e j and below to their parents.
+	void close(const std::size_t j)
+	{
+		[&]<std::size_t... i>(std::index_sequence<i...>)
+		{
+			((num_keys - 1 - i >= j ? close_level<num_keys - 1 - i>()
+									: void()),
+			 ...);
+		}(std::make_index_sequence<num_keys>{});
+	}
+
+	/// Appends the open node at level @e l to its parent.
+	template <std::size_t l>
+	void close_level()
+	{
+		auto& slot = std::get<l>(m_open);
+		if (slot.has_value()) {
+			parent<l>().append(
+				std::move(slot->first), std::move(slot->second)
+			);
+			slot.reset();
+		}
+	}
+
+private:
+	/// The root of the tree.
+	tree_t m_root;
+	/// The open node of every level, with its key value.
+	decltype(open_slots(std::make_index_sequence<num_keys>{})) m_open;
+};
+
+/// The state of a partition: the current piece and the elements assigned.
+struct partition_state {
+	/// Total number of elements.
+	std::size_t size;
+	/// Number of pieces.
+	std::size_t num_pieces;
+	/// The current piece.
+	std::size_t piece = 0;
+	/// Number of elements assigned to the pieces so far.
+	std::size_t assigned = 0;
+
+	/// Number of elements in the first @ref piece + 1 pieces.
+	[[nodiscard]] std::size_t cut() const noexcept
+	{
+		return (piece + 1) * size / num_pieces;
+	}
+	/// Is the current piece the last piece?
+	[[nodiscard]] bool last() const noexcept
+	{
+		return piece + 1 == num_pieces;
+	}
+};
+
+/**
+ * @brief Moves the subtrees of a node into the pieces.
+ *
+ * A subtree is moved as a whole into the current piece if it fits, and
+ * otherwise it is split. Leaves are never split: a leaf goes to the piece
+ * in which the difference to the cut is the smallest.
+ * @tparam d Depth of the node.
+ * @param n The node.
+ * @param path The keys of the path to @e n.
+ * @param pieces The builders of the pieces.
+ * @param s The state of the partition.
+ */
+template <std::size_t d, typename builder_t, typename node_t, typename path_t>
+void split(
+	node_t& n,
+	const path_t& path,
+	std::vector<builder_t>& pieces,
+	partition_state& s
+)
+{
+	for (auto& [k, c] : n) {
+		const std::size_t size = c.size();
+		const auto child_path = std::tuple_cat(path, std::tie(k));
+
+		if (not s.last() and s.assigned + size > s.cut()) {
+			if constexpr (d + 1 < builder_t::num_keys) {
+				split<d + 1>(c, child_path, pieces, s);
+				continue;
+			}
+			else if (s.assigned + size - s.cut() > s.cut() - s.assigned) {
+				++s.piece;
+			}
+		}
+
+		pieces[s.piece].template place<d + 1>(std::move(c), child_path);
+		s.assigned += size;
+		while (not s.last() and s.assigned >= s.cut()) {
+			++s.piece;
+		}
+	}
+}
+
+} // namespace detail
+
+/**
+ * @brief Splits a tree into trees of similar size.
+ *
+ * The tree is cut along the order of its keys, so that the @e i-th tree
+ * contains key values that are less than those of the @e i+1-th tree. The
+ * cuts are chosen with the sizes of the subtrees, and the subtrees between
+ * two cuts are moved as a whole: only the nodes on the path to every cut are
+ * visited. Leaves are not split, so the sizes of the trees differ by at most
+ * the size of the largest leaf.
+ * @param t The tree. It is left empty.
+ * @param num_pieces Number of trees. Must be at least 1.
+ * @returns @e num_pieces trees whose concatenation is @e t (see
+ * @ref assemble), with the allocator of @e t. Some may be empty when @e t
+ * has too few leaves.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t>
+	requires(sizeof...(keys_t) > 0)
+[[nodiscard]] std::vector<
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>>
+partition(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>&& t,
+	const std::size_t num_pieces
+)
+{
+#if defined DEBUG
+	assert(num_pieces > 0);
+#endif
+
+	using tree_t = basic_ctree<allocator_t, data_t, metadata_t, keys_t...>;
+	using builder_t = detail::ordered_builder<tree_t>;
+
+	std::vector<builder_t> pieces;
+	pieces.reserve(num_pieces);
+	for (std::size_t i = 0; i < num_pieces; ++i) {
+		pieces.emplace_back(t.get_allocator());
+	}
+	detail::partition_state s{.size = t.size(), .num_pieces = num_pieces};
+	detail::split<0>(t, std::tuple<>{}, pieces, s);
+	t.clear();
+
+	std::vector<tree_t> trees;
+	trees.reserve(num_pieces);
+	for (builder_t& b : pieces) {
+		trees.push_back(b.finish());
+	}
+	return trees;
+}
+
+/**
+ * @brief Splits a tree into binary files of similar size.
+ *
+ * The tree is split as in @ref partition, and the @e i-th tree is written
+ * to @e paths[i] with @ref save_binary. The files hold only keys and data,
+ * so this is restricted to trees without metadata; split trees with
+ * metadata with @ref partition and write the pieces in another format.
+ * @param t The tree. It is left empty, even when a file cannot be written.
+ * @param paths The paths to the files. Must not be empty.
+ * @returns Whether all the files could be written.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t>
+	requires(sizeof...(keys_t) > 0 and std::is_void_v<metadata_t>)
+[[nodiscard]] bool partition(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>&& t,
+	const std::span<const std::string> paths
+)
+{
+	const auto trees = partition(std::move(t), paths.size());
+	bool ok = true;
+	for (std::size_t i = 0; i < paths.size(); ++i) {
+		ok = save_binary(trees[i], paths[i]) and ok;
+	}
+	return ok;
+}
+
+/**
+ * @brief Concatenates trees whose key values do not overlap.
+ *
+ * Every element of the @e i-th tree must be less than every element of the
+ * @e i+1-th tree in the lexicographic order of the keys, as in the trees
+ * returned by @ref partition. The children of the roots are moved into the
+ * new tree; two consecutive trees that share a prefix of keys are only
+ * visited along that prefix. The cost is linear in the number of children
+ * of the roots, instead of the cost of @e merge.
+ * @param trees The trees. They are left empty.
+ * @returns The concatenation of the trees, with the allocator of the first
+ * tree.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t>
+	requires(sizeof...(keys_t) > 0)
+[[nodiscard]] basic_ctree<allocator_t, data_t, metadata_t, keys_t...> assemble(
+	std::vector<basic_ctree<allocator_t, data_t, metadata_t, keys_t...>>&&
+		trees
+)
+{
+	using tree_t = basic_ctree<allocator_t, data_t, metadata_t, keys_t...>;
+	using builder_t = detail::ordered_builder<tree_t>;
+
+	builder_t b = trees.empty()
+					  ? builder_t()
+					  : builder_t(trees.front().get_allocator());
+	std::size_t num_children = 0;
+	for (const tree_t& t : trees) {
+		num_children += t.num_keys();
+	}
+	b.reserve(num_children);
+
+	for (tree_t& t : trees) {
+		for (auto& [k, c] : t) {
+			b.template place<1>(std::move(c), std::tie(k));
+		}
+		t.clear();
+	}
+	return b.finish();
+}
+
+} // namespace classtree
@@ -0,0 +1,133 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * @brief Prefetch distance used by the iterators.
+ *
+ * When an iterator moves on to the next child of a node, it prefetches the
+ * memory of the child that is this many positions ahead. Define this macro
+ * before including the library to tune it; a value of 0 disables prefetching.
+ */
+#if not defined CTREE_PREFETCH_DISTANCE
+#define CTREE_PREFETCH_DISTANCE 2
+#endif
+
+namespace classtree {
+namespace detail {
+
+/// The prefetch distance (see @ref CTREE_PREFETCH_DISTANCE).
+inline constexpr std::size_t prefetch_distance = CTREE_PREFETCH_DISTANCE;
+
+/**
+ * @brief Hints the processor to load the cache line that contains @e p.
+ *
+ * This does nothing if the compiler does not support it. The pointer need not
+ * be valid.
+ * @param p Address to be read in the near future.
+ */
+inline void prefetch(const void *p) noexcept
+{
+#if defined __GNUC__ or defined __clang__
+	__builtin_prefetch(p, 0, 3);
+#else
+	(void)p;
+#endif
+}
+
+/**
+ * @brief Prefetches the memory of a child ahead of the current one.
+ *
+ * Prefetches the memory of the child at @ref prefetch_distance positions after
+ * (or before, if @e forward is false) @e it, if there is such a child.
+ * @tparam forward Direction of the iteration.
+ * @tparam container_iterator_t Iterator over pairs of key and child.
+ * @param it Iterator to the current child.
+ * @param first Iterator to the first child.
+ * @param last Iterator past the last child.
+ */
+template <bool forward, typename container_iterator_t>
+inline void prefetch_sibling(
+	const container_iterator_t it,
+	const container_iterator_t first,
+	const container_iterator_t last
+) noexcept
+{
+	if constexpr (prefetch_distance > 0) {
+		constexpr auto d = static_cast<std::ptrdiff_t>(prefetch_distance);
+		if constexpr (forward) {
+			if (last - it > d) {
+				(it + d)->second.prefetch();
+			}
+		}
+		else {
+			if (it - first >= d) {
+				(it - d)->second.prefetch();
+			}
+		}
+	}
+}
+
+/**
+ * @brief Prefetches the memory of all children ahead of the current one.
+ *
+ * Prefetches the memory of the children at 1, 2, ..., @ref prefetch_distance
+ * positions after (or before, if @e forward is false) @e it. This is used when
+ * an iteration starts.
+ * @tparam forward Direction of the iteration.
+ * @tparam container_iterator_t Iterator over pairs of key and child.
+ * @param it Iterator to the current child.
+ * @param first Iterator to the first child.
+ * @param last Iterator past the last child.
+ */
+template <bool forward, typename container_iterator_t>
+inline void prefetch_siblings(
+	const container_iterator_t it,
+	const container_iterator_t first,
+	const container_iterator_t last
+) noexcept
+{
+	if constexpr (prefetch_distance > 0) {
+		constexpr auto d = static_cast<std::ptrdiff_t>(prefetch_distance);
+		if constexpr (forward) {
+			const auto n = std::min(d, last - it - 1);
+			for (std::ptrdiff_t i = 1; i <= n; ++i) {
+				(it + i)->second.prefetch();
+			}
+		}
+		else {
+			const auto n = std::min(d, it - first);
+			for (std::ptrdiff_t i = 1; i <= n; ++i) {
+				(it - i)->second.prefetch();
+			}
+		}
+	}
+}
+
+} // namespace detail
+} // namespace classtree
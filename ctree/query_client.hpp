@@ -0,0 +1,250 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <optional>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <utility>
+#include <string>
+#include <vector>
+#include <span>
+
+// POSIX includes
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// ctree includes
+#include <ctree/query_protocol.hpp>
+#include <ctree/ctree.hpp>
+
+namespace classtree {
+
+/**
+ * @brief A client of a @ref query_server.
+ * @tparam tree_t Type of the tree of the server.
+ */
+template <typename tree_t>
+class query_client;
+
+/**
+ * @brief A client of a @ref query_server.
+ *
+ * The requests are accumulated into a batch, which is sent to the server
+ * with @ref execute. A client must not be used by several threads at the
+ * same time.
+ * @tparam allocator_t Allocator template used in every node of the tree.
+ * @tparam data_t Type of the data stored in the leaves of the tree.
+ * @tparam metadata_t Type of the metadata stored in the leaves of the tree.
+ * @tparam keys_t Types of the keys of the tree.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t>
+	requires(
+		sizeof...(keys_t) > 0 and Transferable<data_t> and
+		Transferable<metadata_t> and (Transferable<keys_t> and ...)
+	)
+class query_client<basic_ctree<allocator_t, data_t, metadata_t, keys_t...>> {
+public:
+
+	/// Type of the elements in the leaves.
+	using leaf_element_t = element_t<data_t, metadata_t>;
+
+public:
+
+	/// Default constructor.
+	query_client()
+	{
+		clear();
+	}
+
+	/// Copy constructor.
+	query_client(const query_client&) = delete;
+	/// Copy assignment operator.
+	query_client& operator= (const query_client&) = delete;
+
+	/// Destructor. Closes the connection.
+	~query_client() noexcept
+	{
+		close();
+	}
+
+	/**
+	 * @brief Connects to a server.
+	 * @param path Path of the socket of the server.
+	 * @returns False on error.
+	 */
+	[[nodiscard]] bool connect(const std::string& path)
+	{
+		close();
+
+		sockaddr_un address{};
+		address.sun_family = AF_UNIX;
+		if (path.size() >= sizeof(address.sun_path)) {
+			return false;
+		}
+		std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+		m_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (m_fd < 0) {
+			return false;
+		}
+		if (::connect(
+				m_fd,
+				reinterpret_cast<const sockaddr *>(&address),
+				sizeof(address)
+			) != 0) {
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	/// Closes the connection.
+	void close() noexcept
+	{
+		if (m_fd >= 0) {
+			::close(m_fd);
+			m_fd = -1;
+		}
+	}
+
+	/// Is this client connected?
+	[[nodiscard]] bool connected() const noexcept
+	{
+		return m_fd >= 0;
+	}
+
+	/**
+	 * @brief Adds a @ref query_type::find request to the batch.
+	 * @param data Data of the element.
+	 * @param ks Keys of the element.
+	 */
+	void find(const data_t& data, const keys_t&...ks)
+	{
+		begin_request(query_type::find);
+		(detail::put(m_batch, ks), ...);
+		detail::put(m_batch, data);
+	}
+
+	/**
+	 * @brief Adds a @ref query_type::count request to the batch.
+	 * @param ks Keys of the leaf.
+	 */
+	void count(const keys_t&...ks)
+	{
+		begin_request(query_type::count);
+		(detail::put(m_batch, ks), ...);
+	}
+
+	/**
+	 * @brief Adds a @ref query_type::range request to the batch.
+	 * @param intervals Closed interval of values of every key.
+	 */
+	void range(const std::pair<keys_t, keys_t>&...intervals)
+	{
+		begin_request(query_type::range);
+		(detail::put(m_batch, intervals.first), ...);
+		(detail::put(m_batch, intervals.second), ...);
+	}
+
+	/**
+	 * @brief Adds a @ref query_type::add request to the batch.
+	 * @param element Element to add.
+	 * @param ks Keys of the element.
+	 */
+	void add(const leaf_element_t& element, const keys_t&...ks)
+	{
+		begin_request(query_type::add);
+		detail::put(m_batch, element);
+		(detail::put(m_batch, ks), ...);
+	}
+
+	/// Number of requests in the batch.
+	[[nodiscard]] std::size_t num_requests() const noexcept
+	{
+		return m_num_requests;
+	}
+
+	/// Removes all requests from the batch.
+	void clear()
+	{
+		m_batch.assign(sizeof(std::uint32_t), std::byte{0});
+		m_num_requests = 0;
+	}
+
+	/**
+	 * @brief Sends the batch to the server and waits for the answers.
+	 *
+	 * The batch is cleared.
+	 * @returns One result per request, in the order of the requests, or
+	 * nothing on error.
+	 */
+	[[nodiscard]] std::optional<std::vector<std::uint64_t>> execute()
+	{
+		const std::uint32_t n = m_num_requests;
+		std::memcpy(m_batch.data(), &n, sizeof(n));
+
+		const bool sent = detail::write_frame(m_fd, m_batch);
+		clear();
+		if (not sent or not detail::read_frame(m_fd, m_response) or
+			m_response.size() != n * sizeof(std::uint64_t)) {
+			return std::nullopt;
+		}
+
+		std::vector<std::uint64_t> results(n);
+		if (n > 0) {
+			std::memcpy(results.data(), m_response.data(), m_response.size());
+		}
+		return results;
+	}
+
+private:
+
+	/// Starts a new request in the batch.
+	void begin_request(const query_type type)
+	{
+		detail::put(m_batch, static_cast<std::uint8_t>(type));
+		++m_num_requests;
+	}
+
+private:
+
+	/// The socket.
+	int m_fd = -1;
+	/// The number of requests in the batch.
+	std::uint32_t m_num_requests = 0;
+	/// The batch: the number of requests followed by the requests.
+	std::vector<std::byte> m_batch;
+	/// The answer of the server.
+	std::vector<std::byte> m_response;
+};
+
+} // namespace classtree
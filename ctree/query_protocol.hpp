@@ -0,0 +1,257 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <chrono>
+#include <limits>
+#include <cstring>
+#include <cstddef>
+#include <vector>
+#include <span>
+
+// POSIX includes
+#include <sys/socket.h>
+#include <unistd.h>
+#include <poll.h>
+#include <cerrno>
+
+namespace classtree {
+
+/**
+ * @brief Types of the requests to a @ref query_server.
+ *
+ * Every request is answered with one unsigned 64-bit integer.
+ */
+enum class query_type : std::uint8_t {
+	/// Is there an element with some data under some keys? (0 or 1).
+	find = 0,
+	/// Number of elements under some keys.
+	count = 1,
+	/// Number of elements whose keys are in closed intervals.
+	range = 2,
+	/// Add an element under some keys (1 if it was added, 0 otherwise).
+	add = 3,
+};
+
+/**
+ * @brief Types that can be sent to a @ref query_server.
+ *
+ * They are copied byte by byte; the server and the client run on the same
+ * machine.
+ */
+template <typename T>
+concept Transferable = std::is_void_v<T> or std::is_trivially_copyable_v<T>;
+
+namespace detail {
+
+/// Largest frame accepted by the server and the client.
+inline constexpr std::uint32_t max_frame_size = 1u << 30;
+
+/// Appends the bytes of @e value to @e buffer.
+template <typename T>
+void put(std::vector<std::byte>& buffer, const T& value)
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	const std::size_t n = buffer.size();
+	buffer.resize(n + sizeof(T));
+	std::memcpy(buffer.data() + n, &value, sizeof(T));
+}
+
+/**
+ * @brief Reads a value from the front of @e buffer.
+ * @returns False if @e buffer is too short.
+ */
+template <typename T>
+[[nodiscard]] bool get(std::span<const std::byte>& buffer, T& value) noexcept
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	if (buffer.size() < sizeof(T)) {
+		return false;
+	}
+	std::memcpy(&value, buffer.data(), sizeof(T));
+	buffer = buffer.subspan(sizeof(T));
+	return true;
+}
+
+/// Point in time after which reading or writing a frame is abandoned.
+using deadline_t = std::chrono::steady_clock::time_point;
+
+/// A deadline that never passes.
+inline constexpr deadline_t no_deadline = deadline_t::max();
+
+/**
+ * @brief Waits until the socket @e fd is ready for @e events.
+ * @returns False if @e deadline passed or on error.
+ */
+[[nodiscard]] inline bool
+wait_for(const int fd, const short events, const deadline_t deadline) noexcept
+{
+	int timeout = -1;
+	if (deadline != no_deadline) {
+		const auto now = std::chrono::steady_clock::now();
+		if (now >= deadline) {
+			return false;
+		}
+		// round up, so that the deadline has passed when poll times out
+		using std::chrono::milliseconds;
+		const auto ms = std::chrono::ceil<milliseconds>(deadline - now).count();
+		timeout = static_cast<int>(
+			std::min<decltype(ms)>(ms, std::numeric_limits<int>::max())
+		);
+	}
+	pollfd p{fd, events, 0};
+	const int r = ::poll(&p, 1, timeout);
+	// on EINTR the caller tries again and waits for the remaining time
+	return r > 0 or (r < 0 and errno == EINTR);
+}
+
+/**
+ * @brief Writes all of @e bytes to the socket @e fd.
+ * @returns False on error or if @e deadline passed first.
+ */
+[[nodiscard]] inline bool write_all(
+	const int fd,
+	std::span<const std::byte> bytes,
+	const deadline_t deadline = no_deadline
+) noexcept
+{
+	while (not bytes.empty()) {
+		const ssize_t n = ::send(
+			fd, bytes.data(), bytes.size(), MSG_NOSIGNAL | MSG_DONTWAIT
+		);
+		if (n < 0 and errno == EINTR) {
+			continue;
+		}
+		if (n < 0 and errno == EAGAIN) {
+			if (not wait_for(fd, POLLOUT, deadline)) {
+				return false;
+			}
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		bytes = bytes.subspan(static_cast<std::size_t>(n));
+	}
+	return true;
+}
+
+/**
+ * @brief Reads exactly @e bytes.size() bytes from the socket @e fd.
+ * @returns False on error, when the peer closed the connection, or if
+ * @e deadline passed first.
+ */
+[[nodiscard]] inline bool read_all(
+	const int fd,
+	std::span<std::byte> bytes,
+	const deadline_t deadline = no_deadline
+) noexcept
+{
+	while (not bytes.empty()) {
+		const ssize_t n =
+			::recv(fd, bytes.data(), bytes.size(), MSG_DONTWAIT);
+		if (n < 0 and errno == EINTR) {
+			continue;
+		}
+		if (n < 0 and errno == EAGAIN) {
+			if (not wait_for(fd, POLLIN, deadline)) {
+				return false;
+			}
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		bytes = bytes.subspan(static_cast<std::size_t>(n));
+	}
+	return true;
+}
+
+/**
+ * @brief Sends a frame: the size of the payload followed by the payload.
+ * @param fd Socket.
+ * @param payload The payload.
+ * @param deadline The whole frame must be sent before this point in time.
+ * @returns False on error or if @e deadline passed first.
+ */
+[[nodiscard]] inline bool write_frame(
+	const int fd,
+	const std::span<const std::byte> payload,
+	const deadline_t deadline = no_deadline
+)
+{
+	if (payload.size() > max_frame_size) {
+		return false;
+	}
+	std::vector<std::byte> frame;
+	frame.reserve(sizeof(std::uint32_t) + payload.size());
+	put(frame, static_cast<std::uint32_t>(payload.size()));
+	frame.insert(frame.end(), payload.begin(), payload.end());
+	return write_all(fd, frame, deadline);
+}
+
+/**
+ * @brief Receives a frame (see @ref write_frame).
+ * @param fd Socket.
+ * @param payload The payload of the frame.
+ * @param deadline The whole frame must arrive before this point in time.
+ * @returns False on error, when the peer closed the connection, or if
+ * @e deadline passed first.
+ */
+[[nodiscard]] inline bool read_frame(
+	const int fd,
+	std::vector<std::byte>& payload,
+	const deadline_t deadline = no_deadline
+)
+{
+	std::uint32_t size;
+	if (not read_all(
+			fd, std::as_writable_bytes(std::span(&size, 1)), deadline
+		)) {
+		return false;
+	}
+	if (size > max_frame_size) {
+		return false;
+	}
+	// grow the payload as the bytes arrive, not with the announced size
+	payload.clear();
+	while (payload.size() < size) {
+		const std::size_t n = payload.size();
+		const std::size_t chunk = std::min<std::size_t>(
+			size - n, std::max<std::size_t>(n, std::size_t{1} << 16)
+		);
+		payload.resize(n + chunk);
+		if (not read_all(fd, std::span(payload).subspan(n), deadline)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace detail
+} // namespace classtree
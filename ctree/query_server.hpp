@@ -0,0 +1,685 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <condition_variable>
+#include <shared_mutex>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <numeric>
+#include <chrono>
+#include <utility>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <tuple>
+#include <span>
+#include <set>
+
+// POSIX includes
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <poll.h>
+#include <cerrno>
+
+// ctree includes
+#include <ctree/query_protocol.hpp>
+#include <ctree/range_iterator.hpp>
+#include <ctree/concepts.hpp>
+#include <ctree/key_set.hpp>
+#include <ctree/ctree.hpp>
+
+namespace classtree {
+
+/**
+ * @brief A server that answers queries on a tree over a Unix domain socket.
+ * @tparam tree_t Type of the tree.
+ * @tparam unique Add elements with @e add<unique>.
+ */
+template <typename tree_t, bool unique = true>
+class query_server;
+
+/**
+ * @brief A server that answers queries on a tree over a Unix domain socket.
+ *
+ * The server owns a tree. Clients (see @ref query_client) send batches of
+ * requests (see @ref query_type) in frames. Every batch is executed by one
+ * of the threads of a pool and answered with one frame. The requests that
+ * do not modify the tree are executed under a shared lock, so batches of
+ * queries are executed concurrently. The @ref query_type::find and
+ * @ref query_type::count requests between two @ref query_type::add
+ * requests of a batch are sorted by their keys and answered in a single
+ * traversal of the tree.
+ *
+ * A thread waits for new connections and for requests in the connections
+ * that are idle, and hands them to the pool.
+ * @tparam allocator_t Allocator template used in every node of the tree.
+ * @tparam data_t Type of the data stored in the leaves of the tree.
+ * @tparam metadata_t Type of the metadata stored in the leaves of the tree.
+ * @tparam keys_t Types of the keys of the tree.
+ * @tparam unique Add elements with @e add<unique>.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t,
+	bool unique>
+	requires(
+		sizeof...(keys_t) > 0 and Transferable<data_t> and
+		Transferable<metadata_t> and (Transferable<keys_t> and ...)
+	)
+class query_server<basic_ctree<allocator_t, data_t, metadata_t, keys_t...>, unique> {
+public:
+
+	/// Type of the tree.
+	using tree_t = basic_ctree<allocator_t, data_t, metadata_t, keys_t...>;
+	/// Type of the elements in the leaves.
+	using leaf_element_t = element_t<data_t, metadata_t>;
+
+public:
+
+	/// Default constructor.
+	query_server() noexcept = default;
+	/// Constructor with a tree.
+	explicit query_server(tree_t&& t) noexcept
+		: m_tree(std::move(t))
+	{ }
+
+	/// Copy constructor.
+	query_server(const query_server&) = delete;
+	/// Copy assignment operator.
+	query_server& operator= (const query_server&) = delete;
+
+	/// Destructor. Stops the server.
+	~query_server() noexcept
+	{
+		stop();
+	}
+
+	/**
+	 * @brief Starts listening for clients.
+	 *
+	 * A file that exists at @e path is replaced.
+	 * @param path Path of the socket.
+	 * @param num_threads Number of threads that execute the requests. Must
+	 * be at least 1.
+	 * @param timeout Maximum time to receive a whole batch of requests once
+	 * its first byte has arrived, and to send the whole response. The
+	 * connections that exceed it are closed, so that slow or stalled clients
+	 * do not hold a thread.
+	 * @returns False if the server is running, @e num_threads is 0, or the
+	 * socket could not be created.
+	 */
+	[[nodiscard]] bool start(
+		const std::string& path,
+		const std::size_t num_threads,
+		const std::chrono::milliseconds timeout = std::chrono::seconds(5)
+	)
+	{
+		if (running() or num_threads == 0) {
+			return false;
+		}
+
+		sockaddr_un address{};
+		address.sun_family = AF_UNIX;
+		if (path.size() >= sizeof(address.sun_path)) {
+			return false;
+		}
+		std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+		m_listen = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (m_listen < 0) {
+			return false;
+		}
+		::unlink(path.c_str());
+		if (::bind(
+				m_listen,
+				reinterpret_cast<const sockaddr *>(&address),
+				sizeof(address)
+			) != 0 or
+			::listen(m_listen, SOMAXCONN) != 0 or ::pipe(m_wake) != 0) {
+			close_all();
+			return false;
+		}
+
+		m_path = path;
+		m_timeout = timeout;
+		m_stop = false;
+		m_poller = std::jthread([this]() { poll_loop(); });
+		for (std::size_t i = 0; i < num_threads; ++i) {
+			m_workers.emplace_back([this]() { work_loop(); });
+		}
+		return true;
+	}
+
+	/// Stops the server and closes all connections.
+	void stop() noexcept
+	{
+		if (not running()) {
+			return;
+		}
+
+		{
+			std::unique_lock lock(m_mutex);
+			m_stop = true;
+			// unblock the threads that are reading a request
+			for (const int fd : m_connections) {
+				::shutdown(fd, SHUT_RDWR);
+			}
+		}
+		m_ready_cv.notify_all();
+		wake_poller();
+
+		m_poller.join();
+		for (std::jthread& w : m_workers) {
+			w.join();
+		}
+		m_workers.clear();
+
+		close_all();
+		::unlink(m_path.c_str());
+	}
+
+	/// Is the server running?
+	[[nodiscard]] bool running() const noexcept
+	{
+		return m_listen >= 0;
+	}
+
+	/**
+	 * @brief The tree of this server.
+	 *
+	 * Must not be modified while the server is running.
+	 */
+	[[nodiscard]] tree_t& tree() noexcept
+	{
+		return m_tree;
+	}
+	/// The tree of this server.
+	[[nodiscard]] const tree_t& tree() const noexcept
+	{
+		return m_tree;
+	}
+
+private:
+
+	/// A request of a batch.
+	struct request {
+		/// Type of request.
+		query_type type;
+		/// The keys, or the lower bounds of the intervals of a range.
+		std::tuple<keys_t...> keys;
+		/// The upper bounds of the intervals of a range.
+		std::tuple<keys_t...> upper;
+		/// The element to add, or whose data is to be found.
+		leaf_element_t element;
+	};
+
+	/// Reads a tuple of keys from the front of @e payload.
+	[[nodiscard]] static bool
+	get_keys(std::span<const std::byte>& payload, std::tuple<keys_t...>& keys)
+	{
+		return std::apply(
+			[&](auto&...ks) { return (detail::get(payload, ks) and ...); }, keys
+		);
+	}
+
+	/// Reads the data of an element from the front of @e payload.
+	[[nodiscard]] static bool
+	get_data(std::span<const std::byte>& payload, leaf_element_t& element)
+	{
+		if constexpr (std::is_void_v<metadata_t>) {
+			return detail::get(payload, element);
+		}
+		else {
+			return detail::get(payload, element.data);
+		}
+	}
+
+	/**
+	 * @brief Decodes a batch of requests.
+	 * @returns False if the payload is malformed.
+	 */
+	[[nodiscard]] static bool
+	parse(std::span<const std::byte> payload, std::vector<request>& requests)
+	{
+		// the smallest request is a count: its type and its keys
+		constexpr std::size_t min_request_bytes =
+			sizeof(std::uint8_t) + (sizeof(keys_t) + ...);
+
+		std::uint32_t n;
+		if (not detail::get(payload, n) or
+			n > payload.size() / min_request_bytes) {
+			return false;
+		}
+
+		requests.resize(n);
+		for (request& r : requests) {
+			std::uint8_t type;
+			if (not detail::get(payload, type)) {
+				return false;
+			}
+			r.type = static_cast<query_type>(type);
+
+			bool ok;
+			switch (r.type) {
+			case query_type::find:
+				ok = get_keys(payload, r.keys) and get_data(payload, r.element);
+				break;
+			case query_type::count:
+				ok = get_keys(payload, r.keys);
+				break;
+			case query_type::range:
+				ok = get_keys(payload, r.keys) and get_keys(payload, r.upper);
+				break;
+			case query_type::add:
+				ok = detail::get(payload, r.element) and get_keys(payload, r.keys);
+				break;
+			default:
+				ok = false;
+			}
+			if (not ok) {
+				return false;
+			}
+		}
+		return payload.empty();
+	}
+
+	/// Is there an element with the data of @e e in @e leaf?
+	template <typename leaf_t>
+	[[nodiscard]] static bool
+	contains(const leaf_t& leaf, const leaf_element_t& e) noexcept
+	{
+		const auto data = [](const leaf_element_t& x) -> const data_t&
+		{
+			if constexpr (std::is_void_v<metadata_t>) {
+				return x;
+			}
+			else {
+				return x.data;
+			}
+		};
+
+		if constexpr (LessthanComparable<data_t>) {
+			const auto it = std::partition_point(
+				leaf.begin(),
+				leaf.end(),
+				[&](const leaf_element_t& x) { return data(x) < data(e); }
+			);
+			return it != leaf.end() and data(*it) == data(e);
+		}
+		else {
+			return std::any_of(
+				leaf.begin(),
+				leaf.end(),
+				[&](const leaf_element_t& x) { return data(x) == data(e); }
+			);
+		}
+	}
+
+	/**
+	 * @brief Answers @ref query_type::find and @ref query_type::count
+	 * requests in one traversal.
+	 *
+	 * The children of @e node are searched for the keys of the requests
+	 * at this level in one pass.
+	 * @param node Node at level @e level.
+	 * @param requests The requests of the batch.
+	 * @param group Indices of the requests, sorted by their keys, whose
+	 * first @e level keys lead to @e node.
+	 * @param results The results of the requests.
+	 */
+	template <std::size_t level, typename node_t>
+	static void lookup(
+		const node_t& node,
+		const std::vector<request>& requests,
+		const std::span<const std::size_t> group,
+		std::vector<std::uint64_t>& results
+	)
+	{
+		if constexpr (level == sizeof...(keys_t)) {
+			for (const std::size_t i : group) {
+				results[i] = requests[i].type == query_type::count
+								 ? node.size()
+								 : contains(node, requests[i].element);
+			}
+		}
+		else {
+			auto first = node.begin();
+			const auto last = node.end();
+			for (std::size_t g = 0; g < group.size();) {
+				const auto& k = std::get<level>(requests[group[g]].keys);
+				std::size_t h = g + 1;
+				while (h < group.size() and
+					   std::get<level>(requests[group[h]].keys) == k) {
+					++h;
+				}
+
+				first = detail::gallop(
+					first, last, [&](const auto& p) { return p.first < k; }
+				);
+				if (first != last and first->first == k) {
+					lookup<level + 1>(
+						first->second, requests, group.subspan(g, h - g), results
+					);
+				}
+				g = h;
+			}
+		}
+	}
+
+	/// Answers a @ref query_type::range request.
+	[[nodiscard]] std::uint64_t range_count(const request& r) const
+	{
+		return [&]<std::size_t... I>(std::index_sequence<I...>)
+		{
+			return m_tree
+				.get_const_range_iterator(
+					[&lo = std::get<I>(r.keys),
+					 &hi = std::get<I>(r.upper)](const auto& k) -> bool
+					{
+						return not(k < lo) and not(hi < k);
+					}...
+				)
+				.count();
+		}(std::index_sequence_for<keys_t...>{});
+	}
+
+	/// Answers the requests in [@e begin, @e end), none of which is an add.
+	void answer_queries(
+		const std::vector<request>& requests,
+		const std::size_t begin,
+		const std::size_t end,
+		std::vector<std::size_t>& order,
+		std::vector<std::uint64_t>& results
+	) const
+	{
+		order.clear();
+		for (std::size_t i = begin; i < end; ++i) {
+			if (requests[i].type == query_type::range) {
+				results[i] = range_count(requests[i]);
+			}
+			else {
+				order.push_back(i);
+			}
+		}
+
+		std::sort(
+			order.begin(),
+			order.end(),
+			[&](const std::size_t i, const std::size_t j)
+			{
+				return requests[i].keys < requests[j].keys;
+			}
+		);
+		lookup<0>(m_tree, requests, order, results);
+	}
+
+	/// Executes a batch of requests, in order.
+	void execute(
+		const std::vector<request>& requests,
+		std::vector<std::size_t>& order,
+		std::vector<std::uint64_t>& results
+	)
+	{
+		results.assign(requests.size(), 0);
+
+		const bool modifies = std::any_of(
+			requests.begin(),
+			requests.end(),
+			[](const request& r) { return r.type == query_type::add; }
+		);
+		if (not modifies) {
+			std::shared_lock lock(m_tree_mutex);
+			answer_queries(requests, 0, requests.size(), order, results);
+			return;
+		}
+
+		std::unique_lock lock(m_tree_mutex);
+		for (std::size_t i = 0; i < requests.size();) {
+			if (requests[i].type == query_type::add) {
+				leaf_element_t e = requests[i].element;
+				results[i] = std::apply(
+					[&](const auto&...ks)
+					{
+						return m_tree.template add<unique>(std::move(e), ks...);
+					},
+					requests[i].keys
+				);
+				++i;
+				continue;
+			}
+
+			std::size_t j = i + 1;
+			while (j < requests.size() and requests[j].type != query_type::add) {
+				++j;
+			}
+			answer_queries(requests, i, j, order, results);
+			i = j;
+		}
+	}
+
+	/// Wakes up the thread that polls the connections.
+	void wake_poller() noexcept
+	{
+		const char c = 0;
+		[[maybe_unused]] const ssize_t n = ::write(m_wake[1], &c, 1);
+	}
+
+	/// Closes a connection.
+	void close_connection(const int fd) noexcept
+	{
+		{
+			std::unique_lock lock(m_mutex);
+			m_connections.erase(fd);
+		}
+		::close(fd);
+	}
+
+	/// Waits for connections and requests and hands them to the pool.
+	void poll_loop()
+	{
+		std::vector<int> idle;
+		std::vector<pollfd> fds;
+
+		while (not m_stop) {
+			fds.clear();
+			fds.push_back({m_wake[0], POLLIN, 0});
+			fds.push_back({m_listen, POLLIN, 0});
+			for (const int fd : idle) {
+				fds.push_back({fd, POLLIN, 0});
+			}
+
+			if (::poll(fds.data(), fds.size(), -1) < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				break;
+			}
+
+			idle.clear();
+			{
+				std::unique_lock lock(m_mutex);
+				for (std::size_t i = 2; i < fds.size(); ++i) {
+					if (fds[i].revents == 0) {
+						idle.push_back(fds[i].fd);
+					}
+					else {
+						m_ready.push_back(fds[i].fd);
+					}
+				}
+
+				if (fds[0].revents != 0) {
+					char buffer[64];
+					[[maybe_unused]] const ssize_t n =
+						::read(m_wake[0], buffer, sizeof(buffer));
+					idle.insert(idle.end(), m_returned.begin(), m_returned.end());
+					m_returned.clear();
+				}
+
+				if (fds[1].revents != 0) {
+					const int fd = ::accept(m_listen, nullptr, nullptr);
+					if (fd >= 0) {
+						m_connections.insert(fd);
+						idle.push_back(fd);
+					}
+				}
+			}
+			m_ready_cv.notify_all();
+		}
+	}
+
+	/**
+	 * @brief Receives, executes and answers one batch of requests.
+	 * @param fd The connection.
+	 * @param payload Buffer for the batch.
+	 * @param requests Buffer for the decoded requests.
+	 * @param order Buffer for @ref execute.
+	 * @param results Buffer for the results.
+	 * @returns False if the connection has to be closed.
+	 */
+	[[nodiscard]] bool serve(
+		const int fd,
+		std::vector<std::byte>& payload,
+		std::vector<request>& requests,
+		std::vector<std::size_t>& order,
+		std::vector<std::uint64_t>& results
+	)
+	{
+		const auto deadline = [&]()
+		{ return std::chrono::steady_clock::now() + m_timeout; };
+		if (not detail::read_frame(fd, payload, deadline()) or
+			not parse(payload, requests)) {
+			return false;
+		}
+		execute(requests, order, results);
+		return detail::write_frame(
+			fd, std::as_bytes(std::span(results)), deadline()
+		);
+	}
+
+	/// Executes the batches of requests of the ready connections.
+	void work_loop()
+	{
+		std::vector<std::byte> payload;
+		std::vector<request> requests;
+		std::vector<std::size_t> order;
+		std::vector<std::uint64_t> results;
+
+		while (true) {
+			int fd;
+			{
+				std::unique_lock lock(m_mutex);
+				m_ready_cv.wait(
+					lock, [&]() { return m_stop or not m_ready.empty(); }
+				);
+				if (m_stop) {
+					return;
+				}
+				fd = m_ready.front();
+				m_ready.pop_front();
+			}
+
+			bool served = false;
+			try {
+				served = serve(fd, payload, requests, order, results);
+			}
+			catch (...) {
+				// e.g., std::bad_alloc: only this connection is lost
+			}
+			if (served) {
+				{
+					std::unique_lock lock(m_mutex);
+					m_returned.push_back(fd);
+				}
+				wake_poller();
+			}
+			else {
+				close_connection(fd);
+			}
+		}
+	}
+
+	/// Closes all sockets and pipes.
+	void close_all() noexcept
+	{
+		for (const int fd : m_connections) {
+			::close(fd);
+		}
+		m_connections.clear();
+		m_ready.clear();
+		m_returned.clear();
+
+		for (int *fd : {&m_listen, &m_wake[0], &m_wake[1]}) {
+			if (*fd >= 0) {
+				::close(*fd);
+				*fd = -1;
+			}
+		}
+	}
+
+private:
+
+	/// The tree.
+	tree_t m_tree;
+	/// Lock of the tree.
+	std::shared_mutex m_tree_mutex;
+
+	/// Path of the socket.
+	std::string m_path;
+	/// Timeout of the reads and writes on the connections.
+	std::chrono::milliseconds m_timeout{0};
+	/// Socket that listens for connections.
+	int m_listen = -1;
+	/// Pipe that wakes up the thread that polls the connections.
+	int m_wake[2] = {-1, -1};
+
+	/// Thread that polls the connections.
+	std::jthread m_poller;
+	/// Threads that execute the requests.
+	std::vector<std::jthread> m_workers;
+
+	/// Lock of the connections.
+	std::mutex m_mutex;
+	/// Signals that a connection is ready or that the server stops.
+	std::condition_variable m_ready_cv;
+	/// Has the server been stopped?
+	std::atomic<bool> m_stop = false;
+	/// All open connections.
+	std::set<int> m_connections;
+	/// Connections with a request.
+	std::deque<int> m_ready;
+	/// Connections whose request was answered.
+	std::vector<int> m_returned;
+};
+
+} // namespace classtree
@@ -25,16 +25,26 @@
 
 // C++ includes
 #include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <array>
 #include <tuple>
+#include <span>
+#include <bit>
 
 // ctree includes
+#include <ctree/batch_predicate.hpp>
 #include <ctree/ctree.hpp>
+#include <ctree/key_set.hpp>
+#include <ctree/prefetch.hpp>
 
 namespace classtree {
 namespace detail {
 
 /**
  * @brief Partial template specialization of the @ref iterator_ class.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam tree_pointer_t Type of the pointer to the tree iterated on.
  * @tparam container_iterator_t Type of the iterator over the keys of the tree iterated on.
  * @tparam data_t Type of the values to add.
@@ -42,6 +52,7 @@ namespace detail {
  * @tparam keys_t Type of the remaining keys.
  */
 template <
+	template <typename> class allocator_t,
 	typename tree_pointer_t,
 	typename container_iterator_t,
 	typename data_t,
@@ -51,6 +62,7 @@ class range_iterator_;
 
 /**
  * @brief Shorthand for the type of iterator over the children of the current subtree.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam tree_pointer_t Type of the pointer to the tree iterated on.
  * @tparam data_t Type of the values to add.
  * @tparam metadata_t Type of the metadata associated to the values.
@@ -58,6 +70,7 @@ class range_iterator_;
  * @tparam keys_t Type of the remaining keys.
  */
 template <
+	template <typename> class allocator_t,
 	typename tree_pointer_t,
 	typename data_t,
 	typename metadata_t,
@@ -68,26 +81,33 @@ struct sub_range_iterator {
 	/// Is @e tree_pointer_t const-qualified?
 	static constexpr bool is_constant = std::is_same_v<
 		tree_pointer_t,
-		const_pointer_t<data_t, metadata_t, key_t, keys_t...>>;
+		const_pointer_t<allocator_t, data_t, metadata_t, key_t, keys_t...>>;
 
 	/// Shorthand for a non-constant pointer type.
-	using non_const_pointer_type = pointer_t<data_t, metadata_t, keys_t...>;
+	using non_const_pointer_type =
+		pointer_t<allocator_t, data_t, metadata_t, keys_t...>;
 	/// Shorthand for a constant pointer type.
-	using const_pointer_type = const_pointer_t<data_t, metadata_t, keys_t...>;
+	using const_pointer_type =
+		const_pointer_t<allocator_t, data_t, metadata_t, keys_t...>;
+
+	/// Shorthand for the type of the subtree.
+	using subtree_type =
+		basic_ctree<allocator_t, data_t, metadata_t, keys_t...>;
 
 	/// Shorthand for a non-constant iterator type.
 	using non_const_range_iterator_type = range_iterator_<
+		allocator_t,
 		non_const_pointer_type,
-		typename ctree<data_t, metadata_t, keys_t...>::container_t::iterator,
+		typename subtree_type::container_t::iterator,
 		data_t,
 		metadata_t,
 		keys_t...>;
 
 	/// Shorthand for a constant iterator type.
 	using const_range_iterator_type = range_iterator_<
+		allocator_t,
 		const_pointer_type,
-		typename ctree<data_t, metadata_t, keys_t...>::container_t::
-			const_iterator,
+		typename subtree_type::container_t::const_iterator,
 		data_t,
 		metadata_t,
 		keys_t...>;
@@ -101,6 +121,7 @@ struct sub_range_iterator {
 
 /**
  * @brief Shorthand for the type of iterator over the children of the current subtree.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam tree_pointer_t Type of the pointer to the tree iterated on.
  * @tparam data_t Type of the values to add.
  * @tparam metadata_t Type of the metadata associated to the values.
@@ -108,30 +129,38 @@ struct sub_range_iterator {
  * @tparam keys_t Type of the remaining keys.
  */
 template <
+	template <typename> class allocator_t,
 	typename tree_pointer_t,
 	typename data_t,
 	typename metadata_t,
 	Comparable key_t,
 	Comparable... keys_t>
-using sub_range_iterator_t =
-	sub_range_iterator<tree_pointer_t, data_t, metadata_t, key_t, keys_t...>::
-		type;
+using sub_range_iterator_t = sub_range_iterator<
+	allocator_t,
+	tree_pointer_t,
+	data_t,
+	metadata_t,
+	key_t,
+	keys_t...>::type;
 
 /**
  * @brief Partial template specialization of the @ref iterator_ class.
  *
  * This class iterates over leaf nodes.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam tree_pointer_t Type of the pointer to the tree iterated on.
  * @tparam container_iterator_t Type of the iterator over the keys of the tree iterated on.
  * @tparam data_t Type of the values to add.
  * @tparam metadata_t Type of the metadata associated to the values.
  */
 template <
+	template <typename> class allocator_t,
 	typename tree_pointer_t,
 	typename container_iterator_t,
 	typename data_t,
 	typename metadata_t>
 class range_iterator_<
+	allocator_t,
 	tree_pointer_t,
 	container_iterator_t,
 	data_t,
@@ -152,9 +181,40 @@ public:
 	/**
 	 * @brief Set the search functions that describe the search criteria.
 	 *
-	 * No functions are needed for a leaf iterator.
+	 * Without functions, every element of the leaf is within the range.
+	 */
+	void set_functions() noexcept
+	{
+		m_func = nullptr;
+		m_batch_func = nullptr;
+	}
+
+	/**
+	 * @brief Set the search function over the elements of the leaf.
+	 *
+	 * The function is either a predicate over a single element
+	 * @code
+	 * bool f(const leaf_element_t& e);
+	 * @endcode
+	 * or a @ref batch_predicate over all the elements of the leaf
+	 * @code
+	 * void f(std::span<const leaf_element_t> e, std::span<std::uint64_t> mask);
+	 * @endcode
+	 * The elements that do not match are skipped while iterating and are
+	 * not counted by @ref count.
 	 */
-	void set_functions() noexcept { }
+	template <typename Callable>
+	void set_functions(Callable&& f)
+	{
+		if constexpr (is_batch_predicate_v<std::remove_cvref_t<Callable>>) {
+			m_func = nullptr;
+			m_batch_func = std::forward<Callable>(f).func;
+		}
+		else {
+			m_func = std::forward<Callable>(f);
+			m_batch_func = nullptr;
+		}
+	}
 
 	/**
 	 * @brief Place the iterator at the beginning of the iteration.
@@ -162,20 +222,16 @@ public:
 	 * was found in this node and down to the leaves of the tree. Returns false
 	 * if no element was found to match the search criteria in this leaf node.
 	 */
-	[[nodiscard]] bool to_begin() noexcept
+	[[nodiscard]] bool to_begin()
 	{
 #if defined DEBUG
 		assert(m_tree != nullptr);
 #endif
 
-		if (m_tree->size() == 0) [[unlikely]] {
-			m_past_begin = true;
-			m_it = m_tree->end();
+		if (not initialize_limits()) [[unlikely]] {
 			return false;
 		}
-
-		m_past_begin = false;
-		m_it = m_tree->begin();
+		m_it = m_begin;
 		return true;
 	}
 	/**
@@ -184,32 +240,30 @@ public:
 	 * was found in this node and down to the leaves of the tree. Returns false
 	 * if no element was found to match the search criteria in this leaf node.
 	 */
-	[[nodiscard]] bool to_end() noexcept
+	[[nodiscard]] bool to_end()
 	{
 #if defined DEBUG
 		assert(m_tree != nullptr);
 #endif
 
-		if (m_tree->size() == 0) [[unlikely]] {
-			m_past_begin = true;
-			m_it = m_tree->end();
+		if (not initialize_limits()) [[unlikely]] {
 			return false;
 		}
-
-		m_past_begin = false;
 		m_it = m_tree->end();
 		--m_it;
+		skip_backward();
 		return true;
 	}
 
 	/// Advance one value in the iteration.
-	void operator++ () noexcept
+	void operator++ ()
 	{
 		if (m_past_begin) [[unlikely]] {
 			m_past_begin = false;
 			return;
 		}
 		++m_it;
+		skip_forward();
 	}
 	/**
 	 * @brief Move back one value in the iteration.
@@ -218,23 +272,53 @@ public:
 	 * @ref begin) a flag (see @ref past_begin) is activated to detect a
 	 * 'past begin' situation.
 	 */
-	void operator-- () noexcept
+	void operator-- ()
 	{
 		if (begin()) [[unlikely]] {
 			m_past_begin = true;
 		}
 		else [[likely]] {
 			--m_it;
+			skip_backward();
 		}
 	}
 
 	/// Count the number of elements that match the search criteria.
-	[[nodiscard]] size_t count() const noexcept
+	[[nodiscard]] size_t count() const
 	{
 #if defined DEBUG
 		assert(m_tree != nullptr);
 #endif
 
+		if (m_batch_func) {
+			// the mask of the iteration is left as it is; small leaves are
+			// evaluated without allocating memory
+			const size_t words = (m_tree->size() + 63) / 64;
+			std::array<std::uint64_t, 4> local;
+			std::vector<std::uint64_t> heap;
+			std::span<std::uint64_t> mask;
+			if (words <= local.size()) {
+				mask = std::span(local).first(words);
+			}
+			else {
+				heap.resize(words);
+				mask = heap;
+			}
+			evaluate_batch(mask);
+
+			size_t c = 0;
+			for (const std::uint64_t w : mask) {
+				c += static_cast<size_t>(std::popcount(w));
+			}
+			return c;
+		}
+		if (m_func) {
+			return static_cast<size_t>(std::count_if(
+				m_tree->begin(),
+				m_tree->end(),
+				[this](const leaf_element_t& e) { return m_func(e); }
+			));
+		}
 		return m_tree->size();
 	}
 
@@ -245,8 +329,7 @@ public:
 	 */
 	[[nodiscard]] bool begin() const noexcept
 	{
-		return m_tree != nullptr and not m_past_begin and
-			   m_it == m_tree->begin();
+		return m_tree != nullptr and not m_past_begin and m_it == m_begin;
 	}
 	/**
 	 * @brief Is the iteration past the beginning?
@@ -271,7 +354,9 @@ public:
 	template <
 		typename _inner_pointer_t = tree_pointer_t,
 		std::enable_if_t<
-			std::is_same_v<pointer_t<data_t, metadata_t>, _inner_pointer_t>,
+			std::is_same_v<
+				pointer_t<allocator_t, data_t, metadata_t>,
+				_inner_pointer_t>,
 			bool> = true>
 	[[nodiscard]] leaf_element_t& operator* () noexcept
 	{
@@ -297,21 +382,95 @@ public:
 private:
 
 	/**
-	 * @brief Initialize the beginning and ending limits of this iterator.
+	 * @brief Initialize the beginning limit of this iterator.
 	 *
-	 * Since this iterator iterates over leaf nodes, there are no limits
-	 * to specify.
+	 * Evaluates the batch function, if any, and finds the first element that
+	 * matches the search criteria.
+	 * @returns False if no element of the leaf matches.
 	 */
-	void initialize_limits_begin() noexcept { }
-	void initialize_limits_end() noexcept { }
+	[[nodiscard]] bool initialize_limits()
+	{
+		m_past_begin = false;
+		m_it = m_tree->begin();
+		if (m_tree->size() > 0) [[likely]] {
+			if (m_batch_func) {
+				m_mask.resize((m_tree->size() + 63) / 64);
+				evaluate_batch(m_mask);
+			}
+			skip_forward();
+		}
+		m_begin = m_it;
+
+		if (m_it == m_tree->end()) [[unlikely]] {
+			m_past_begin = true;
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Evaluates the batch predicate over the elements of @ref m_tree.
+	 * @param mask One bit per element of @ref m_tree.
+	 * @pre There is a batch predicate.
+	 */
+	void evaluate_batch(const std::span<std::uint64_t> mask) const
+	{
+		std::fill(mask.begin(), mask.end(), 0);
+		m_batch_func(
+			std::span<const leaf_element_t>(m_tree->begin(), m_tree->size()),
+			mask
+		);
+	}
+
+	/// Is the element at @ref m_it within the range of the iteration?
+	[[nodiscard]] bool matches() const
+	{
+		if (m_batch_func) {
+			const auto i = static_cast<size_t>(m_it - m_tree->begin());
+			return (m_mask[i / 64] >> (i % 64)) & 1;
+		}
+		return not m_func or m_func(*m_it);
+	}
+
+	/// Moves forward to the first element (at or after @ref m_it) that matches.
+	void skip_forward()
+	{
+		while (m_it != m_tree->end() and not matches()) {
+			++m_it;
+		}
+	}
+
+	/**
+	 * @brief Moves backward to the first element (at or before @ref m_it) that
+	 * matches.
+	 *
+	 * The element at @ref m_begin is known to match.
+	 */
+	void skip_backward()
+	{
+		while (m_it != m_begin and not matches()) {
+			--m_it;
+		}
+	}
 
 private:
 
+	/// Filtering function over single elements.
+	std::function<bool(const leaf_element_t&)> m_func;
+	/// Batch filtering function (see @ref batch_predicate).
+	std::function<
+		void(std::span<const leaf_element_t>, std::span<std::uint64_t>)>
+		m_batch_func;
+	/// Bitmask of the elements within the range (see @ref batch_predicate).
+	std::vector<std::uint64_t> m_mask;
+
 	/// Pointer over the tree iterated on.
 	tree_pointer_t m_tree = nullptr;
 
 	/// Iterator over the child of @ref m_tree currently being iterated.
 	container_iterator_t m_it;
+	/// The first element of @ref m_tree that matches the search criteria.
+	container_iterator_t m_begin;
 
 	/// Has the iterator reached the beginning and tried to move back?
 	bool m_past_begin = false;
@@ -329,6 +488,7 @@ private:
  * @tparam keys_t Type of the remaining keys.
  */
 template <
+	template <typename> class allocator_t,
 	typename tree_pointer_t,
 	typename container_iterator_t,
 	typename data_t,
@@ -336,6 +496,7 @@ template <
 	Comparable key_t,
 	Comparable... keys_t>
 class range_iterator_<
+	allocator_t,
 	tree_pointer_t,
 	container_iterator_t,
 	data_t,
@@ -359,12 +520,40 @@ public:
 	 * @brief Set the search functions that describe the search criteria.
 	 *
 	 * The first function is assigned to this node. The second and the remaining
-	 * functions are assigned to the remaining iterators.
+	 * functions are assigned to the remaining iterators. Every function is
+	 * either a predicate over a single key, a @ref batch_predicate, a
+	 * @ref key_set or a @ref key_intervals.
 	 */
 	template <typename Callable, typename... Callables>
-	void set_functions(Callable&& f, Callables&&...fs) noexcept
+	void set_functions(Callable&& f, Callables&&...fs)
 	{
-		m_func = std::forward<Callable>(f);
+		using callable_t = std::remove_cvref_t<Callable>;
+		if constexpr (is_batch_predicate_v<callable_t>) {
+			m_func = nullptr;
+			m_mask_func = [func = std::forward<Callable>(f).func,
+						   keys = std::vector<key_t>()](
+							  tree_pointer_t t, std::span<std::uint64_t> mask
+						  ) mutable
+			{
+				// the keys are stored next to the subtrees
+				keys.clear();
+				keys.reserve(t->num_keys());
+				for (const auto& [k, _] : *t) {
+					keys.push_back(k);
+				}
+				func(std::span<const key_t>(keys), mask);
+			};
+		}
+		else if constexpr (is_sorted_predicate_v<callable_t>) {
+			m_func = nullptr;
+			m_mask_func = [pred = std::forward<Callable>(f)](
+							  tree_pointer_t t, std::span<std::uint64_t> mask
+						  ) { pred.fill_mask(t->begin(), t->end(), mask); };
+		}
+		else {
+			m_func = std::forward<Callable>(f);
+			m_mask_func = nullptr;
+		}
 		m_subtree_iterator.set_functions(std::forward<Callables>(fs)...);
 	}
 
@@ -374,7 +563,7 @@ public:
 	 * was found in this node and down to the leaves of the tree. Returns false
 	 * if no element was found to match the search criteria in this internal node.
 	 */
-	[[nodiscard]] bool to_begin() noexcept
+	[[nodiscard]] bool to_begin()
 	{
 #if defined DEBUG
 		assert(m_tree != nullptr);
@@ -389,6 +578,7 @@ public:
 			return false;
 		}
 
+		evaluate_batch();
 		return initialize_limits_begin();
 	}
 
@@ -398,7 +588,7 @@ public:
 	 * was found in this node and down to the leaves of the tree. Returns false
 	 * if no element was found to match the search criteria in this internal node.
 	 */
-	[[nodiscard]] bool to_end() noexcept
+	[[nodiscard]] bool to_end()
 	{
 #if defined DEBUG
 		assert(m_tree != nullptr);
@@ -413,11 +603,12 @@ public:
 			return false;
 		}
 
+		evaluate_batch();
 		return initialize_limits_end();
 	}
 
 	/// Advance one step in the iteration.
-	void operator++ () noexcept
+	void operator++ ()
 	{
 		m_past_begin = false;
 		++m_subtree_iterator;
@@ -436,7 +627,7 @@ public:
 	 * @ref begin) a flag (see @ref m_past_begin) is activated to detect a
 	 * 'past begin' situation.
 	 */
-	void operator-- () noexcept
+	void operator-- ()
 	{
 #if defined DEBUG
 		assert(m_tree != nullptr);
@@ -457,7 +648,7 @@ public:
 		if (shallow_end()) {
 			--m_it;
 			--m_it_idx;
-			while (not m_func(m_it->first) and m_it != m_tree->begin()) {
+			while (not matches() and m_it != m_tree->begin()) {
 				--m_it;
 				--m_it_idx;
 			}
@@ -465,7 +656,7 @@ public:
 	}
 
 	/// Count the number of elements that match the search criteria.
-	[[nodiscard]] size_t count() noexcept
+	[[nodiscard]] size_t count()
 	{
 #if defined DEBUG
 		assert(m_tree != nullptr);
@@ -475,15 +666,16 @@ public:
 		m_it_idx = 0;
 		m_begin_idx = 0;
 		m_end_idx = m_tree->num_keys();
+		evaluate_batch();
 
 		size_t c = 0;
 		while (not shallow_end()) {
-			while (not shallow_end() and not m_func(m_it->first)) {
-				++m_it;
-				++m_it_idx;
-			}
+			skip_forward();
 
 			if (not shallow_end()) {
+				detail::prefetch_sibling<true>(
+					m_it, m_tree->begin(), m_tree->end()
+				);
 				m_subtree_iterator.set_pointer(&m_it->second);
 				c += m_subtree_iterator.count();
 				++m_it;
@@ -535,7 +727,7 @@ public:
 		typename _inner_pointer_t = tree_pointer_t,
 		std::enable_if_t<
 			std::is_same_v<
-				pointer_t<data_t, metadata_t, key_t, keys_t...>,
+				pointer_t<allocator_t, data_t, metadata_t, key_t, keys_t...>,
 				_inner_pointer_t>,
 			bool> = true>
 	[[nodiscard]] leaf_element_t& operator* () noexcept
@@ -568,7 +760,7 @@ private:
 	 *
 	 * This routine is optimized for iterations that start at the beginning.
 	 */
-	[[nodiscard]] bool initialize_limits_begin() noexcept
+	[[nodiscard]] bool initialize_limits_begin()
 	{
 #if defined DEBUG
 		assert(m_tree != nullptr);
@@ -626,7 +818,7 @@ private:
 	 *
 	 * This routine is optimized for iterations that start at the end.
 	 */
-	[[nodiscard]] bool initialize_limits_end() noexcept
+	[[nodiscard]] bool initialize_limits_end()
 	{
 #if defined DEBUG
 		assert(m_tree != nullptr);
@@ -729,19 +921,18 @@ private:
 	 * @post If the function returned true, the iterator over the subtree is
 	 * initialized to the beginning of its iteration.
 	 */
-	[[nodiscard]] bool next() noexcept
+	[[nodiscard]] bool next()
 	{
 		bool stop = false;
 		while (not stop) {
-			bool s_end;
-			while (not(s_end = shallow_end()) and not m_func(m_it->first)) {
-				++m_it;
-				++m_it_idx;
-			}
-			if (s_end) {
+			skip_forward();
+			if (shallow_end()) {
 				return false;
 			}
 
+			detail::prefetch_sibling<true>(
+				m_it, m_tree->begin(), m_tree->end()
+			);
 			m_subtree_iterator.set_pointer(&m_it->second);
 			stop = m_subtree_iterator.to_begin();
 
@@ -771,19 +962,18 @@ private:
 	 * @post If the function returned true, the iterator over the subtree is
 	 * initialized to the end of its iteration.
 	 */
-	[[nodiscard]] bool previous() noexcept
+	[[nodiscard]] bool previous()
 	{
 		bool stop = false;
 		while (not stop) {
-			bool s_begin;
-			while (not(s_begin = shallow_past_begin()) and
-				   not m_func(m_it->first)) {
-				simple_move_back();
-			}
-			if (s_begin) {
+			skip_backward();
+			if (shallow_past_begin()) {
 				return false;
 			}
 
+			detail::prefetch_sibling<false>(
+				m_it, m_tree->begin(), m_tree->end()
+			);
 			m_subtree_iterator.set_pointer(&m_it->second);
 			stop = m_subtree_iterator.to_end();
 
@@ -794,10 +984,125 @@ private:
 		return true;
 	}
 
+	/**
+	 * @brief Evaluates the mask function over the keys of @ref m_tree.
+	 *
+	 * Does nothing if the predicate of this level is evaluated key by key.
+	 */
+	void evaluate_batch()
+	{
+		if (not m_mask_func) {
+			return;
+		}
+
+		const size_t n = m_tree->num_keys();
+		m_mask.assign((n + 63) / 64, 0);
+		m_mask_func(m_tree, std::span(m_mask));
+	}
+
+	/// Is the key at @ref m_it within the range of the iteration?
+	[[nodiscard]] bool matches() const
+	{
+		if (m_mask_func) {
+			return (m_mask[m_it_idx / 64] >> (m_it_idx % 64)) & 1;
+		}
+		return m_func(m_it->first);
+	}
+
+	/**
+	 * @brief Moves forward to the first key that is within the range.
+	 *
+	 * The key at the current position is considered. Stops at the end if no
+	 * such key exists.
+	 */
+	void skip_forward()
+	{
+		if (not m_mask_func) {
+			while (not shallow_end() and not m_func(m_it->first)) {
+				++m_it;
+				++m_it_idx;
+			}
+			return;
+		}
+
+		if (shallow_end()) {
+			return;
+		}
+
+		// walk the set bits of the mask
+		size_t i = m_it_idx;
+		while (i < m_end_idx) {
+			const size_t w = i / 64;
+			const std::uint64_t bits = m_mask[w] >> (i % 64);
+			if (bits != 0) {
+				i += static_cast<size_t>(std::countr_zero(bits));
+				break;
+			}
+			i = 64 * (w + 1);
+		}
+		i = std::min(i, m_end_idx);
+		m_it += static_cast<std::ptrdiff_t>(i - m_it_idx);
+		m_it_idx = i;
+	}
+
+	/**
+	 * @brief Moves backward to the first key that is within the range.
+	 *
+	 * The key at the current position is considered. If no such key exists,
+	 * the iterator is placed at the beginning and @ref m_past_begin is set.
+	 */
+	void skip_backward()
+	{
+		if (not m_mask_func) {
+			while (not shallow_past_begin() and not m_func(m_it->first)) {
+				simple_move_back();
+			}
+			return;
+		}
+
+		if (shallow_past_begin()) {
+			return;
+		}
+
+		// walk the set bits of the mask
+		size_t i = m_it_idx;
+		bool found = false;
+		while (true) {
+			const size_t w = i / 64;
+			const std::uint64_t bits = m_mask[w] << (63 - i % 64);
+			if (bits != 0) {
+				const size_t j =
+					i - static_cast<size_t>(std::countl_zero(bits));
+				found = j >= m_begin_idx;
+				i = found ? j : m_begin_idx;
+				break;
+			}
+			if (64 * w <= m_begin_idx) {
+				i = m_begin_idx;
+				break;
+			}
+			i = 64 * w - 1;
+		}
+
+		m_it -= static_cast<std::ptrdiff_t>(m_it_idx - i);
+		m_it_idx = i;
+		if (not found) {
+			m_past_begin = true;
+		}
+	}
+
 private:
 
 	/// Filtering function to determine the range of iteration over the current tree.
 	std::function<bool(const key_t&)> m_func;
+	/**
+	 * @brief Filtering function over all the keys of a node.
+	 *
+	 * Used for @ref batch_predicate, @ref key_set and @ref key_intervals.
+	 */
+	std::function<void(tree_pointer_t, std::span<std::uint64_t>)> m_mask_func;
+	/// Bitmask of the keys within the range (see @ref batch_predicate).
+	std::vector<std::uint64_t> m_mask;
 
 	/// Pointer to the tree iterated on.
 	tree_pointer_t m_tree = nullptr;
@@ -816,44 +1121,63 @@ private:
 	bool m_past_begin = false;
 
 	/// Iterator over the children of @ref m_tree.
-	sub_range_iterator_t<tree_pointer_t, data_t, metadata_t, key_t, keys_t...>
+	sub_range_iterator_t<
+		allocator_t,
+		tree_pointer_t,
+		data_t,
+		metadata_t,
+		key_t,
+		keys_t...>
 		m_subtree_iterator;
 };
 
 } // namespace detail
 
 /**
- * @brief Partial template specialization of the @ref range_iterator class.
+ * @brief Partial template specialization of the @ref basic_range_iterator class.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam data_t Type of the values to add.
  * @tparam metadata_t Type of the metadata associated to the values.
  */
-template <typename data_t, typename metadata_t>
-class range_iterator<data_t, metadata_t>
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t>
+class basic_range_iterator<allocator_t, data_t, metadata_t>
 	: public detail::range_iterator_<
-		  detail::pointer_t<data_t, metadata_t>,
-		  typename ctree<data_t, metadata_t>::container_t::iterator,
+		  allocator_t,
+		  detail::pointer_t<allocator_t, data_t, metadata_t>,
+		  typename basic_ctree<allocator_t, data_t, metadata_t>::container_t::
+			  iterator,
 		  data_t,
 		  metadata_t> {
 public:
 };
 
 /**
- * @brief Partial template specialization of the @ref range_iterator class.
+ * @brief Partial template specialization of the @ref basic_range_iterator class.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam data_t Type of the values to add.
  * @tparam metadata_t Type of the metadata associated to the values.
  * @tparam key_t Type of the first key.
  * @tparam keys_t Type of the remaining keys.
  */
 template <
+	template <typename> class allocator_t,
 	typename data_t,
 	typename metadata_t,
 	Comparable key_t,
 	Comparable... keys_t>
-class range_iterator<data_t, metadata_t, key_t, keys_t...>
+class basic_range_iterator<allocator_t, data_t, metadata_t, key_t, keys_t...>
 	: public detail::range_iterator_<
-		  detail::pointer_t<data_t, metadata_t, key_t, keys_t...>,
-		  typename ctree<data_t, metadata_t, key_t, keys_t...>::container_t::
-			  iterator,
+		  allocator_t,
+		  detail::pointer_t<allocator_t, data_t, metadata_t, key_t, keys_t...>,
+		  typename basic_ctree<
+			  allocator_t,
+			  data_t,
+			  metadata_t,
+			  key_t,
+			  keys_t...>::container_t::iterator,
 		  data_t,
 		  metadata_t,
 		  key_t,
@@ -862,37 +1186,60 @@ public:
 };
 
 /**
- * @brief Partial template specialization of the @ref const_range_iterator class.
+ * @brief Partial template specialization of the @ref basic_const_range_iterator class.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam data_t Type of the values to add.
  * @tparam metadata_t Type of the metadata associated to the values.
  */
-template <typename data_t, typename metadata_t>
-class const_range_iterator<data_t, metadata_t>
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t>
+class basic_const_range_iterator<allocator_t, data_t, metadata_t>
 	: public detail::range_iterator_<
-		  detail::const_pointer_t<data_t, metadata_t>,
-		  typename ctree<data_t, metadata_t>::container_t::const_iterator,
+		  allocator_t,
+		  detail::const_pointer_t<allocator_t, data_t, metadata_t>,
+		  typename basic_ctree<allocator_t, data_t, metadata_t>::container_t::
+			  const_iterator,
 		  data_t,
 		  metadata_t> {
 public:
 };
 
 /**
- * @brief Partial template specialization of the @ref const_range_iterator class.
+ * @brief Partial template specialization of the @ref basic_const_range_iterator class.
+ * @tparam allocator_t Allocator template used in every node of the tree.
  * @tparam data_t Type of the values to add.
  * @tparam metadata_t Type of the metadata associated to the values.
  * @tparam key_t Type of the first key.
  * @tparam keys_t Type of the remaining keys.
  */
 template <
+	template <typename> class allocator_t,
 	typename data_t,
 	typename metadata_t,
 	Comparable key_t,
 	Comparable... keys_t>
-class const_range_iterator<data_t, metadata_t, key_t, keys_t...>
+class basic_const_range_iterator<
+	allocator_t,
+	data_t,
+	metadata_t,
+	key_t,
+	keys_t...>
 	: public detail::range_iterator_<
-		  detail::const_pointer_t<data_t, metadata_t, key_t, keys_t...>,
-		  typename ctree<data_t, metadata_t, key_t, keys_t...>::container_t::
-			  const_iterator,
+		  allocator_t,
+		  detail::const_pointer_t<
+			  allocator_t,
+			  data_t,
+			  metadata_t,
+			  key_t,
+			  keys_t...>,
+		  typename basic_ctree<
+			  allocator_t,
+			  data_t,
+			  metadata_t,
+			  key_t,
+			  keys_t...>::container_t::const_iterator,
 		  data_t,
 		  metadata_t,
 		  key_t,
@@ -24,6 +24,7 @@
 #pragma once
 
 // C++ includes
+#include <algorithm>
 #include <vector>
 
 // ctree includes
@@ -45,10 +46,14 @@ template <LessthanComparable data_t, typename metadata_t>
 	}
 }
 
-template <LessthanComparable data_t, typename metadata_t>
+template <
+	LessthanComparable data_t,
+	typename metadata_t,
+	template <typename, typename> class container_t,
+	typename allocator_t>
 [[nodiscard]] static constexpr inline std::pair<size_t, bool>
 element_search_linear(
-	const std::pmr::vector<element_t<data_t, metadata_t>>& v,
+	const container_t<element_t<data_t, metadata_t>, allocator_t>& v,
 	const data_t& value
 ) noexcept
 {
@@ -71,10 +76,14 @@ element_search_linear(
 	return {v.size() - 1, true};
 }
 
-template <LessthanComparable data_t, typename metadata_t>
+template <
+	LessthanComparable data_t,
+	typename metadata_t,
+	template <typename, typename> class container_t,
+	typename allocator_t>
 [[nodiscard]] static constexpr inline std::pair<size_t, bool>
 small_element_search_linear(
-	const std::pmr::vector<element_t<data_t, metadata_t>>& v,
+	const container_t<element_t<data_t, metadata_t>, allocator_t>& v,
 	const data_t& value
 ) noexcept
 {
@@ -93,10 +102,14 @@ small_element_search_linear(
 	return element_search_linear<data_t, metadata_t>(v, value);
 }
 
-template <LessthanComparable data_t, typename metadata_t>
+template <
+	LessthanComparable data_t,
+	typename metadata_t,
+	template <typename, typename> class container_t,
+	typename allocator_t>
 [[nodiscard]] static constexpr inline std::pair<size_t, bool>
 element_search_binary(
-	const std::pmr::vector<element_t<data_t, metadata_t>>& v,
+	const container_t<element_t<data_t, metadata_t>, allocator_t>& v,
 	const data_t& value
 ) noexcept
 {
@@ -131,10 +144,14 @@ element_search_binary(
 	return {i, true};
 }
 
-template <LessthanComparable data_t, typename metadata_t>
+template <
+	LessthanComparable data_t,
+	typename metadata_t,
+	template <typename, typename> class container_t,
+	typename allocator_t>
 [[nodiscard]] static constexpr inline std::pair<size_t, bool>
 small_element_search_binary(
-	const std::pmr::vector<element_t<data_t, metadata_t>>& v,
+	const container_t<element_t<data_t, metadata_t>, allocator_t>& v,
 	const data_t& value
 ) noexcept
 {
@@ -153,10 +170,15 @@ small_element_search_binary(
 	return element_search_binary<data_t, metadata_t>(v, value);
 }
 
-template <LessthanComparable T, typename U>
+template <
+	LessthanComparable T,
+	typename U,
+	template <typename, typename> class container_t,
+	typename allocator_t>
 [[nodiscard]] static constexpr inline std::pair<size_t, bool>
-pair_search_linear(const std::pmr::vector<std::pair<T, U>>& v, const T& value)
-	noexcept
+pair_search_linear(
+	const container_t<std::pair<T, U>, allocator_t>& v, const T& value
+) noexcept
 {
 	for (size_t i = 0; i < v.size() - 1; ++i) {
 		if (value < v[i].first) {
@@ -177,10 +199,14 @@ pair_search_linear(const std::pmr::vector<std::pair<T, U>>& v, const T& value)
 	return {v.size() - 1, true};
 }
 
-template <LessthanComparable T, typename U>
+template <
+	LessthanComparable T,
+	typename U,
+	template <typename, typename> class container_t,
+	typename allocator_t>
 [[nodiscard]] static constexpr inline std::pair<size_t, bool>
 small_pair_search_linear(
-	const std::pmr::vector<std::pair<T, U>>& v, const T& value
+	const container_t<std::pair<T, U>, allocator_t>& v, const T& value
 ) noexcept
 {
 	if (v.size() == 0) [[unlikely]] {
@@ -198,10 +224,15 @@ small_pair_search_linear(
 	return pair_search_linear<T, U>(v, value);
 }
 
-template <LessthanComparable T, typename U>
+template <
+	LessthanComparable T,
+	typename U,
+	template <typename, typename> class container_t,
+	typename allocator_t>
 [[nodiscard]] static constexpr inline std::pair<size_t, bool>
-pair_search_binary(const std::pmr::vector<std::pair<T, U>>& v, const T& value)
-	noexcept
+pair_search_binary(
+	const container_t<std::pair<T, U>, allocator_t>& v, const T& value
+) noexcept
 {
 	size_t i = 0;
 	size_t j = v.size() - 1;
@@ -234,10 +265,14 @@ pair_search_binary(const std::pmr::vector<std::pair<T, U>>& v, const T& value)
 	return {i, true};
 }
 
-template <LessthanComparable T, typename U>
+template <
+	LessthanComparable T,
+	typename U,
+	template <typename, typename> class container_t,
+	typename allocator_t>
 [[nodiscard]] static constexpr inline std::pair<size_t, bool>
 small_pair_search_binary(
-	const std::pmr::vector<std::pair<T, U>>& v, const T& value
+	const container_t<std::pair<T, U>, allocator_t>& v, const T& value
 ) noexcept
 {
 	if (v.size() == 0) [[unlikely]] {
@@ -255,11 +290,69 @@ small_pair_search_binary(
 	return pair_search_binary<T, U>(v, value);
 }
 
+/**
+ * @brief Finds the element with some data in a leaf sorted by data.
+ * @param leaf The leaf.
+ * @param data Data of the element.
+ * @returns A pointer to the element, or null if there is none.
+ */
+template <LessthanComparable data_t, typename metadata_t, typename leaf_t>
+[[nodiscard]] const element_t<data_t, metadata_t> *
+find_in(const leaf_t& leaf, const data_t& data) noexcept
+{
+	const auto it = std::partition_point(
+		leaf.begin(),
+		leaf.end(),
+		[&](const element_t<data_t, metadata_t>& e)
+		{ return value_elem<data_t, metadata_t>(e) < data; }
+	);
+	return it != leaf.end() and value_elem<data_t, metadata_t>(*it) == data
+			   ? &*it
+			   : nullptr;
+}
+
+/**
+ * @brief Finds the element with some data under some keys in the subtree
+ * of a node.
+ *
+ * The key values of every node are searched with a binary search, and the
+ * leaf must be sorted by data.
+ * @param node The node.
+ * @param data Data of the element.
+ * @param k The key value of the child of @e node.
+ * @param ks The key values of the rest of the path.
+ * @returns A pointer to the element, or null if there is none.
+ */
+template <
+	LessthanComparable data_t,
+	typename metadata_t,
+	typename node_t,
+	typename key_t,
+	typename... rest_t>
+[[nodiscard]] const element_t<data_t, metadata_t> *find_in(
+	const node_t& node, const data_t& data, const key_t& k, const rest_t&...ks
+) noexcept
+{
+	const auto it = std::partition_point(
+		node.begin(),
+		node.end(),
+		[&](const auto& p) { return p.first < k; }
+	);
+	if (it == node.end() or not(it->first == k)) {
+		return nullptr;
+	}
+	return find_in<data_t, metadata_t>(it->second, data, ks...);
+}
+
 } // namespace detail
 
-template <LessthanComparable data_t, typename metadata_t>
+template <
+	LessthanComparable data_t,
+	typename metadata_t,
+	template <typename, typename> class container_t,
+	typename allocator_t>
 [[nodiscard]] static constexpr inline std::pair<size_t, bool> search(
-	const std::pmr::vector<element_t<data_t, metadata_t>>& v,
+	const container_t<element_t<data_t, metadata_t>, allocator_t>& v,
 	const data_t& value
 ) noexcept
 {
@@ -271,9 +364,15 @@ template <LessthanComparable data_t, typename metadata_t>
 	return detail::element_search_binary<data_t, metadata_t>(v, value);
 }
 
-template <LessthanComparable T, typename U>
+template <
+	LessthanComparable T,
+	typename U,
+	template <typename, typename> class container_t,
+	typename allocator_t>
 [[nodiscard]] static constexpr inline std::pair<size_t, bool>
-search(const std::pmr::vector<std::pair<T, U>>& v, const T& value) noexcept
+search(
+	const container_t<std::pair<T, U>, allocator_t>& v, const T& value
+) noexcept
 {
 	if (v.size() <= 6) {
 		return detail::small_pair_search_linear<T, U>(v, value);
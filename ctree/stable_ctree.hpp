@@ -0,0 +1,273 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#if defined DEBUG
+#include <cassert>
+#endif
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <stdexcept>
+#include <limits>
+#include <deque>
+
+// ctree includes
+#include <ctree/concepts.hpp>
+#include <ctree/ctree.hpp>
+#include <ctree/search.hpp>
+
+namespace classtree {
+
+/**
+ * @brief A handle to an element of a @ref stable_ctree.
+ *
+ * A handle is the index of the element in the slab of elements of the tree,
+ * and the generation of the tree in which it was created.
+ */
+struct element_handle {
+	/// Index of the element in the slab.
+	std::uint32_t index = std::numeric_limits<std::uint32_t>::max();
+	/// Generation of the tree.
+	std::uint32_t generation = 0;
+
+	[[nodiscard]] bool
+	operator== (const element_handle&) const noexcept = default;
+};
+
+/**
+ * @brief A tree whose elements are reached through stable handles.
+ * @tparam tree_t Type of the tree.
+ */
+template <typename tree_t>
+class stable_ctree;
+
+/**
+ * @brief A tree whose elements are reached through stable handles.
+ *
+ * The elements of the leaves of a @ref basic_ctree move when other elements
+ * are added, so pointers to them are invalidated. In this tree, the elements
+ * live in a slab whose entries never move, and the leaves of the tree store
+ * the data of the elements (which determines their order) and a handle to
+ * their entry in the slab. Adding an element returns its handle, which is
+ * dereferenced in constant time, without descending the tree.
+ *
+ * Elements are never removed individually, so handles stay valid until the
+ * tree is cleared. Clearing the tree starts a new generation, and handles
+ * of previous generations are no longer valid (see @ref get).
+ * @tparam allocator_t Allocator template used in every node of the tree.
+ * @tparam data_t Type of the data stored in the leaves of the tree.
+ * @tparam metadata_t Type of the metadata stored in the leaves of the tree.
+ * @tparam keys_t Types of the keys of the tree.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t>
+	requires(LessthanComparable<data_t>)
+class stable_ctree<basic_ctree<allocator_t, data_t, metadata_t, keys_t...>> {
+public:
+
+	/// Type of the elements.
+	using leaf_element_t = element_t<data_t, metadata_t>;
+	/// Type of the tree of handles.
+	using index_tree_t =
+		basic_ctree<allocator_t, data_t, element_handle, keys_t...>;
+	/// Type of the elements of the tree of handles.
+	using index_element_t = element_t<data_t, element_handle>;
+	/// Type of the slab of elements.
+	using slab_t = std::deque<leaf_element_t, allocator_t<leaf_element_t>>;
+
+	/// Is the metadata non-void?
+	static constexpr bool is_compound = Compound<data_t, metadata_t>;
+
+public:
+
+	/**
+	 * @brief Adds an element to the tree.
+	 *
+	 * Same as @ref basic_ctree::add.
+	 * @tparam unique Store the element when there are no repeats.
+	 * @param value Element to add.
+	 * @param ks Keys of the element.
+	 * @returns The handle of the element and whether it was added. If the
+	 * element was a repeat, its metadata is merged into that of the element
+	 * of the tree, whose handle is returned.
+	 */
+	template <bool unique = true>
+	std::pair<element_handle, bool> add(leaf_element_t&& value, keys_t... ks)
+	{
+		if constexpr (unique) {
+			const index_element_t *const old =
+				detail::find_in<data_t, element_handle>(
+					m_tree, data_of(value), ks...
+				);
+			if (old != nullptr) {
+				if constexpr (is_compound) {
+					m_slab[old->metadata.index].metadata +=
+						std::move(value.metadata);
+				}
+				return {old->metadata, false};
+			}
+		}
+
+		using index_t = decltype(element_handle::index);
+		if (m_slab.size() >= std::numeric_limits<index_t>::max()) [[unlikely]] {
+			throw std::length_error("stable_ctree: too many elements");
+		}
+
+		const element_handle h{
+			static_cast<std::uint32_t>(m_slab.size()), m_generation
+		};
+		m_slab.push_back(std::move(value));
+		try {
+			m_tree.template add<false>(
+				index_element_t{data_of(m_slab.back()), h}, std::move(ks)...
+			);
+		}
+		catch (...) {
+			m_slab.pop_back();
+			throw;
+		}
+		return {h, true};
+	}
+
+	/**
+	 * @brief The handle of the element with some data under some keys.
+	 * @param data Data of the element.
+	 * @param ks Keys of the element.
+	 * @returns The handle of the element, or an invalid handle if there is
+	 * none (see @ref valid).
+	 */
+	[[nodiscard]] element_handle
+	find(const data_t& data, const keys_t&...ks) const noexcept
+	{
+		const index_element_t *const x =
+			detail::find_in<data_t, element_handle>(m_tree, data, ks...);
+		return x == nullptr ? element_handle{} : x->metadata;
+	}
+
+	/// Is @e h the handle of an element of this tree?
+	[[nodiscard]] bool valid(const element_handle h) const noexcept
+	{
+		return h.generation == m_generation and h.index < m_slab.size();
+	}
+
+	/**
+	 * @brief The element of a handle.
+	 * @param h A handle.
+	 * @returns A pointer to the element, or null if the handle is not valid.
+	 * The pointer is not invalidated when elements are added.
+	 */
+	[[nodiscard]] leaf_element_t *get(const element_handle h) noexcept
+	{
+		return valid(h) ? &m_slab[h.index] : nullptr;
+	}
+	/// The element of a handle (see @ref get).
+	[[nodiscard]] const leaf_element_t *
+	get(const element_handle h) const noexcept
+	{
+		return valid(h) ? &m_slab[h.index] : nullptr;
+	}
+
+	/**
+	 * @brief The element of a valid handle.
+	 *
+	 * The data of the element must not be modified.
+	 * @param h A valid handle.
+	 */
+	[[nodiscard]] leaf_element_t& operator[] (const element_handle h) noexcept
+	{
+#if defined DEBUG
+		assert(valid(h));
+#endif
+		return m_slab[h.index];
+	}
+	/// The element of a valid handle.
+	[[nodiscard]] const leaf_element_t&
+	operator[] (const element_handle h) const noexcept
+	{
+#if defined DEBUG
+		assert(valid(h));
+#endif
+		return m_slab[h.index];
+	}
+
+	/// Removes all elements and invalidates all handles.
+	void clear() noexcept
+	{
+		m_tree.clear();
+		m_slab.clear();
+		++m_generation;
+	}
+
+	/**
+	 * @brief The tree of handles.
+	 *
+	 * Its leaves store the data of the elements and their handles, so it
+	 * can be traversed with the usual iterators.
+	 */
+	[[nodiscard]] const index_tree_t& tree() const noexcept
+	{
+		return m_tree;
+	}
+	/// The slab of elements, in order of addition.
+	[[nodiscard]] const slab_t& slab() const noexcept
+	{
+		return m_slab;
+	}
+	/// The number of elements.
+	[[nodiscard]] std::size_t size() const noexcept
+	{
+		return m_slab.size();
+	}
+
+private:
+
+	/// The data of an element.
+	[[nodiscard]] static const data_t& data_of(const leaf_element_t& e
+	) noexcept
+	{
+		if constexpr (is_compound) {
+			return e.data;
+		}
+		else {
+			return e;
+		}
+	}
+
+private:
+
+	/// The tree of handles.
+	index_tree_t m_tree;
+	/// The elements.
+	slab_t m_slab;
+	/// Generation of the handles.
+	std::uint32_t m_generation = 0;
+};
+
+} // namespace classtree
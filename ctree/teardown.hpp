@@ -0,0 +1,177 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <future>
+#include <memory>
+#include <vector>
+
+// ctree includes
+#include <ctree/executor.hpp>
+#include <ctree/ctree.hpp>
+
+namespace classtree {
+
+namespace detail {
+
+/**
+ * @brief Clears the subtrees of a node, splitting the large subtrees into
+ * tasks.
+ * @param n The node.
+ * @param e The executor.
+ * @param total Size of the whole tree.
+ */
+template <typename node_t, Executor executor_t>
+void clear_split(node_t& n, executor_t& e, const std::size_t total)
+{
+	using child_t = typename node_t::child_t;
+
+	std::vector<std::size_t> order(n.num_keys());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(
+		order.begin(),
+		order.end(),
+		[&](const std::size_t i, const std::size_t j)
+		{ return n.get_child(i).size() > n.get_child(j).size(); }
+	);
+
+	e.bulk(
+		order.size(),
+		[&](const std::size_t, const std::size_t j)
+		{
+			child_t& c = n.get_child(order[j]);
+			if constexpr (requires { typename child_t::child_t; }) {
+				if (is_large_task(c.size(), total, e.num_workers())) {
+					clear_split(c, e, total);
+				}
+			}
+			c.clear();
+		}
+	);
+}
+
+} // namespace detail
+
+/**
+ * @brief Clears a tree using an executor.
+ *
+ * The subtrees of the root are cleared in parallel, the largest first. A
+ * subtree that holds a large part of the elements of the tree is split into
+ * one task per child. The allocators of the tree must be thread-safe (the
+ * default memory resource is).
+ * @tparam allocator_t Allocator template used in every node of the tree.
+ * @tparam data_t Type of the data stored in the leaves of the tree.
+ * @tparam metadata_t Type of the metadata stored in the leaves of the tree.
+ * @tparam keys_t Types of the keys of the tree.
+ * @param t The tree to clear.
+ * @param e The executor.
+ */
+template <
+	Executor executor_t,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t>
+void clear_parallel(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t, executor_t& e
+)
+{
+	if constexpr (sizeof...(keys_t) > 0) {
+		detail::clear_split(t, e, t.size());
+	}
+	t.clear();
+}
+
+/**
+ * @brief Clears a tree using several threads.
+ *
+ * Same as @ref clear_parallel with a @ref thread_executor.
+ * @tparam allocator_t Allocator template used in every node of the tree.
+ * @tparam data_t Type of the data stored in the leaves of the tree.
+ * @tparam metadata_t Type of the metadata stored in the leaves of the tree.
+ * @tparam keys_t Types of the keys of the tree.
+ * @param t The tree to clear.
+ * @param num_threads Number of threads. Must be at least 1.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t>
+void clear_parallel(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	const std::size_t num_threads
+)
+{
+	thread_executor e(num_threads);
+	clear_parallel(t, e);
+}
+
+/**
+ * @brief Clears a tree in the background.
+ *
+ * The nodes of the tree are detached from @e t, which is empty when this
+ * function returns, and freed on a separate thread with
+ * @ref clear_parallel. The memory resources of the tree must outlive the
+ * returned future. Note that the destructor of the future waits for the
+ * tree to be freed.
+ * @tparam allocator_t Allocator template used in every node of the tree.
+ * @tparam data_t Type of the data stored in the leaves of the tree.
+ * @tparam metadata_t Type of the metadata stored in the leaves of the tree.
+ * @tparam keys_t Types of the keys of the tree.
+ * @param t The tree to clear.
+ * @param num_threads Number of threads used to free the tree. Must be at
+ * least 1.
+ * @returns A future that becomes ready when the tree has been freed.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t>
+[[nodiscard]] std::future<void> clear_async(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	const std::size_t num_threads = 1
+)
+{
+	using tree_t = basic_ctree<allocator_t, data_t, metadata_t, keys_t...>;
+
+	auto detached = std::make_unique<tree_t>(std::move(t));
+	t.clear();
+
+	return std::async(
+		std::launch::async,
+		[num_threads, detached = std::move(detached)]() mutable
+		{
+			clear_parallel(*detached, num_threads);
+			detached.reset();
+		}
+	);
+}
+
+} // namespace classtree
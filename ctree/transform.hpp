@@ -0,0 +1,524 @@
+/**
+ * Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <tuple>
+#include <span>
+#include <bit>
+
+// ctree includes
+#include <ctree/batch_predicate.hpp>
+#include <ctree/executor.hpp>
+#include <ctree/key_set.hpp>
+#include <ctree/ctree.hpp>
+
+namespace classtree {
+
+/// Statistics of a transformation (see @ref transform_metadata).
+struct transform_stats {
+	/// Number of leaves within the range of keys.
+	std::size_t num_leaves = 0;
+	/// Number of elements transformed.
+	std::size_t num_elements = 0;
+	/// Number of leaves whose elements had to be sorted again.
+	std::size_t num_sorted_leaves = 0;
+	/// Number of elements removed because their data became equal to that
+	/// of another element of the same leaf.
+	std::size_t num_merged_elements = 0;
+
+	/// Adds the statistics of a part of the transformation.
+	transform_stats& operator+= (const transform_stats& s) noexcept
+	{
+		num_leaves += s.num_leaves;
+		num_elements += s.num_elements;
+		num_sorted_leaves += s.num_sorted_leaves;
+		num_merged_elements += s.num_merged_elements;
+		return *this;
+	}
+};
+
+namespace detail {
+
+/**
+ * @brief Collects the leaves below a node whose keys match the functions.
+ *
+ * Levels without a function match every key.
+ * @param n A node at depth @e d.
+ * @param fs The functions of the levels.
+ * @param leaves The leaves, in order of keys.
+ */
+template <std::size_t d, typename node_t, typename funcs_t, typename leaf_t>
+void collect_leaves(node_t& n, funcs_t& fs, std::vector<leaf_t *>& leaves)
+{
+	if constexpr (std::is_same_v<node_t, leaf_t>) {
+		if (n.size() > 0) {
+			leaves.push_back(&n);
+		}
+	}
+	else if constexpr (d < std::tuple_size_v<funcs_t>) {
+		std::vector<std::uint64_t> mask;
+		fill_key_mask(n, std::get<d>(fs), mask);
+		for (std::size_t w = 0; w < mask.size(); ++w) {
+			for (std::uint64_t bits = mask[w]; bits != 0; bits &= bits - 1) {
+				const auto b = static_cast<std::size_t>(std::countr_zero(bits));
+				collect_leaves<d + 1>(n.get_child(64 * w + b), fs, leaves);
+			}
+		}
+	}
+	else {
+		for (std::size_t i = 0; i < n.num_keys(); ++i) {
+			collect_leaves<d + 1>(n.get_child(i), fs, leaves);
+		}
+	}
+}
+
+/**
+ * @brief Applies a function to the elements of a leaf that match a
+ * predicate.
+ * @param elems The elements of the leaf.
+ * @param apply The function.
+ * @param pred The predicate over the elements: a function or a
+ * @ref batch_predicate.
+ * @param mask Memory for the bitmask of a batch predicate.
+ * @returns The number of elements transformed.
+ */
+template <typename element_t, typename apply_t, typename pred_t>
+std::size_t apply_matching(
+	const std::span<element_t> elems,
+	const apply_t& apply,
+	const pred_t& pred,
+	std::vector<std::uint64_t>& mask
+)
+{
+	std::size_t count = 0;
+	if constexpr (is_batch_predicate_v<pred_t>) {
+		mask.assign((elems.size() + 63) / 64, 0);
+		pred.func(std::span<const element_t>(elems), std::span(mask));
+		for (std::size_t w = 0; w < mask.size(); ++w) {
+			for (std::uint64_t bits = mask[w]; bits != 0; bits &= bits - 1) {
+				const auto b = static_cast<std::size_t>(std::countr_zero(bits));
+				apply(elems[64 * w + b]);
+				++count;
+			}
+		}
+	}
+	else {
+		for (element_t& e : elems) {
+			if (pred(std::as_const(e))) {
+				apply(e);
+				++count;
+			}
+		}
+	}
+	return count;
+}
+
+/**
+ * @brief Applies a function to the elements within a range in parallel.
+ *
+ * The leaves within the range of keys are collected first, and then split
+ * into groups with a similar number of elements that are transformed in
+ * parallel, one leaf after the other.
+ * @tparam num_keys Number of keys of the tree.
+ * @tparam restore_order Sort again the leaves whose data is no longer
+ * sorted.
+ * @tparam unique Merge the elements of a leaf whose data became equal.
+ * @param t The tree.
+ * @param e The executor.
+ * @param apply The function applied to every element, or to the span of
+ * elements of every leaf.
+ * @param fs The functions of every level.
+ * @returns The statistics of the transformation.
+ */
+template <
+	std::size_t num_keys,
+	bool restore_order,
+	bool unique,
+	typename tree_t,
+	Executor executor_t,
+	typename apply_t,
+	typename... Callables>
+transform_stats transform_range(
+	tree_t& t, executor_t& e, const apply_t& apply, Callables&&...fs
+)
+{
+	using leaf_t = typename node_at<tree_t, num_keys>::type;
+	using leaf_element_t = typename leaf_t::leaf_element_t;
+	constexpr bool has_predicate = sizeof...(Callables) == num_keys + 1;
+
+	auto funcs = std::forward_as_tuple(fs...);
+	std::vector<leaf_t *> leaves;
+	collect_leaves<0>(t, funcs, leaves);
+
+	// groups of leaves with a similar number of elements
+	std::size_t total = 0;
+	for (const leaf_t *l : leaves) {
+		total += l->size();
+	}
+	const std::size_t num_groups =
+		std::max<std::size_t>(1, std::min(leaves.size(), 4 * e.num_workers()));
+	std::vector<std::size_t> bounds;
+	bounds.reserve(num_groups + 1);
+	bounds.push_back(0);
+	std::size_t sum = 0;
+	for (std::size_t i = 0; i < leaves.size(); ++i) {
+		sum += leaves[i]->size();
+		if (bounds.size() < num_groups and
+			sum >= total * bounds.size() / num_groups) {
+			bounds.push_back(i + 1);
+		}
+	}
+	bounds.resize(num_groups + 1, leaves.size());
+
+	std::vector<transform_stats> stats(num_groups);
+	e.bulk(
+		num_groups,
+		[&](const std::size_t, const std::size_t g)
+		{
+			std::vector<std::uint64_t> mask;
+			transform_stats& s = stats[g];
+			for (std::size_t i = bounds[g]; i < bounds[g + 1]; ++i) {
+				leaf_t& l = *leaves[i];
+				const std::span<leaf_element_t> elems(l.begin(), l.size());
+				++s.num_leaves;
+
+				std::size_t n = elems.size();
+				if constexpr (has_predicate) {
+					n = apply_matching(
+						elems, apply, std::get<num_keys>(funcs), mask
+					);
+				}
+				else if constexpr (std::is_invocable_v<
+									   const apply_t&,
+									   std::span<leaf_element_t>>) {
+					apply(elems);
+				}
+				else {
+					for (leaf_element_t& x : elems) {
+						apply(x);
+					}
+				}
+				s.num_elements += n;
+
+				if constexpr (restore_order) {
+					const auto less = [](const leaf_element_t& a,
+										 const leaf_element_t& b)
+					{
+						if constexpr (leaf_t::is_compound) {
+							return a.data < b.data;
+						}
+						else {
+							return a < b;
+						}
+					};
+					if (not std::is_sorted(elems.begin(), elems.end(), less)) {
+						std::stable_sort(elems.begin(), elems.end(), less);
+						++s.num_sorted_leaves;
+					}
+				}
+				if constexpr (unique) {
+					if (n > 0) {
+						s.num_merged_elements += l.merge_equal();
+					}
+				}
+			}
+		}
+	);
+
+	transform_stats result;
+	for (const transform_stats& s : stats) {
+		result += s;
+	}
+	if (result.num_merged_elements > 0) {
+		t.update_size();
+	}
+	return result;
+}
+
+} // namespace detail
+
+/**
+ * @brief Applies a function to the metadata of the elements within a range.
+ *
+ * The range is given as in @ref basic_ctree::get_range_iterator: one
+ * function per key, and optionally one over the elements of the leaves.
+ * When no functions are given, the whole tree is transformed. The leaves
+ * within the range are transformed in parallel, and the elements of every
+ * leaf are visited in a tight loop over the contiguous array of elements.
+ *
+ * The functions over the keys are called on the calling thread; the
+ * function over the elements and @e fn are called concurrently.
+ * @param t The tree.
+ * @param e The executor.
+ * @param fn Function that modifies the metadata: @e fn(metadata_t&).
+ * @param fs The functions of every level.
+ * @returns The statistics of the transformation.
+ */
+template <
+	Executor executor_t,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t,
+	typename fn_t,
+	typename... Callables>
+	requires(
+		Compound<data_t, metadata_t> and
+		(sizeof...(Callables) == 0 or
+		 sizeof...(Callables) == sizeof...(keys_t) or
+		 sizeof...(Callables) == sizeof...(keys_t) + 1)
+	)
+transform_stats transform_metadata(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	executor_t& e,
+	const fn_t& fn,
+	Callables&&...fs
+)
+{
+	return detail::transform_range<sizeof...(keys_t), false, false>(
+		t,
+		e,
+		[&fn](element_t<data_t, metadata_t>& x) { fn(x.metadata); },
+		std::forward<Callables>(fs)...
+	);
+}
+
+/**
+ * @brief Applies a function to the metadata of the elements within a range.
+ *
+ * Same as @ref transform_metadata with a @ref thread_executor.
+ * @param t The tree.
+ * @param num_threads Number of threads. Must be at least 1.
+ * @param fn Function that modifies the metadata: @e fn(metadata_t&).
+ * @param fs The functions of every level.
+ * @returns The statistics of the transformation.
+ */
+template <
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t,
+	typename fn_t,
+	typename... Callables>
+	requires(
+		Compound<data_t, metadata_t> and
+		(sizeof...(Callables) == 0 or
+		 sizeof...(Callables) == sizeof...(keys_t) or
+		 sizeof...(Callables) == sizeof...(keys_t) + 1)
+	)
+transform_stats transform_metadata(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	const std::size_t num_threads,
+	const fn_t& fn,
+	Callables&&...fs
+)
+{
+	thread_executor e(num_threads);
+	return transform_metadata(t, e, fn, std::forward<Callables>(fs)...);
+}
+
+/**
+ * @brief Applies a function to the data of the elements within a range.
+ *
+ * Same as @ref transform_metadata, but @e fn modifies the data of the
+ * elements. When the data is less-than comparable, the elements of a leaf
+ * are sorted, and a leaf whose elements are no longer sorted after the
+ * transformation is sorted again (keeping the relative order of equal
+ * elements). When @e unique is true, elements of a leaf whose data became
+ * equal are merged as in @ref basic_ctree::add: the first one is kept and
+ * the metadata of the others is merged into it. Use @e unique = false for
+ * trees built with repeats.
+ * @tparam unique Keep unique instances of the data in every leaf.
+ * @param t The tree.
+ * @param e The executor.
+ * @param fn Function that modifies the data: @e fn(data_t&).
+ * @param fs The functions of every level.
+ * @returns The statistics of the transformation.
+ */
+template <
+	bool unique = true,
+	Executor executor_t,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t,
+	typename fn_t,
+	typename... Callables>
+	requires(
+		sizeof...(Callables) == 0 or
+		sizeof...(Callables) == sizeof...(keys_t) or
+		sizeof...(Callables) == sizeof...(keys_t) + 1
+	)
+transform_stats transform_data(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	executor_t& e,
+	const fn_t& fn,
+	Callables&&...fs
+)
+{
+	return detail::transform_range<
+		sizeof...(keys_t),
+		LessthanComparable<data_t>,
+		unique>(
+		t,
+		e,
+		[&fn](element_t<data_t, metadata_t>& x)
+		{
+			if constexpr (Compound<data_t, metadata_t>) {
+				fn(x.data);
+			}
+			else {
+				fn(x);
+			}
+		},
+		std::forward<Callables>(fs)...
+	);
+}
+
+/**
+ * @brief Applies a function to the data of the elements within a range.
+ *
+ * Same as @ref transform_data with a @ref thread_executor.
+ * @tparam unique Keep unique instances of the data in every leaf.
+ * @param t The tree.
+ * @param num_threads Number of threads. Must be at least 1.
+ * @param fn Function that modifies the data: @e fn(data_t&).
+ * @param fs The functions of every level.
+ * @returns The statistics of the transformation.
+ */
+template <
+	bool unique = true,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t,
+	typename fn_t,
+	typename... Callables>
+	requires(
+		sizeof...(Callables) == 0 or
+		sizeof...(Callables) == sizeof...(keys_t) or
+		sizeof...(Callables) == sizeof...(keys_t) + 1
+	)
+transform_stats transform_data(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	const std::size_t num_threads,
+	const fn_t& fn,
+	Callables&&...fs
+)
+{
+	thread_executor e(num_threads);
+	return transform_data<unique>(t, e, fn, std::forward<Callables>(fs)...);
+}
+
+/**
+ * @brief Applies a function to the elements of the leaves within a range.
+ *
+ * Same as @ref transform_data, but @e fn receives all the elements of a
+ * leaf at once, as a contiguous span, so that it can process them with
+ * vectorized loops. The range is given by one function per key (there is
+ * no function over the elements), or by none for the whole tree. @e fn may
+ * modify the data and the metadata of the elements, but not their number;
+ * the order of the data and the unique instances are restored as in
+ * @ref transform_data.
+ * @tparam unique Keep unique instances of the data in every leaf.
+ * @param t The tree.
+ * @param e The executor.
+ * @param fn Function that modifies the elements of a leaf:
+ * @e fn(std::span<element_t<data_t, metadata_t>>).
+ * @param fs The functions of every level.
+ * @returns The statistics of the transformation.
+ */
+template <
+	bool unique = true,
+	Executor executor_t,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t,
+	typename fn_t,
+	typename... Callables>
+	requires(
+		sizeof...(Callables) == 0 or sizeof...(Callables) == sizeof...(keys_t)
+	)
+transform_stats transform_leaves(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	executor_t& e,
+	const fn_t& fn,
+	Callables&&...fs
+)
+{
+	return detail::transform_range<
+		sizeof...(keys_t),
+		LessthanComparable<data_t>,
+		unique>(
+		t,
+		e,
+		[&fn](const std::span<element_t<data_t, metadata_t>> elems)
+		{ fn(elems); },
+		std::forward<Callables>(fs)...
+	);
+}
+
+/**
+ * @brief Applies a function to the elements of the leaves within a range.
+ *
+ * Same as @ref transform_leaves with a @ref thread_executor.
+ * @tparam unique Keep unique instances of the data in every leaf.
+ * @param t The tree.
+ * @param num_threads Number of threads. Must be at least 1.
+ * @param fn Function that modifies the elements of a leaf:
+ * @e fn(std::span<element_t<data_t, metadata_t>>).
+ * @param fs The functions of every level.
+ * @returns The statistics of the transformation.
+ */
+template <
+	bool unique = true,
+	template <typename> class allocator_t,
+	typename data_t,
+	typename metadata_t,
+	typename... keys_t,
+	typename fn_t,
+	typename... Callables>
+	requires(
+		sizeof...(Callables) == 0 or sizeof...(Callables) == sizeof...(keys_t)
+	)
+transform_stats transform_leaves(
+	basic_ctree<allocator_t, data_t, metadata_t, keys_t...>& t,
+	const std::size_t num_threads,
+	const fn_t& fn,
+	Callables&&...fs
+)
+{
+	thread_executor e(num_threads);
+	return transform_leaves<unique>(t, e, fn, std::forward<Callables>(fs)...);
+}
+
+} // namespace classtree
@@ -25,6 +25,11 @@
 
 // C++ includes
 #include <type_traits>
+#include <utility>
+#include <memory>
+
+// ctree includes
+#include <ctree/types.hpp>
 
 namespace classtree {
 
@@ -51,4 +56,35 @@ constexpr bool
 	are_packs_equal_v<parameter_pack<head1_t>, parameter_pack<head2_t>> =
 		std::is_same_v<head1_t, head2_t>;
 
+/**
+ * @brief Can objects of type @e T be relocated with @e memcpy?
+ *
+ * An object is relocated when it is moved to a new address and the original
+ * is destroyed. For trivially relocatable types, this is the same as copying
+ * their bytes. This is true for trivially copyable types, pairs of trivially
+ * relocatable types, and the nodes of @ref basic_ctree whose allocator is
+ * trivially relocatable.
+ *
+ * Other types can opt in with a specialization:
+ * @code
+ * template <>
+ * constexpr bool classtree::is_trivially_relocatable_v<my_type> = true;
+ * @endcode
+ * @tparam T Type of the objects.
+ */
+template <typename T>
+constexpr bool is_trivially_relocatable_v = std::is_trivially_copyable_v<T>;
+
+template <typename T>
+constexpr bool is_trivially_relocatable_v<std::allocator<T>> = true;
+
+template <typename T, typename U>
+constexpr bool is_trivially_relocatable_v<std::pair<T, U>> =
+	is_trivially_relocatable_v<T> and is_trivially_relocatable_v<U>;
+
+template <typename data_t, typename metadata_t>
+constexpr bool is_trivially_relocatable_v<pair<data_t, metadata_t>> =
+	is_trivially_relocatable_v<data_t> and
+	is_trivially_relocatable_v<metadata_t>;
+
 } // namespace classtree
@@ -0,0 +1,93 @@
+/**
+ * Bulk loader of the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// ctree includes
+#include <ctree/bulk_load.hpp>
+#include <ctree/ctree.hpp>
+
+/// Loads a file into a tree with keys @e keys_t and prints the statistics.
+template <typename... keys_t>
+static int run(
+	const bool binary,
+	const std::string& path,
+	const classtree::load_options& opts
+)
+{
+	classtree::ctree<std::uint64_t, void, keys_t...> t;
+	const auto stats = binary ? classtree::load_binary(t, path, opts)
+							  : classtree::load_csv(t, path, opts);
+	if (not stats.has_value()) {
+		std::cerr << "Error: could not load '" << path << "'\n";
+		return 1;
+	}
+
+	std::cout << "Records:      " << stats->num_records << '\n';
+	std::cout << "Elements:     " << t.size() << '\n';
+	std::cout << "Parse:        " << stats->parse_seconds << " s, "
+			  << stats->parse_throughput() / 1e6 << " MB/s\n";
+	std::cout << "Build:        " << stats->build_seconds << " s, "
+			  << stats->build_throughput() / 1e6 << " Mrecords/s\n";
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 5) {
+		std::cerr << "Usage: " << argv[0]
+				  << " (csv|binary) file num_keys num_threads [separator]\n";
+		std::cerr << "    Every record has num_keys unsigned 64-bit keys and\n";
+		std::cerr << "    an unsigned 64-bit payload. num_keys is 1 to 4.\n";
+		return 1;
+	}
+
+	const bool binary = std::strcmp(argv[1], "binary") == 0;
+	const std::string path = argv[2];
+	const int num_keys = std::stoi(argv[3]);
+
+	classtree::load_options opts;
+	opts.num_threads = std::stoul(argv[4]);
+	if (argc > 5) {
+		opts.separator = argv[5][0];
+	}
+
+	using u64 = std::uint64_t;
+	switch (num_keys) {
+	case 1:
+		return run<u64>(binary, path, opts);
+	case 2:
+		return run<u64, u64>(binary, path, opts);
+	case 3:
+		return run<u64, u64, u64>(binary, path, opts);
+	case 4:
+		return run<u64, u64, u64, u64>(binary, path, opts);
+	default:
+		std::cerr << "Error: the number of keys must be 1, 2, 3 or 4\n";
+		return 1;
+	}
+}
@@ -24,8 +24,14 @@
 #pragma once
 
 // C++ includes
+#include <memory_resource>
+#include <type_traits>
 #include <sstream>
 #include <ostream>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <tuple>
 
 // ctree includes
 #include <ctree/concepts.hpp>
@@ -97,3 +103,99 @@ std::string range_iterate_string_backward(it_t& it) noexcept
 	}
 	return ss.str();
 }
+
+/// A thread-safe memory resource that counts the bytes in use.
+class counting_resource : public std::pmr::memory_resource {
+public:
+
+	std::atomic<std::size_t> bytes{0};
+
+private:
+
+	void *do_allocate(const std::size_t n, const std::size_t align) override
+	{
+		bytes += n;
+		return std::pmr::new_delete_resource()->allocate(n, align);
+	}
+	void do_deallocate(
+		void *p, const std::size_t n, const std::size_t align
+	) override
+	{
+		bytes -= n;
+		std::pmr::new_delete_resource()->deallocate(p, n, align);
+	}
+	[[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& r
+	) const noexcept override
+	{
+		return this == &r;
+	}
+};
+
+/// A key of type @e key_t made from @e v.
+template <typename key_t>
+[[nodiscard]] key_t make_key(const int v)
+{
+	if constexpr (std::is_same_v<key_t, std::string>) {
+		return "s" + std::to_string(v);
+	}
+	else if constexpr (std::is_same_v<key_t, int>) {
+		return v;
+	}
+	else {
+		return static_cast<key_t>(v);
+	}
+}
+
+/**
+ * @brief Adds the values 0, ..., n - 1 to a tree with three keys.
+ *
+ * The value i is added under the keys (i * 7) % 61, (i * 3) % 11 and i % 5.
+ */
+template <typename tree_t>
+void fill_tree(tree_t& t, const int n)
+{
+	using child_t = typename tree_t::child_t;
+	using key1_t = typename tree_t::subtree_t::first_type;
+	using key2_t = typename child_t::subtree_t::first_type;
+	using key3_t = typename child_t::child_t::subtree_t::first_type;
+
+	for (int i = 0; i < n; ++i) {
+		int value = i;
+		t.template add<false>(
+			std::move(value),
+			make_key<key1_t>((i * 7) % 61),
+			make_key<key2_t>((i * 3) % 11),
+			make_key<key3_t>(i % 5)
+		);
+	}
+}
+
+/// The elements of a tree, with their keys, in order.
+template <typename tree_t>
+[[nodiscard]] auto contents(const tree_t& t)
+{
+	std::vector<decltype(+t.get_const_iterator_begin())> v;
+	auto it = t.get_const_iterator_begin();
+	while (not it.end()) {
+		v.push_back(+it);
+		++it;
+	}
+	return v;
+}
+
+/**
+ * @brief The elements of a tree, with their keys, in order.
+ * @param flatten Function called with an element and its keys, which
+ * returns the value stored for them.
+ */
+template <typename tree_t, typename flatten_t>
+[[nodiscard]] auto contents(const tree_t& t, const flatten_t& flatten)
+{
+	auto it = t.get_const_iterator_begin();
+	std::vector<decltype(std::apply(flatten, +it))> v;
+	while (not it.end()) {
+		v.push_back(std::apply(flatten, +it));
+		++it;
+	}
+	return v;
+}
@@ -0,0 +1,242 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <random>
+#include <vector>
+#include <array>
+#include <cmath>
+
+// ctree includes
+#include <ctree/approximate.hpp>
+#include <ctree/batch_predicate.hpp>
+#include <ctree/key_set.hpp>
+#include <ctree/ctree.hpp>
+
+typedef classtree::ctree<int, void, int, int, int> tree_t;
+typedef std::array<int, 4> record_t;
+
+/// Builds a tree from random records; the records are also returned.
+[[nodiscard]] static tree_t make_tree(std::vector<record_t>& records)
+{
+	std::mt19937 gen(1234);
+	std::uniform_int_distribution<int> k1(0, 99);
+	std::uniform_int_distribution<int> k2(0, 19);
+	std::uniform_int_distribution<int> k3(0, 9);
+	std::uniform_int_distribution<int> data(0, 999);
+
+	tree_t t;
+	for (int i = 0; i < 100000; ++i) {
+		// skew the sizes of the subtrees of the root
+		int a = k1(gen) * k1(gen) / 100;
+		int b = k2(gen);
+		int c = k3(gen);
+		int d = data(gen);
+		records.push_back({a, b, c, d});
+		t.add<false>(std::move(d), std::move(a), std::move(b), std::move(c));
+	}
+	return t;
+}
+
+/// Checks that the estimates contain the exact value in most runs.
+template <typename query_t>
+static void check_coverage(const double exact, const query_t& query)
+{
+	std::size_t num_contained = 0;
+	double sum = 0;
+	for (std::uint64_t seed = 0; seed < 100; ++seed) {
+		const classtree::estimate e = query(
+			classtree::approximate_options{.max_nodes = 2000, .seed = seed}
+		);
+		CHECK(e.low <= e.value);
+		CHECK(e.value <= e.high);
+		CHECK(e.num_nodes <= 2000);
+		CHECK(e.num_samples >= 2);
+		num_contained += e.contains(exact);
+		sum += e.value;
+	}
+	CHECK(num_contained >= 85);
+	// the estimator is unbiased
+	CHECK(std::abs(sum / 100 - exact) <= 0.05 * exact);
+}
+
+TEST_CASE("Count")
+{
+	std::vector<record_t> records;
+	const tree_t t = make_tree(records);
+
+	const auto f1 = [](const int a) { return a % 3 == 0; };
+	const auto f2 = classtree::batch_between(5, 12);
+	const auto f3 = classtree::in_set({1, 2, 7});
+
+	SUBCASE("Keys")
+	{
+		double exact = 0;
+		for (const record_t& r : records) {
+			exact += f1(r[0]) and 5 <= r[1] and r[1] <= 12 and
+					 (r[2] == 1 or r[2] == 2 or r[2] == 7);
+		}
+		check_coverage(
+			exact,
+			[&](const classtree::approximate_options& opts)
+			{ return classtree::approximate_count(t, opts, f1, f2, f3); }
+		);
+	}
+
+	SUBCASE("Leaf predicate")
+	{
+		const auto leaf = [](const int d) { return d < 100; };
+		double exact = 0;
+		for (const record_t& r : records) {
+			exact += f1(r[0]) and 5 <= r[1] and r[1] <= 12 and r[3] < 100;
+		}
+		const auto any = [](const int) { return true; };
+		check_coverage(
+			exact,
+			[&](const classtree::approximate_options& opts)
+			{
+				return classtree::approximate_count(
+					t, opts, f1, f2, any, leaf
+				);
+			}
+		);
+
+		const auto batch_leaf = classtree::batch_between(0, 99);
+		const classtree::estimate a =
+			classtree::approximate_count(t, {}, f1, f2, any, leaf);
+		const classtree::estimate b =
+			classtree::approximate_count(t, {}, f1, f2, any, batch_leaf);
+		CHECK_EQ(a.value, b.value);
+		CHECK_EQ(a.num_nodes, b.num_nodes);
+	}
+
+	SUBCASE("Exact")
+	{
+		const auto any = [](const int) { return true; };
+		const classtree::estimate e =
+			classtree::approximate_count(t, {}, any, any, any);
+		CHECK_EQ(e.value, static_cast<double>(t.size()));
+		CHECK_EQ(e.low, e.value);
+		CHECK_EQ(e.high, e.value);
+
+		const auto none = [](const int) { return false; };
+		const classtree::estimate z =
+			classtree::approximate_count(t, {}, f1, none, any);
+		CHECK_EQ(z.value, 0);
+		CHECK_EQ(z.low, 0);
+		CHECK_EQ(z.high, 0);
+
+		const tree_t empty;
+		const classtree::estimate w =
+			classtree::approximate_count(empty, {}, any, any, any);
+		CHECK_EQ(w.value, 0);
+	}
+}
+
+TEST_CASE("Sum")
+{
+	std::vector<record_t> records;
+	const tree_t t = make_tree(records);
+
+	const auto f1 = classtree::in_intervals<int>({{0, 10}, {40, 60}});
+	const auto any = [](const int) { return true; };
+	const auto value = [](const int d) { return d; };
+
+	double exact = 0;
+	for (const record_t& r : records) {
+		if (r[0] <= 10 or (40 <= r[0] and r[0] <= 60)) {
+			exact += r[3];
+		}
+	}
+	check_coverage(
+		exact,
+		[&](const classtree::approximate_options& opts)
+		{ return classtree::approximate_sum(t, opts, value, f1, any, any); }
+	);
+}
+
+TEST_CASE("Wide nodes")
+{
+	classtree::ctree<int, void, int, int> t;
+	std::mt19937 gen(4321);
+	std::uniform_int_distribution<int> k1(0, 4999);
+	std::uniform_int_distribution<int> k2(0, 9);
+	std::vector<record_t> records;
+	for (int i = 0; i < 50000; ++i) {
+		int a = k1(gen);
+		int b = k2(gen);
+		int d = i;
+		records.push_back({a, b, 0, d});
+		t.add<false>(std::move(d), std::move(a), std::move(b));
+	}
+	REQUIRE(t.num_keys() > 256);
+
+	std::size_t num_calls = 0;
+	const auto f1 = [&](const int a)
+	{
+		++num_calls;
+		return a % 4 == 0;
+	};
+	const auto f2 = classtree::batch_between(2, 6);
+	double exact = 0;
+	for (const record_t& r : records) {
+		exact += r[0] % 4 == 0 and 2 <= r[1] and r[1] <= 6;
+	}
+	check_coverage(
+		exact,
+		[&](const classtree::approximate_options& opts)
+		{ return classtree::approximate_count(t, opts, f1, f2); }
+	);
+
+	// only the key of the child chosen at the root is evaluated
+	num_calls = 0;
+	const classtree::estimate e = classtree::approximate_count(t, {}, f1, f2);
+	CHECK(num_calls <= e.num_samples);
+
+	// all the keys of the root are evaluated once
+	num_calls = 0;
+	const classtree::estimate all =
+		classtree::approximate_count(t, {.max_fan_out = 5000}, f1, f2);
+	CHECK_EQ(num_calls, t.num_keys());
+	CHECK(all.contains(exact));
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,222 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <map>
+
+// ctree includes
+#include <ctree/ctree.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/arena.hpp>
+
+// custom includes
+#include "functions.hpp"
+
+/// A memory resource that keeps track of the blocks it allocated.
+class tracking_resource : public std::pmr::memory_resource {
+public:
+
+	std::map<const void *, std::pair<std::size_t, std::size_t>> blocks;
+	std::size_t num_deallocations = 0;
+
+	explicit tracking_resource(
+		std::pmr::memory_resource *const upstream =
+			std::pmr::new_delete_resource()
+	)
+		: m_upstream(upstream)
+	{ }
+
+	/// Frees the blocks that were not deallocated, like an arena.
+	~tracking_resource() override
+	{
+		for (const auto& [p, s] : blocks) {
+			m_upstream->deallocate(const_cast<void *>(p), s.first, s.second);
+		}
+	}
+
+private:
+
+	void *do_allocate(const std::size_t n, const std::size_t align) override
+	{
+		void *const p = m_upstream->allocate(n, align);
+		blocks.emplace(p, std::pair{n, align});
+		return p;
+	}
+	void do_deallocate(
+		void *p, const std::size_t n, const std::size_t align
+	) override
+	{
+		++num_deallocations;
+		blocks.erase(p);
+		m_upstream->deallocate(p, n, align);
+	}
+	[[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& r
+	) const noexcept override
+	{
+		return this == &r;
+	}
+
+	std::pmr::memory_resource *m_upstream;
+};
+
+/// The memory of every node of a tree.
+template <typename node_t>
+static void buffers(const node_t& n, std::vector<const void *>& out)
+{
+	if (n.begin() != n.end()) {
+		out.push_back(&*n.begin());
+	}
+	if constexpr (requires { n.begin()->second; }) {
+		for (const auto& [_, c] : n) {
+			buffers(c, out);
+		}
+	}
+}
+
+/// An element with its keys, as a tuple of comparable values.
+static constexpr auto flatten = [](const auto& e, const auto&...keys)
+{
+	return std::tuple(e.data, e.metadata, keys...);
+};
+
+typedef classtree::ctree<int, int, int, int> tree_t;
+typedef classtree::arena_ctree<tree_t, tracking_resource> arena_t;
+
+TEST_CASE("Children use the allocator of their parent")
+{
+	tracking_resource r;
+	tree_t t;
+	t.set_allocator(&r);
+	for (int i = 0; i < 500; ++i) {
+		t.add({i % 37, 1}, i % 7, i % 11);
+	}
+
+	std::vector<const void *> bs;
+	buffers(t, bs);
+	CHECK_GT(bs.size(), 7);
+	for (const void *p : bs) {
+		CHECK(r.blocks.contains(p));
+	}
+	CHECK_EQ(r.blocks.size(), bs.size());
+}
+
+TEST_CASE("Subtrees in arenas")
+{
+	tracking_resource upstream;
+	tree_t plain;
+	{
+		arena_t t(&upstream);
+		for (int i = 0; i < 3000; ++i) {
+			const int d = (i * 13) % 101;
+			const int k1 = i % 9;
+			const int k2 = (i * 7) % 23;
+			CHECK_EQ(t.add({d, 1}, k1, k2), plain.add({d, 1}, k1, k2));
+		}
+		CHECK_EQ(t.size(), plain.size());
+		CHECK_EQ(t.num_arenas(), 9);
+		CHECK_EQ(contents(t.tree(), flatten), contents(plain, flatten));
+
+		// every node of a subtree is in the arena of the subtree
+		for (std::size_t i = 0; i < t.tree().num_keys(); ++i) {
+			const int k = t.tree().get_key(i);
+			const tracking_resource *const a = t.arena(k);
+			REQUIRE(a != nullptr);
+			std::vector<const void *> bs;
+			buffers(t.tree().get_child(i), bs);
+			CHECK_FALSE(bs.empty());
+			for (const void *p : bs) {
+				CHECK(a->blocks.contains(p));
+			}
+		}
+
+		// dropping a subtree releases its arena
+		const std::size_t before = upstream.blocks.size();
+		const std::size_t removed = t.drop(4);
+		CHECK_EQ(removed, plain.get_child(4).size());
+		CHECK_EQ(t.size(), plain.size() - removed);
+		CHECK_EQ(t.arena(4), nullptr);
+		CHECK_EQ(t.num_arenas(), 8);
+		CHECK_LT(upstream.blocks.size(), before);
+		CHECK_EQ(t.drop(4), 0);
+
+		auto expected = contents(plain, flatten);
+		std::erase_if(
+			expected, [](const auto& e) { return std::get<2>(e) == 4; }
+		);
+		CHECK_EQ(contents(t.tree(), flatten), expected);
+
+		// the key can be used again
+		CHECK(t.add({1, 1}, 4, 0));
+		CHECK_EQ(t.num_arenas(), 9);
+		CHECK_EQ(t.size(), plain.size() - removed + 1);
+	}
+	CHECK(upstream.blocks.empty());
+}
+
+TEST_CASE("Non-trivial types")
+{
+	typedef classtree::ctree<std::string, void, std::string, int>
+		string_tree_t;
+
+	tracking_resource upstream;
+	{
+		classtree::arena_ctree<string_tree_t> t(&upstream);
+		for (int i = 0; i < 1000; ++i) {
+			t.add(
+				"a string that does not fit in small buffers " +
+					std::to_string(i % 50),
+				"key number " + std::to_string(i % 6),
+				i % 4
+			);
+		}
+		CHECK_EQ(t.size(), 300);
+		const std::size_t n = t.tree().get_child(0).size();
+		CHECK_EQ(t.drop("key number 0"), n);
+		CHECK_EQ(t.num_arenas(), 5);
+	}
+	CHECK(upstream.blocks.empty());
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,292 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <tuple>
+
+// ctree includes
+#include <ctree/batch_predicate.hpp>
+#include <ctree/ctree.hpp>
+#include <ctree/key_set.hpp>
+#include <ctree/range_iterator.hpp>
+
+typedef classtree::ctree<int, void, int, int> tree_t;
+typedef std::tuple<int, int, int> value_t;
+
+[[nodiscard]] static tree_t make_tree()
+{
+	std::mt19937 gen(1234);
+	std::uniform_int_distribution<int> k1(0, 199);
+	std::uniform_int_distribution<int> k2(0, 99);
+
+	tree_t kd;
+	for (int i = 0; i < 5000; ++i) {
+		int value = i;
+		kd.add(std::move(value), k1(gen), k2(gen));
+	}
+	return kd;
+}
+
+template <typename it_t>
+[[nodiscard]] static std::vector<value_t> forward(it_t it)
+{
+	std::vector<value_t> v;
+	while (not it.end()) {
+		v.push_back(+it);
+		++it;
+	}
+	return v;
+}
+
+template <typename it_t>
+[[nodiscard]] static std::vector<value_t> backward(it_t it)
+{
+	std::vector<value_t> v;
+	while (not it.past_begin()) {
+		v.push_back(+it);
+		--it;
+	}
+	return v;
+}
+
+template <typename F1, typename F2, typename B1, typename B2>
+static void
+compare(const tree_t& kd, const F1& f1, const F2& f2, const B1& b1, const B2& b2)
+{
+	const auto expected_fwd = forward(kd.get_const_range_iterator_begin(f1, f2));
+	const auto expected_bwd = backward(kd.get_const_range_iterator_end(f1, f2));
+
+	CHECK_EQ(forward(kd.get_const_range_iterator_begin(b1, b2)), expected_fwd);
+	CHECK_EQ(forward(kd.get_const_range_iterator_begin(f1, b2)), expected_fwd);
+	CHECK_EQ(forward(kd.get_const_range_iterator_begin(b1, f2)), expected_fwd);
+	CHECK_EQ(backward(kd.get_const_range_iterator_end(b1, b2)), expected_bwd);
+	CHECK_EQ(backward(kd.get_const_range_iterator_end(b1, f2)), expected_bwd);
+
+	auto it = kd.get_const_range_iterator(b1, b2);
+	CHECK_EQ(it.count(), expected_fwd.size());
+
+	if (expected_fwd.size() < 2) {
+		return;
+	}
+
+	// move back and forth
+	auto jt = kd.get_const_range_iterator_begin(b1, b2);
+	++jt;
+	++jt;
+	--jt;
+	CHECK_EQ(+jt, expected_fwd[1]);
+	--jt;
+	CHECK_EQ(+jt, expected_fwd[0]);
+	CHECK(jt.begin());
+	--jt;
+	CHECK(jt.past_begin());
+	++jt;
+	CHECK_EQ(+jt, expected_fwd[0]);
+}
+
+TEST_CASE("Batch predicates")
+{
+	const tree_t kd = make_tree();
+
+	SUBCASE("Intervals")
+	{
+		for (const auto& [lo1, hi1] : std::vector<std::pair<int, int>>{
+				 {0, 199}, {5, 5}, {60, 70}, {63, 64}, {100, 190}, {190, 500}
+			 }) {
+			for (const auto& [lo2, hi2] : std::vector<std::pair<int, int>>{
+					 {0, 99}, {10, 20}, {64, 64}, {98, 99}
+				 }) {
+				const auto f1 = [lo = lo1, hi = hi1](const int k) -> bool
+				{
+					return lo <= k and k <= hi;
+				};
+				const auto f2 = [lo = lo2, hi = hi2](const int k) -> bool
+				{
+					return lo <= k and k <= hi;
+				};
+				compare(
+					kd,
+					f1,
+					f2,
+					classtree::batch_between(lo1, hi1),
+					classtree::batch_between(lo2, hi2)
+				);
+			}
+		}
+	}
+
+	SUBCASE("Custom")
+	{
+		const auto f = [](const int k) -> bool
+		{
+			return k % 3 == 0;
+		};
+		const auto b = classtree::batch(
+			[&](std::span<const int> keys, std::span<std::uint64_t> mask)
+			{
+				for (size_t i = 0; i < keys.size(); ++i) {
+					if (f(keys[i])) {
+						mask[i / 64] |= std::uint64_t{1} << (i % 64);
+					}
+				}
+			}
+		);
+		compare(kd, f, f, b, b);
+	}
+
+	SUBCASE("Empty")
+	{
+		const auto f = [](const int) -> bool
+		{
+			return false;
+		};
+		const auto b = classtree::batch(
+			[](std::span<const int>, std::span<std::uint64_t>) { }
+		);
+		compare(kd, f, f, b, b);
+
+		auto it = kd.get_const_range_iterator_begin(b, b);
+		CHECK(it.end());
+	}
+}
+
+TEST_CASE("Sets of values")
+{
+	const tree_t kd = make_tree();
+
+	for (const auto& values : std::vector<std::vector<int>>{
+			 {3, 17, 42, 101},
+			 {42, 3, 3, 17, 42},
+			 {-5, 0, 199, 250},
+			 {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 63, 64, 65, 127, 128},
+			 {500},
+			 {}
+		 }) {
+		const auto s = classtree::in_set(values);
+		const auto f = [&](const int k) -> bool
+		{
+			return std::find(values.begin(), values.end(), k) != values.end();
+		};
+		for (int k = -10; k < 210; ++k) {
+			CHECK_EQ(s(k), f(k));
+		}
+		compare(kd, f, f, s, s);
+		const auto g = [](const int k) -> bool
+		{
+			return k == 7;
+		};
+		compare(kd, f, g, s, classtree::in_set({7}));
+	}
+
+	auto it = kd.get_const_range_iterator_begin(
+		classtree::in_set<int>({}), classtree::in_set<int>({})
+	);
+	CHECK(it.end());
+}
+
+TEST_CASE("Unions of intervals")
+{
+	const tree_t kd = make_tree();
+
+	typedef std::vector<std::pair<int, int>> intervals_t;
+	for (const auto& intervals : std::vector<intervals_t>{
+			 {{1, 5}, {20, 30}},
+			 {{20, 30}, {1, 5}, {25, 40}, {40, 41}},
+			 {{10, 5}, {60, 70}, {63, 64}, {190, 500}},
+			 {{0, 199}},
+			 {{-10, -1}, {200, 300}},
+			 {{7, 7}, {9, 9}, {128, 128}},
+			 {}
+		 }) {
+		const auto I = classtree::in_intervals(intervals);
+		const auto f = [&](const int k) -> bool
+		{
+			return std::any_of(
+				intervals.begin(),
+				intervals.end(),
+				[&](const auto& J) { return J.first <= k and k <= J.second; }
+			);
+		};
+		for (int k = -10; k < 210; ++k) {
+			CHECK_EQ(I(k), f(k));
+		}
+		compare(kd, f, f, I, I);
+		const auto g = [](const int) -> bool
+		{
+			return true;
+		};
+		compare(kd, f, g, I, classtree::batch_between(0, 99));
+	}
+
+	const auto I = classtree::in_intervals<int>({{5, 10}, {1, 3}, {2, 6}, {20, 8}});
+	CHECK_EQ(I.intervals, intervals_t{{1, 10}});
+}
+
+TEST_CASE("Bits and galloping")
+{
+	for (size_t first = 0; first < 200; first += 7) {
+		for (size_t last = first; last < 200; last += 11) {
+			std::vector<std::uint64_t> mask(4, 0);
+			classtree::detail::set_bits(mask, first, last);
+			for (size_t i = 0; i < 256; ++i) {
+				const bool set = (mask[i / 64] >> (i % 64)) & 1;
+				CHECK_EQ(set, first <= i and i < last);
+			}
+		}
+	}
+
+	std::vector<int> v(100);
+	for (int i = 0; i < 100; ++i) {
+		v[static_cast<size_t>(i)] = 2 * i;
+	}
+	for (int x = -1; x < 202; ++x) {
+		const auto before = [&](const int y) { return y < x; };
+		CHECK_EQ(
+			classtree::detail::gallop(v.begin(), v.end(), before),
+			std::partition_point(v.begin(), v.end(), before)
+		);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
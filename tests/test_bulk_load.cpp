@@ -0,0 +1,231 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <cstdint>
+#include <memory_resource>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <tuple>
+
+// POSIX includes
+#include <unistd.h>
+
+// ctree includes
+#include <ctree/bulk_load.hpp>
+#include <ctree/ctree.hpp>
+#include <ctree/iterator.hpp>
+
+// custom includes
+#include "functions.hpp"
+
+struct occurrences {
+	std::size_t num_occs = 0;
+	occurrences& operator+= (const occurrences& m) noexcept
+	{
+		num_occs += m.num_occs;
+		return *this;
+	}
+};
+
+/// A path for a temporary file.
+[[nodiscard]] static std::string temp_path(const std::string& name)
+{
+	return "/tmp/ctree_test_bulk_load_" + std::to_string(::getpid()) + "_" +
+		   name;
+}
+
+typedef std::tuple<int, std::string, double, int> record_t;
+
+[[nodiscard]] static std::vector<record_t> make_records(const int n)
+{
+	std::mt19937 gen(1234);
+	std::uniform_int_distribution<int> k1(-50, 50);
+	std::uniform_int_distribution<int> k2(0, 9);
+	std::uniform_int_distribution<int> k3(0, 20);
+	std::uniform_int_distribution<int> data(0, 10);
+	std::vector<record_t> records;
+	for (int i = 0; i < n; ++i) {
+		records.emplace_back(
+			k1(gen), "s" + std::to_string(k2(gen)), k3(gen) * 0.25, data(gen)
+		);
+	}
+	return records;
+}
+
+TEST_CASE("Text records")
+{
+	const std::vector<record_t> records = make_records(20000);
+	const std::string path = temp_path("records.csv");
+	{
+		std::ofstream fout(path);
+		fout << "k1;k2;k3;data\n";
+		for (const auto& [a, b, c, d] : records) {
+			fout << a << ';' << b << ';' << c << ';' << d << '\n';
+		}
+		// an empty line and a line ending in '\r'
+		fout << "\n1;s1;0.5;3\r\n";
+	}
+
+	typedef classtree::ctree<int, occurrences, int, std::string, double>
+		tree_t;
+	const auto one = [](const int) { return occurrences{1}; };
+
+	tree_t expected;
+	for (auto [a, b, c, d] : records) {
+		expected.add({d, {1}}, a, b, c);
+	}
+	expected.add({3, {1}}, 1, std::string("s1"), 0.5);
+
+	for (const std::size_t num_threads : std::vector<std::size_t>{1, 3, 8}) {
+		const classtree::load_options opts{
+			.num_threads = num_threads, .separator = ';', .header = true
+		};
+
+		tree_t t;
+		const auto stats = classtree::load_csv(t, path, opts, one);
+		REQUIRE(stats.has_value());
+		CHECK_EQ(stats->num_records, records.size() + 1);
+		CHECK_EQ(t.size(), expected.size());
+		const auto a = contents(t);
+		const auto b = contents(expected);
+		REQUIRE_EQ(a.size(), b.size());
+		for (std::size_t i = 0; i < a.size(); ++i) {
+			const auto& [ea, a1, a2, a3] = a[i];
+			const auto& [eb, b1, b2, b3] = b[i];
+			CHECK_EQ(ea.data, eb.data);
+			CHECK_EQ(ea.metadata.num_occs, eb.metadata.num_occs);
+			CHECK_EQ(std::tie(a1, a2, a3), std::tie(b1, b2, b3));
+		}
+
+		// loading into a tree that is not empty merges the records
+		const auto again = classtree::load_csv(t, path, opts, one);
+		REQUIRE(again.has_value());
+		CHECK_EQ(t.size(), expected.size());
+		CHECK_EQ(
+			std::get<0>(contents(t)[0]).metadata.num_occs,
+			2 * std::get<0>(b[0]).metadata.num_occs
+		);
+	}
+
+	// malformed records
+	{
+		std::ofstream fout(path);
+		fout << "1;s1;0.5;3\n1;s1;x;3\n";
+	}
+	tree_t t;
+	CHECK_FALSE(
+		classtree::load_csv(t, path, {.separator = ';'}, one).has_value()
+	);
+	{
+		std::ofstream fout(path);
+		fout << "1;s1;3\n";
+	}
+	CHECK_FALSE(
+		classtree::load_csv(t, path, {.separator = ';'}, one).has_value()
+	);
+	CHECK_EQ(t.size(), 0);
+	CHECK_FALSE(classtree::load_csv(t, temp_path("none"), {}, one));
+
+	std::remove(path.c_str());
+}
+
+TEST_CASE("Binary records")
+{
+	typedef classtree::ctree<std::int64_t, void, std::int32_t, std::uint16_t>
+		tree_t;
+	const std::string path = temp_path("records.bin");
+
+	std::mt19937 gen(4321);
+	tree_t expected;
+	{
+		std::ofstream fout(path, std::ios::binary);
+		for (int i = 0; i < 10000; ++i) {
+			const std::int32_t a = static_cast<std::int32_t>(gen() % 100);
+			const std::uint16_t b = static_cast<std::uint16_t>(gen() % 30);
+			std::int64_t d = static_cast<std::int64_t>(gen() % 50) - 25;
+			fout.write(reinterpret_cast<const char *>(&a), sizeof(a));
+			fout.write(reinterpret_cast<const char *>(&b), sizeof(b));
+			fout.write(reinterpret_cast<const char *>(&d), sizeof(d));
+			expected.add<false>(std::move(d), a, b);
+		}
+	}
+
+	for (const std::size_t num_threads : std::vector<std::size_t>{1, 4}) {
+		tree_t t;
+		const auto stats = classtree::load_binary<false>(
+			t, path, {.num_threads = num_threads}
+		);
+		REQUIRE(stats.has_value());
+		CHECK_EQ(stats->num_records, 10000);
+		CHECK_EQ(stats->num_bytes, 10000 * 14);
+		CHECK_EQ(contents(t), contents(expected));
+	}
+
+	// the records loaded into a tree that is not empty are built with the
+	// allocator of the tree
+	{
+		counting_resource resource, other;
+		std::pmr::memory_resource *const previous =
+			std::pmr::set_default_resource(&other);
+		tree_t t;
+		t.set_allocator(&resource);
+		t.add<false>(std::int64_t{100}, std::int32_t{1000}, std::uint16_t{1});
+		REQUIRE(classtree::load_binary<false>(t, path).has_value());
+		CHECK_EQ(t.size(), 10001);
+		CHECK_GT(resource.bytes.load(), 0);
+		CHECK_EQ(other.bytes.load(), 0);
+		std::pmr::set_default_resource(previous);
+	}
+
+	{
+		std::ofstream fout(path, std::ios::binary | std::ios::app);
+		fout.put('x');
+	}
+	tree_t t;
+	CHECK_FALSE(classtree::load_binary(t, path).has_value());
+
+	std::remove(path.c_str());
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -38,6 +38,10 @@
 template <typename data_t, typename metadata_t, typename... keys_t>
 using ctree = classtree::ctree<data_t, metadata_t, keys_t...>;
 
+template <typename data_t, typename metadata_t, typename... keys_t>
+using std_ctree =
+	classtree::basic_ctree<std::allocator, data_t, metadata_t, keys_t...>;
+
 using sstring = std::string;
 
 TEST_CASE("Tree sizes")
@@ -82,6 +86,49 @@ TEST_CASE("Tree sizes")
 	static_assert(sizeof(ctree<sstring, int, sstring, int, sstring>) == 40);
 }
 
+TEST_CASE("Tree sizes (std::allocator)")
+{
+	// leaf
+	static_assert(sizeof(std_ctree<char, void>) == 24);
+	static_assert(sizeof(std_ctree<char, int>) == 24);
+	static_assert(sizeof(std_ctree<int, int>) == 24);
+
+	// depth 1
+	static_assert(sizeof(std_ctree<char, void, char>) == 32);
+	static_assert(sizeof(std_ctree<char, int, int>) == 32);
+	static_assert(sizeof(std_ctree<int, int, sstring>) == 32);
+
+	// depth 2
+	static_assert(sizeof(std_ctree<char, void, char, char>) == 32);
+	static_assert(sizeof(std_ctree<char, int, char, int>) == 32);
+	static_assert(sizeof(std_ctree<int, int, char, sstring>) == 32);
+
+	// depth 3
+	static_assert(sizeof(std_ctree<char, void, sstring, char, char>) == 32);
+	static_assert(sizeof(std_ctree<char, int, sstring, char, int>) == 32);
+	static_assert(sizeof(std_ctree<int, int, sstring, char, sstring>) == 32);
+}
+
+TEST_CASE("Tree sizes (compact)")
+{
+	// leaf
+	static_assert(sizeof(classtree::compact_ctree<char, void>) == 16);
+	static_assert(sizeof(classtree::compact_ctree<char, int>) == 16);
+	static_assert(sizeof(classtree::compact_ctree<int, int>) == 16);
+
+	// depth 1
+	static_assert(sizeof(classtree::compact_ctree<char, void, char>) == 20);
+	static_assert(sizeof(classtree::compact_ctree<char, int, int>) == 20);
+
+	// depth 3
+	static_assert(
+		sizeof(classtree::compact_ctree<char, int, sstring, char, int>) == 20
+	);
+	static_assert(
+		sizeof(std::pair<int, classtree::compact_ctree<char, int, int>>) == 24
+	);
+}
+
 TEST_CASE("Leaf t")
 {
 	{
@@ -227,6 +274,46 @@ TEST_CASE("1-level t")
 	}
 }
 
+TEST_CASE("1-level t (std::allocator)")
+{
+	std_ctree<char, void, int> t;
+	CHECK_EQ(t.template total_bytes<true>(), 0);
+	CHECK_EQ(t.template total_bytes<false>(), 0);
+
+	// 1 branch
+	t.add('a', 1);
+	CHECK_EQ(t.template total_bytes<true>(), 40);
+	CHECK_EQ(t.template total_bytes<false>(), 33);
+	t.add('b', 1);
+	CHECK_EQ(t.template total_bytes<true>(), 40);
+	CHECK_EQ(t.template total_bytes<false>(), 34);
+
+	// 2 branches
+	t.add('d', 2);
+	CHECK_EQ(t.template total_bytes<true>(), 80);
+	CHECK_EQ(t.template total_bytes<false>(), 67);
+}
+
+TEST_CASE("1-level t (compact)")
+{
+	classtree::compact_ctree<char, void, int> t;
+	CHECK_EQ(t.template total_bytes<true>(), 0);
+	CHECK_EQ(t.template total_bytes<false>(), 0);
+
+	// 1 branch
+	t.add('a', 1);
+	CHECK_EQ(t.template total_bytes<true>(), 24);
+	CHECK_EQ(t.template total_bytes<false>(), 21);
+	t.add('b', 1);
+	CHECK_EQ(t.template total_bytes<true>(), 24);
+	CHECK_EQ(t.template total_bytes<false>(), 22);
+
+	// 2 branches
+	t.add('d', 2);
+	CHECK_EQ(t.template total_bytes<true>(), 48);
+	CHECK_EQ(t.template total_bytes<false>(), 43);
+}
+
 int main(int argc, char **argv)
 {
 	doctest::Context context;
@@ -0,0 +1,165 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+// ctree includes
+#include <ctree/ctree.hpp>
+#include <ctree/iterator.hpp>
+
+// custom includes
+#include "functions.hpp"
+
+typedef classtree::ctree<int, void, int, std::string, int> tree_t;
+
+[[nodiscard]] static tree_t make_tree(const int n)
+{
+	tree_t t;
+	fill_tree(t, n);
+	return t;
+}
+
+TEST_CASE("Clone")
+{
+	for (const int n : {0, 1, 100, 5000}) {
+		const tree_t t = make_tree(n);
+
+		counting_resource resource;
+		tree_t c = t.clone(&resource);
+		CHECK_EQ(contents(c), contents(t));
+		CHECK_EQ(c.size(), t.size());
+		CHECK_EQ(c.num_keys(), t.num_keys());
+
+		// the capacity of every node is its size
+		CHECK_EQ(
+			c.total_capacity_bytes<false>(), t.total_bytes<false>()
+		);
+		CHECK_EQ(resource.bytes.load(), t.total_bytes<false>());
+
+		// the clone is independent of the tree
+		c.add<false>(-1, 1000, std::string("x"), 0);
+		CHECK_EQ(c.size(), t.size() + 1);
+		CHECK_EQ(contents(make_tree(n)), contents(t));
+	}
+}
+
+TEST_CASE("Clone into an arena")
+{
+	const tree_t t = make_tree(5000);
+	std::pmr::monotonic_buffer_resource arena(t.total_bytes<true>());
+	const tree_t c = t.clone(&arena);
+	CHECK_EQ(contents(c), contents(t));
+}
+
+TEST_CASE("Parallel clone")
+{
+	const tree_t t = make_tree(5000);
+
+	for (const std::size_t num_threads : std::vector<std::size_t>{1, 3, 100}) {
+		const tree_t c = t.clone_parallel(num_threads);
+		CHECK_EQ(contents(c), contents(t));
+		CHECK_EQ(c.size(), t.size());
+		CHECK_EQ(c.total_capacity_bytes<false>(), t.total_bytes<false>());
+	}
+
+	std::vector<counting_resource> resources(4);
+	std::vector<std::pmr::polymorphic_allocator<std::byte>> allocs;
+	for (auto& r : resources) {
+		allocs.emplace_back(&r);
+	}
+	const tree_t c = t.clone_parallel(
+		std::span<const std::pmr::polymorphic_allocator<std::byte>>(allocs)
+	);
+	CHECK_EQ(contents(c), contents(t));
+
+	std::size_t bytes = 0;
+	for (const auto& r : resources) {
+		bytes += r.bytes;
+	}
+	CHECK_EQ(bytes, t.total_bytes<false>());
+	CHECK_GE(resources[0].bytes.load(), t.num_bytes());
+}
+
+TEST_CASE("Other trees")
+{
+	SUBCASE("Compact tree with metadata")
+	{
+		classtree::compact_ctree<int, int, int, int> t;
+		for (int i = 0; i < 1000; ++i) {
+			t.add({i % 300, 1}, i % 7, i % 3);
+		}
+		const auto c = t.clone({});
+		CHECK_EQ(c.size(), t.size());
+		CHECK_EQ(c.total_capacity_bytes<false>(), t.total_bytes<false>());
+
+		auto it = t.get_const_iterator_begin();
+		auto jt = c.get_const_iterator_begin();
+		while (not it.end()) {
+			CHECK_EQ((*it).data, (*jt).data);
+			CHECK_EQ((*it).metadata, (*jt).metadata);
+			++it;
+			++jt;
+		}
+		CHECK(jt.end());
+
+		const auto d = t.clone_parallel(2);
+		CHECK_EQ(d.size(), t.size());
+	}
+
+	SUBCASE("Leaf")
+	{
+		classtree::ctree<std::string, void> t;
+		for (int i = 0; i < 10; ++i) {
+			t.add<false>(std::to_string(i));
+		}
+		counting_resource resource;
+		const auto c = t.clone(&resource);
+		CHECK_EQ(contents(c), contents(t));
+		CHECK_EQ(c.capacity(), 10);
+		CHECK_EQ(resource.bytes.load(), c.num_bytes());
+		CHECK_EQ(contents(t.clone_parallel(3)), contents(t));
+	}
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,312 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+
+// ctree includes
+#include <ctree/compact_vector.hpp>
+#include <ctree/ctree.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/range_iterator.hpp>
+
+// custom includes
+#include "definitions.hpp"
+#include "functions.hpp"
+
+template <typename T>
+using cvector = classtree::compact_vector<T, classtree::compact_allocator<T>>;
+
+TEST_CASE("Compact vector")
+{
+	static_assert(sizeof(cvector<int>) == 16);
+	static_assert(alignof(cvector<int>) == 4);
+	static_assert(std::is_nothrow_move_constructible_v<cvector<std::string>>);
+
+	SUBCASE("Insert")
+	{
+		cvector<std::string> v;
+		CHECK(v.empty());
+		CHECK_EQ(v.capacity(), 0);
+
+		v.emplace_back("b");
+		v.emplace_back("d");
+		v.insert(v.begin(), "a");
+		v.insert(v.begin() + 2, "c");
+		v.insert(v.end(), "e");
+		CHECK_EQ(v.size(), 5);
+		CHECK_EQ(v.capacity(), 8);
+		CHECK_EQ(v.front(), "a");
+		CHECK_EQ(v[1], "b");
+		CHECK_EQ(v[2], "c");
+		CHECK_EQ(v[3], "d");
+		CHECK_EQ(v.back(), "e");
+
+		v.insert(v.begin() + 1, "ab");
+		CHECK_EQ(v.size(), 6);
+		CHECK_EQ(v[0], "a");
+		CHECK_EQ(v[1], "ab");
+		CHECK_EQ(v[2], "b");
+		CHECK_EQ(v.back(), "e");
+	}
+
+	SUBCASE("Resize")
+	{
+		cvector<std::string> v;
+		v.reserve(10);
+		CHECK_EQ(v.capacity(), 10);
+		CHECK(v.empty());
+
+		v.resize(3);
+		CHECK_EQ(v.size(), 3);
+		CHECK_EQ(v[2], "");
+
+		v.resize(1);
+		CHECK_EQ(v.size(), 1);
+		CHECK_EQ(v.capacity(), 10);
+
+		v.clear();
+		CHECK(v.empty());
+		CHECK_EQ(v.capacity(), 10);
+	}
+
+	SUBCASE("Copy and move")
+	{
+		cvector<std::string> v;
+		v.emplace_back("a");
+		v.emplace_back("b");
+
+		cvector<std::string> w = v;
+		CHECK_EQ(w.size(), 2);
+		CHECK_EQ(w[0], "a");
+		CHECK_EQ(w[1], "b");
+		CHECK_NE(w.data(), v.data());
+
+		const std::string *p = v.data();
+		cvector<std::string> x = std::move(v);
+		CHECK_EQ(x.data(), p);
+		CHECK(v.empty());
+
+		w = std::move(x);
+		CHECK_EQ(w.data(), p);
+		CHECK_EQ(w.size(), 2);
+
+		x = w;
+		CHECK_EQ(x.size(), 2);
+		CHECK_EQ(x[1], "b");
+	}
+}
+
+TEST_CASE("Relocation")
+{
+	static_assert(classtree::is_trivially_relocatable_v<int>);
+	static_assert(classtree::is_trivially_relocatable_v<std::pair<int, char>>);
+	static_assert(not classtree::is_trivially_relocatable_v<std::string>);
+	static_assert(classtree::is_trivially_relocatable_v<
+				  std::pair<int, classtree::ctree<data_lt, meta_incr, int>>>);
+	static_assert(classtree::is_trivially_relocatable_v<
+				  classtree::compact_ctree<std::string, void, int>>);
+	static_assert(not classtree::is_trivially_relocatable_v<
+				  std::pair<std::string, classtree::ctree<int, void>>>);
+
+	SUBCASE("Insert")
+	{
+		cvector<std::pair<int, cvector<int>>> v;
+		for (int i = 0; i < 10; ++i) {
+			cvector<int> w;
+			w.emplace_back(2 * i);
+			v.insert(v.begin(), {2 * i, std::move(w)});
+		}
+		cvector<int> w;
+		w.emplace_back(7);
+		v.insert(v.begin() + 3, {7, std::move(w)});
+
+		CHECK_EQ(v.size(), 11);
+		CHECK_EQ(v[0].first, 18);
+		CHECK_EQ(v[2].first, 14);
+		CHECK_EQ(v[3].first, 7);
+		CHECK_EQ(v[4].first, 12);
+		CHECK_EQ(v.back().first, 0);
+		for (const auto& [k, u] : v) {
+			CHECK_EQ(u.size(), 1);
+			CHECK_EQ(u[0], k);
+		}
+	}
+
+	SUBCASE("Erase")
+	{
+		cvector<std::pair<int, cvector<int>>> v;
+		cvector<std::string> s;
+		for (int i = 0; i < 6; ++i) {
+			cvector<int> w;
+			w.emplace_back(i);
+			v.emplace_back(i, std::move(w));
+			s.emplace_back(
+				"a string longer than small buffers " + std::to_string(i)
+			);
+		}
+		v.erase(v.begin() + 2);
+		v.erase(v.end() - 1);
+		s.erase(s.begin() + 2);
+		s.erase(s.begin());
+		REQUIRE_EQ(v.size(), 4);
+		REQUIRE_EQ(s.size(), 4);
+		const int expected[] = {0, 1, 3, 4};
+		for (std::size_t i = 0; i < 4; ++i) {
+			CHECK_EQ(v[i].first, expected[i]);
+			CHECK_EQ(v[i].second[0], expected[i]);
+		}
+		CHECK_EQ(s[0], "a string longer than small buffers 1");
+		CHECK_EQ(s[3], "a string longer than small buffers 5");
+
+		s.erase(s.begin() + 1, s.begin() + 3);
+		v.erase(v.begin(), v.begin());
+		REQUIRE_EQ(s.size(), 2);
+		REQUIRE_EQ(v.size(), 4);
+		CHECK_EQ(s[0], "a string longer than small buffers 1");
+		CHECK_EQ(s[1], "a string longer than small buffers 5");
+		v.erase(v.begin() + 1, v.end());
+		REQUIRE_EQ(v.size(), 1);
+		CHECK_EQ(v[0].second[0], 0);
+	}
+
+	SUBCASE("Move between memory resources")
+	{
+		std::pmr::monotonic_buffer_resource r1, r2;
+		classtree::compact_vector<int, std::pmr::polymorphic_allocator<int>> v(
+			&r1
+		);
+		classtree::compact_vector<int, std::pmr::polymorphic_allocator<int>> w(
+			&r2
+		);
+		v.emplace_back(1);
+		v.emplace_back(2);
+		w = std::move(v);
+		CHECK_EQ(w.get_allocator().resource(), &r2);
+		CHECK_EQ(w.size(), 2);
+		CHECK_EQ(w[0], 1);
+		CHECK_EQ(w[1], 2);
+		CHECK(v.empty());
+	}
+	SUBCASE("Throwing constructors")
+	{
+		// moving an element that fails throws
+		struct thrower {
+			int value;
+			bool fail;
+			thrower(const int v, const bool f) : value(v), fail(f) { }
+			thrower(thrower&& t) : value(t.value), fail(t.fail)
+			{
+				if (fail) {
+					throw std::runtime_error("thrower");
+				}
+			}
+				thrower& operator= (thrower&&) = default;
+		};
+		using thrower_vector = classtree::
+			compact_vector<thrower, std::pmr::polymorphic_allocator<thrower>>;
+
+		counting_resource r;
+		{
+			thrower_vector v(&r);
+			v.emplace_back(1, false);
+			const std::size_t bytes = r.bytes.load();
+
+			int thrown = 0;
+			try {
+				v.emplace_back(thrower(2, true));
+			}
+			catch (const std::runtime_error&) {
+				++thrown;
+			}
+			try {
+				v.insert(v.begin(), thrower(3, true));
+			}
+			catch (const std::runtime_error&) {
+				++thrown;
+			}
+			CHECK_EQ(thrown, 2);
+			REQUIRE_EQ(v.size(), 1);
+			CHECK_EQ(v[0].value, 1);
+			// the memory of the failed growths was freed
+			CHECK_EQ(r.bytes.load(), bytes);
+		}
+		CHECK_EQ(r.bytes.load(), 0);
+	}
+}
+
+TEST_CASE("Compact tree")
+{
+	typedef classtree::compact_ctree<data_lt, meta_incr, int, int> my_tree;
+	static_assert(std::is_nothrow_move_constructible_v<my_tree>);
+	static_assert(std::is_same_v<my_tree::size_type, std::uint32_t>);
+
+	my_tree kd;
+	kd.add({{.i = 1, .j = 1, .k = 1, .z = 2}, {.num_occs = 1}}, 1, 2);
+	kd.add({{.i = 1, .j = 1, .k = 1, .z = 1}, {.num_occs = 1}}, 1, 1);
+	kd.add({{.i = 1, .j = 2, .k = 1, .z = 1}, {.num_occs = 1}}, 1, 1);
+	kd.add({{.i = 2, .j = 2, .k = 2, .z = 1}, {.num_occs = 1}}, 2, 1);
+	kd.add({{.i = 1, .j = 1, .k = 1, .z = 2}, {.num_occs = 1}}, 1, 2); // *
+	kd.add({{.i = 0, .j = 2, .k = 2, .z = 2}, {.num_occs = 1}}, 0, 5);
+	CHECK_EQ(kd.size(), 5);
+	CHECK_EQ(kd.num_keys(), 3);
+
+	my_tree other;
+	other.add({{.i = 3, .j = 3, .k = 3, .z = 3}, {.num_occs = 1}}, 3, 3);
+	other.add({{.i = 1, .j = 1, .k = 1, .z = 1}, {.num_occs = 1}}, 1, 1);
+	CHECK_EQ(kd.merge(std::move(other)), 1);
+	CHECK_EQ(kd.size(), 6);
+
+	auto it = kd.get_const_iterator_begin();
+	CHECK_EQ(
+		iterate_string(it),
+		"Iterate:\n"
+		"    (0 2 2 2) {1}\n"
+		"    (1 1 1 1) {2}\n"
+		"    (1 2 1 1) {1}\n"
+		"    (1 1 1 2) {2}\n"
+		"    (2 2 2 1) {1}\n"
+		"    (3 3 3 3) {1}\n"
+	);
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
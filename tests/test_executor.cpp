@@ -0,0 +1,269 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <memory_resource>
+#include <stdexcept>
+#include <numeric>
+#include <sstream>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+
+// POSIX includes
+#include <unistd.h>
+
+// ctree includes
+#include <ctree/bulk_load.hpp>
+#include <ctree/ctree.hpp>
+#include <ctree/executor.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/memory_profile.hpp>
+#include <ctree/teardown.hpp>
+
+// custom includes
+#include "functions.hpp"
+
+static_assert(classtree::Executor<classtree::inline_executor>);
+static_assert(classtree::Executor<classtree::thread_executor>);
+static_assert(classtree::Executor<classtree::work_stealing_pool>);
+static_assert(not classtree::Executor<int>);
+
+typedef classtree::ctree<int, void, int, int, int> tree_t;
+
+/// A tree in which the first subtree of the root holds most elements.
+[[nodiscard]] static tree_t make_skewed_tree(const int n)
+{
+	tree_t t;
+	for (int i = 0; i < n; ++i) {
+		int value = i;
+		const int k1 = i % 10 == 0 ? 1 + i % 50 : 0;
+		t.add<false>(std::move(value), k1, i % 13, i % 7);
+	}
+	return t;
+}
+
+template <typename executor_t>
+static void check_bulk(executor_t& e, const std::size_t num_tasks)
+{
+	std::vector<std::atomic<int>> runs(num_tasks);
+	std::vector<std::atomic<bool>> busy(e.num_workers());
+	std::atomic<bool> ok{true};
+	e.bulk(
+		num_tasks,
+		[&](const std::size_t w, const std::size_t i)
+		{
+			if (w >= busy.size() or busy[w].exchange(true)) {
+				ok = false;
+				return;
+			}
+			++runs[i];
+			busy[w] = false;
+		}
+	);
+	CHECK(ok);
+	for (const auto& r : runs) {
+		CHECK_EQ(r.load(), 1);
+	}
+}
+
+/// The sum of [first, last), computed by splitting the range recursively.
+template <typename executor_t>
+[[nodiscard]] static std::size_t
+recursive_sum(executor_t& e, const std::size_t first, const std::size_t last)
+{
+	if (last - first <= 4) {
+		std::size_t s = 0;
+		for (std::size_t i = first; i < last; ++i) {
+			s += i;
+		}
+		return s;
+	}
+	const std::size_t mid = first + (last - first) / 2;
+	std::size_t sums[2];
+	e.bulk(
+		2,
+		[&](const std::size_t, const std::size_t i)
+		{
+			sums[i] = i == 0 ? recursive_sum(e, first, mid)
+							 : recursive_sum(e, mid, last);
+		}
+	);
+	return sums[0] + sums[1];
+}
+
+TEST_CASE("Executors")
+{
+	classtree::inline_executor seq;
+	classtree::thread_executor threads(4);
+	classtree::work_stealing_pool pool(4);
+
+	for (const std::size_t n : std::vector<std::size_t>{0, 1, 7, 1000}) {
+		check_bulk(seq, n);
+		check_bulk(threads, n);
+		check_bulk(pool, n);
+	}
+
+	const std::size_t expected = 999 * 1000 / 2;
+	CHECK_EQ(recursive_sum(seq, 0, 1000), expected);
+	CHECK_EQ(recursive_sum(threads, 0, 1000), expected);
+	CHECK_EQ(recursive_sum(pool, 0, 1000), expected);
+
+	// several threads use the same pool
+	{
+		std::vector<std::jthread> users;
+		std::atomic<std::size_t> total{0};
+		for (int u = 0; u < 3; ++u) {
+			users.emplace_back(
+				[&]() { total += recursive_sum(pool, 0, 1000); }
+			);
+		}
+		users.clear();
+		CHECK_EQ(total.load(), 3 * expected);
+	}
+
+	// exceptions are propagated, and the pool is still usable
+	std::atomic<std::size_t> count{0};
+	bool thrown = false;
+	try {
+		pool.bulk(
+			100,
+			[&](const std::size_t, const std::size_t i)
+			{
+				++count;
+				if (i == 3) {
+					throw std::runtime_error("task");
+				}
+			}
+		);
+	}
+	catch (const std::runtime_error&) {
+		thrown = true;
+	}
+	CHECK(thrown);
+	CHECK_LE(count.load(), 100);
+	check_bulk(pool, 100);
+}
+
+TEST_CASE("Parallel operations")
+{
+	const tree_t t = make_skewed_tree(20000);
+	REQUIRE(t.get_child(0).size() > t.size() / 2);
+
+	classtree::work_stealing_pool pool(4);
+	classtree::inline_executor seq;
+
+	SUBCASE("Clone")
+	{
+		const std::vector<std::pmr::polymorphic_allocator<std::byte>> allocs(
+			4
+		);
+		const std::span<const std::pmr::polymorphic_allocator<std::byte>> s(
+			allocs
+		);
+		std::vector<tree_t> clones;
+		clones.push_back(t.clone_parallel(pool, s));
+		clones.push_back(t.clone_parallel(seq, s));
+		for (tree_t& c : clones) {
+			CHECK_EQ(contents(c), contents(t));
+			CHECK_EQ(c.size(), t.size());
+			CHECK_EQ(c.update_size(), t.size());
+			CHECK_EQ(c.total_capacity_bytes<false>(), t.total_bytes<false>());
+		}
+
+		// every worker needs an allocator
+		bool thrown = false;
+		try {
+			clones.push_back(t.clone_parallel(pool, s.first(2)));
+		}
+		catch (const std::invalid_argument&) {
+			thrown = true;
+		}
+		CHECK(thrown);
+	}
+
+	SUBCASE("Clear")
+	{
+		tree_t c = t.clone_parallel(4);
+		classtree::clear_parallel(c, pool);
+		CHECK_EQ(c.size(), 0);
+		CHECK_EQ(c.num_keys(), 0);
+	}
+
+	SUBCASE("Initialize")
+	{
+		std::stringstream ss;
+		classtree::output_profile<false>(t, ss);
+		std::size_t total_bytes;
+		ss >> total_bytes;
+
+		tree_t c;
+		const std::vector<std::pmr::polymorphic_allocator<std::byte>> allocs(
+			4
+		);
+		classtree::initialize_parallel(
+			c,
+			ss,
+			pool,
+			std::span<const std::pmr::polymorphic_allocator<std::byte>>(allocs)
+		);
+		CHECK_EQ(c.num_keys(), t.num_keys());
+		CHECK_EQ(c.size(), 0);
+		CHECK_EQ(c.total_capacity_bytes<false>(), t.total_bytes<false>());
+	}
+
+	SUBCASE("Load")
+	{
+		const std::string path =
+			"/tmp/ctree_test_executor_" + std::to_string(::getpid());
+		REQUIRE(classtree::save_binary(t, path));
+		tree_t c;
+		REQUIRE(classtree::load_binary<false>(c, path, pool).has_value());
+		CHECK_EQ(c.size(), t.size());
+		CHECK_EQ(c.update_size(), t.size());
+		CHECK_EQ(c.num_keys(), t.num_keys());
+		::unlink(path.c_str());
+	}
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,219 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <random>
+#include <vector>
+#include <array>
+#include <tuple>
+
+// ctree includes
+#include <ctree/frozen_ctree.hpp>
+#include <ctree/ctree.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/range_iterator.hpp>
+
+// custom includes
+#include "definitions.hpp"
+
+struct point {
+	int x, y;
+	[[nodiscard]] constexpr bool operator== (const point&) const noexcept =
+		default;
+	[[nodiscard]] constexpr bool operator< (const point& p) const noexcept
+	{
+		return x < p.x or (x == p.x and y < p.y);
+	}
+};
+
+static constexpr auto small =
+	classtree::make_frozen_ctree<int, void, int, char>({
+		{2, 'b', 20},
+		{1, 'a', 10},
+		{1, 'a', 5},
+		{1, 'c', 7},
+		{3, 'a', 1},
+	});
+
+[[nodiscard]] static constexpr int sum_small() noexcept
+{
+	int s = 0;
+	auto it = small.get_const_iterator_begin();
+	while (not it.end()) {
+		s += *it;
+		++it;
+	}
+	return s;
+}
+
+TEST_CASE("Compile time")
+{
+	static_assert(small.size() == 5);
+	static_assert(small.has_keys(1, 'a'));
+	static_assert(not small.has_keys(1, 'b'));
+	static_assert(small.leaf(1, 'a').size() == 2);
+	static_assert(small.leaf(1, 'a')[0].element == 5);
+	static_assert(*small.find(10, 1, 'a') == 10);
+	static_assert(small.find(10, 1, 'c') == nullptr);
+	static_assert(sum_small() == 43);
+	static_assert(
+		small
+			.get_const_range_iterator(
+				[](const int k) -> bool
+				{
+					return k <= 2;
+				},
+				[](const char c) -> bool
+				{
+					return c != 'c';
+				}
+			)
+			.count() == 3
+	);
+
+	static constexpr auto with_metadata =
+		classtree::make_frozen_ctree<point, meta_incr, int>({
+			{1, {{.x = 1, .y = 2}, {.num_occs = 3}}},
+			{0, {{.x = 2, .y = 2}, {.num_occs = 1}}},
+			{1, {{.x = 1, .y = 1}, {.num_occs = 2}}},
+		});
+	static_assert(with_metadata.entries()[0].element.metadata.num_occs == 1);
+	static_assert(with_metadata.entries()[1].element.metadata.num_occs == 2);
+	static_assert(with_metadata.entries()[2].element.metadata.num_occs == 3);
+	CHECK_EQ(
+		with_metadata.find({.x = 1, .y = 2}, 1)->metadata,
+		meta_incr{.num_occs = 3}
+	);
+}
+
+TEST_CASE("Same iteration as ctree")
+{
+	static constexpr std::size_t N = 2000;
+	typedef std::tuple<int, int, int, int> value_t;
+
+	std::mt19937 gen(1234);
+	std::uniform_int_distribution<int> k1(0, 30);
+	std::uniform_int_distribution<int> k2(0, 20);
+	std::uniform_int_distribution<int> k3(0, 10);
+
+	std::array<std::tuple<int, int, int, int>, N> input;
+	classtree::ctree<int, void, int, int, int> kd;
+	for (std::size_t i = 0; i < N; ++i) {
+		const int value = static_cast<int>(N - i);
+		input[i] = {k1(gen), k2(gen), k3(gen), value};
+		auto [a, b, c, v] = input[i];
+		kd.add(std::move(v), std::move(a), std::move(b), std::move(c));
+	}
+	const classtree::frozen_ctree<int, void, N, int, int, int> frozen(input);
+
+	const auto forward = [](auto it)
+	{
+		std::vector<value_t> v;
+		while (not it.end()) {
+			v.push_back(+it);
+			++it;
+		}
+		return v;
+	};
+	const auto backward = [](auto it)
+	{
+		std::vector<value_t> v;
+		while (not it.past_begin()) {
+			v.push_back(+it);
+			--it;
+		}
+		return v;
+	};
+
+	SUBCASE("Full iteration")
+	{
+		std::vector<value_t> expected;
+		auto it = kd.get_const_iterator_begin();
+		while (not it.end()) {
+			expected.push_back(+it);
+			++it;
+		}
+		CHECK_EQ(forward(frozen.get_const_iterator_begin()), expected);
+	}
+
+	SUBCASE("Range iteration")
+	{
+		const auto f1 = [](const int k) -> bool
+		{
+			return k % 3 != 0;
+		};
+		const auto f2 = [](const int k) -> bool
+		{
+			return 5 <= k and k <= 15;
+		};
+		const auto f3 = [](const int k) -> bool
+		{
+			return k != 7;
+		};
+
+		CHECK_EQ(
+			forward(frozen.get_const_range_iterator_begin(f1, f2, f3)),
+			forward(kd.get_const_range_iterator_begin(f1, f2, f3))
+		);
+		CHECK_EQ(
+			backward(frozen.get_const_range_iterator_end(f1, f2, f3)),
+			backward(kd.get_const_range_iterator_end(f1, f2, f3))
+		);
+		CHECK_EQ(
+			frozen.get_const_range_iterator(f1, f2, f3).count(),
+			kd.get_const_range_iterator(f1, f2, f3).count()
+		);
+	}
+
+	SUBCASE("Empty range")
+	{
+		const auto f = [](const int) -> bool
+		{
+			return false;
+		};
+		auto it = frozen.get_const_range_iterator_begin(f, f, f);
+		CHECK(it.end());
+		CHECK(it.past_begin());
+		CHECK_EQ(it.count(), 0);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,233 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <sstream>
+#include <limits>
+#include <vector>
+#include <tuple>
+
+// ctree includes
+#include <ctree/ctree.hpp>
+#include <ctree/growth_policy.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/memory_profile.hpp>
+
+typedef classtree::ctree<int, void, int, int> tree_t;
+
+/// Adds the elements of a tree with 50 x 3 x 5 elements.
+template <typename add_t>
+static void fill(const add_t& add)
+{
+	int v = 0;
+	for (int i = 0; i < 50; ++i) {
+		for (int j = 0; j < 3; ++j) {
+			for (int k = 0; k < 5; ++k) {
+				add(v++, (i * 17) % 50, (j * 2) % 3);
+			}
+		}
+	}
+}
+
+template <typename it_t>
+[[nodiscard]] static std::vector<std::tuple<int, int, int>> contents(it_t it)
+{
+	std::vector<std::tuple<int, int, int>> v;
+	while (not it.end()) {
+		v.push_back(+it);
+		++it;
+	}
+	return v;
+}
+
+TEST_CASE("Level growth")
+{
+	const classtree::level_growth doubling;
+	CHECK_EQ(doubling.next_capacity(0), 1);
+	CHECK_EQ(doubling.next_capacity(1), 2);
+	CHECK_EQ(doubling.next_capacity(8), 16);
+
+	const classtree::level_growth g{.initial = 3, .factor = 1.5};
+	CHECK_EQ(g.next_capacity(0), 3);
+	CHECK_EQ(g.next_capacity(1), 2);
+	CHECK_EQ(g.next_capacity(3), 5);
+	CHECK_EQ(g.next_capacity(4), 6);
+
+	const classtree::level_growth slow{.initial = 0, .factor = 1.01};
+	CHECK_EQ(slow.next_capacity(0), 1);
+	CHECK_EQ(slow.next_capacity(2), 3);
+
+	// the capacity saturates instead of overflowing
+	constexpr std::size_t max = std::numeric_limits<std::size_t>::max();
+	const classtree::level_growth fast{.initial = 1, .factor = 1e300};
+	CHECK_EQ(fast.next_capacity(2), max);
+	CHECK_EQ(doubling.next_capacity(max / 2 + 1), max);
+	CHECK_EQ(doubling.next_capacity(max), max);
+}
+
+TEST_CASE("Empty nodes")
+{
+	tree_t t;
+	CHECK(t.add_empty(1, 2, 3));
+	CHECK_EQ(t.size(), 1);
+
+	classtree::ctree<int, void> leaf;
+	CHECK(leaf.add_empty(4));
+	CHECK_EQ(leaf.size(), 1);
+}
+
+TEST_CASE("Learn and apply")
+{
+	tree_t t1;
+	fill(
+		[&](int v, int k1, int k2)
+		{
+			t1.add<false>(std::move(v), std::move(k1), std::move(k2));
+		}
+	);
+
+	const classtree::growth_policy policy = classtree::learn_growth_policy(t1);
+	REQUIRE_EQ(policy.levels.size(), 3);
+	CHECK_EQ(policy.levels[0].initial, 50);
+	CHECK_EQ(policy.levels[1].initial, 3);
+	CHECK_EQ(policy.levels[2].initial, 5);
+	for (const auto& l : policy.levels) {
+		CHECK_EQ(l.factor, 1.5);
+	}
+
+	tree_t t2;
+	fill(
+		[&](int v, int k1, int k2)
+		{
+			t2.add_with_policy<false>(
+				policy.levels, std::move(v), std::move(k1), std::move(k2)
+			);
+		}
+	);
+
+	CHECK_EQ(
+		contents(t2.get_const_iterator_begin()),
+		contents(t1.get_const_iterator_begin())
+	);
+
+	// every node was allocated exactly once
+	CHECK_EQ(t2.capacity(), t2.size());
+	CHECK_EQ(t2.num_capacity_bytes(), t2.num_bytes());
+	CHECK_EQ(t2.total_capacity_bytes<false>(), t2.total_bytes<false>());
+	CHECK_GT(t1.capacity(), t1.size());
+	CHECK_LT(
+		t2.total_capacity_bytes<false>(), t1.total_capacity_bytes<false>()
+	);
+}
+
+TEST_CASE("Partial policy")
+{
+	// only the root follows the policy
+	const classtree::growth_policy policy{{{.initial = 64, .factor = 2.0}}};
+
+	tree_t t;
+	fill(
+		[&](int v, int k1, int k2)
+		{
+			t.add_with_policy<false>(
+				policy.levels, std::move(v), std::move(k1), std::move(k2)
+			);
+		}
+	);
+	CHECK_EQ(t.size(), 750);
+	CHECK_EQ(t.num_keys(), 50);
+	CHECK_EQ(t.num_capacity_bytes(), t.num_bytes() / 50 * 64);
+	// the leaves doubled their capacity: 1, 2, 4, 8
+	CHECK_EQ(t.capacity(), 150 * 8);
+}
+
+TEST_CASE("Unique elements")
+{
+	const classtree::growth_policy policy{
+		{{.initial = 2, .factor = 1.5},
+		 {.initial = 2, .factor = 1.5},
+		 {.initial = 2, .factor = 1.5}}
+	};
+
+	tree_t t;
+	for (int r = 0; r < 3; ++r) {
+		for (int v = 0; v < 20; ++v) {
+			int value = v;
+			t.add_with_policy(policy.levels, std::move(value), v % 4, v % 3);
+		}
+	}
+	CHECK_EQ(t.size(), 20);
+}
+
+TEST_CASE("Persistence")
+{
+	const classtree::growth_policy policy{
+		{{.initial = 50, .factor = 1.5},
+		 {.initial = 3, .factor = 2.0},
+		 {.initial = 7, .factor = 1.25}}
+	};
+
+	std::stringstream ss;
+	classtree::output_growth_policy(policy, ss);
+
+	const auto read = classtree::input_growth_policy(ss);
+	REQUIRE(read.has_value());
+	REQUIRE_EQ(read->levels.size(), 3);
+	for (size_t l = 0; l < 3; ++l) {
+		CHECK_EQ(read->levels[l].initial, policy.levels[l].initial);
+		CHECK_EQ(read->levels[l].factor, policy.levels[l].factor);
+	}
+
+	std::stringstream bad("2 5 1.5 3");
+	CHECK_FALSE(classtree::input_growth_policy(bad).has_value());
+	std::stringstream shrink("1 5 0.5");
+	CHECK_FALSE(classtree::input_growth_policy(shrink).has_value());
+	std::stringstream huge("1000000000000000 5 1.5");
+	CHECK_FALSE(classtree::input_growth_policy(huge).has_value());
+	for (const char *const text :
+		 {"1 5 1e300", "1 5 nan", "1 5 inf", "1 1000000000000000 1.5"}) {
+		std::stringstream absurd(text);
+		CHECK_FALSE(classtree::input_growth_policy(absurd).has_value());
+	}
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,214 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <tuple>
+
+// ctree includes
+#include <ctree/ctree.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/memory_profile.hpp>
+
+typedef classtree::ctree<int, void, int, std::string, int> tree_t;
+
+[[nodiscard]] static tree_t make_tree(const int n)
+{
+	tree_t t;
+	for (int i = 0; i < n; ++i) {
+		int value = i;
+		t.add<false>(
+			std::move(value),
+			(i * 7) % 97,
+			"s" + std::to_string((i * 3) % 11),
+			(i * 13) % 5
+		);
+	}
+	return t;
+}
+
+[[nodiscard]] static std::string profile(const tree_t& t)
+{
+	std::stringstream ss;
+	classtree::output_profile<false>(t, ss);
+	return ss.str();
+}
+
+/// The keys of every node and the capacity of every leaf, in pre-order.
+[[nodiscard]] static std::string shape(const tree_t& t)
+{
+	std::stringstream ss;
+	classtree::detail::output_profile(t, ss);
+	for (const auto& [_1, c1] : t) {
+		for (const auto& [_2, c2] : c1) {
+			for (const auto& [_3, c3] : c2) {
+				ss << ' ' << c3.capacity();
+			}
+		}
+	}
+	return ss.str();
+}
+
+[[nodiscard]] static tree_t initialize_sequential(const std::string& text)
+{
+	tree_t t;
+	std::stringstream ss(text);
+	size_t total_bytes;
+	ss >> total_bytes;
+	classtree::initialize(t, ss);
+	return t;
+}
+
+TEST_CASE("Same shape as the sequential initialization")
+{
+	for (const int n : {0, 1, 10, 1000, 20000}) {
+		const std::string text = profile(make_tree(n));
+		const tree_t expected = initialize_sequential(text);
+
+		for (const size_t num_threads : std::vector<size_t>{1, 2, 4, 200}) {
+			tree_t t = make_tree(5);
+			std::stringstream ss(text);
+			size_t total_bytes;
+			ss >> total_bytes;
+			classtree::initialize_parallel(t, ss, num_threads);
+
+			CHECK_EQ(shape(t), shape(expected));
+			CHECK_EQ(
+				t.total_capacity_bytes<false>(),
+				expected.total_capacity_bytes<false>()
+			);
+			CHECK_EQ(t.size(), 0);
+		}
+	}
+}
+
+TEST_CASE("One memory resource per thread")
+{
+	const tree_t source = make_tree(5000);
+	const std::string text = profile(source);
+
+	std::vector<std::pmr::monotonic_buffer_resource> resources(4);
+	std::vector<std::pmr::polymorphic_allocator<std::byte>> allocs;
+	for (auto& r : resources) {
+		allocs.emplace_back(&r);
+	}
+
+	tree_t t;
+	std::stringstream ss(text);
+	size_t total_bytes;
+	ss >> total_bytes;
+	classtree::initialize_parallel(
+		t, ss, std::span<const std::pmr::polymorphic_allocator<std::byte>>(allocs)
+	);
+
+	// the tree is usable after the initialization
+	auto it = source.get_const_iterator_begin();
+	while (not it.end()) {
+		auto [value, k1, k2, k3] = +it;
+		t.add<false>(std::move(value), k1, k2, k3);
+		++it;
+	}
+	CHECK_EQ(t.size(), source.size());
+	CHECK_EQ(profile(t), profile(source));
+}
+
+TEST_CASE("Leaf")
+{
+	classtree::ctree<int, void> t;
+	std::stringstream ss("17 ");
+	classtree::initialize_parallel(t, ss, 4);
+	CHECK_EQ(t.capacity(), 17);
+	CHECK_EQ(t.size(), 0);
+}
+
+TEST_CASE("Stream after the profile")
+{
+	for (const int n : {0, 1000}) {
+		// two profiles one after the other
+		const std::string text =
+			profile(make_tree(n)) + " " + profile(make_tree(7));
+		const tree_t expected = initialize_sequential(text);
+
+		tree_t t;
+		std::stringstream ss(text);
+		size_t total_bytes;
+		ss >> total_bytes;
+		classtree::initialize_parallel(t, ss, 4);
+		CHECK_EQ(shape(t), shape(expected));
+
+		// the stream is left at the second profile
+		const std::string rest = profile(make_tree(7));
+		std::stringstream rest_ss(rest);
+		size_t rest_bytes;
+		rest_ss >> rest_bytes;
+		REQUIRE(ss >> total_bytes);
+		CHECK_EQ(total_bytes, rest_bytes);
+		classtree::initialize_parallel(t, ss, 4);
+		CHECK_EQ(shape(t), shape(initialize_sequential(rest)));
+	}
+}
+
+TEST_CASE("Malformed profile")
+{
+	for (const std::string text :
+		 {"",
+		  "x",
+		  "3 1 s1",
+		  "2 1 x",
+		  "99999999999999 1",
+		  // the profiles of the subtrees are cut short or have bad sizes
+		  "2 1 2 3",
+		  "1 1 99999999999999 a",
+		  "1 1 1 a 99999999999999",
+		  "1 1 1 a -1",
+		  "1 1 2 a"}) {
+		tree_t t = make_tree(5);
+		std::stringstream ss(text);
+		classtree::initialize_parallel(t, ss, 4);
+		CHECK_EQ(t.num_keys(), 0);
+		CHECK_EQ(t.size(), 0);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,324 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <stdexcept>
+#include <random>
+#include <vector>
+#include <tuple>
+
+// ctree includes
+#include <ctree/batch_predicate.hpp>
+#include <ctree/frozen_ctree.hpp>
+#include <ctree/ctree.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/range_iterator.hpp>
+
+// custom includes
+#include "definitions.hpp"
+
+typedef classtree::ctree<int, meta_incr, int, int> tree_t;
+typedef classtree::element_t<int, meta_incr> element_t;
+typedef std::tuple<int, int, int, int> value_t;
+
+[[nodiscard]] static value_t flatten(const std::tuple<element_t, int, int>& t)
+{
+	const auto& [e, k1, k2] = t;
+	return {e.data, e.metadata.num_occs, k1, k2};
+}
+
+[[nodiscard]] static tree_t make_tree()
+{
+	std::mt19937 gen(1234);
+	std::uniform_int_distribution<int> d(0, 999);
+
+	tree_t kd;
+	for (int i = 0; i < 20000; ++i) {
+		const int v = d(gen);
+		int value = v;
+		kd.add({std::move(value), {.num_occs = 1}}, v % 20, v % 7);
+	}
+	return kd;
+}
+
+template <typename it_t>
+[[nodiscard]] static std::vector<value_t> forward(it_t it)
+{
+	std::vector<value_t> v;
+	while (not it.end()) {
+		v.push_back(flatten(+it));
+		++it;
+	}
+	return v;
+}
+
+template <typename it_t>
+[[nodiscard]] static std::vector<value_t> backward(it_t it)
+{
+	std::vector<value_t> v;
+	while (not it.past_begin()) {
+		v.push_back(flatten(+it));
+		--it;
+	}
+	return v;
+}
+
+/// All the elements of the tree within the range, filtered by hand.
+template <typename F1, typename F2, typename E>
+[[nodiscard]] static std::vector<value_t>
+expected(const tree_t& kd, const F1& f1, const F2& f2, const E& e)
+{
+	std::vector<value_t> v;
+	auto it = kd.get_const_range_iterator_begin(f1, f2);
+	while (not it.end()) {
+		if (e(*it)) {
+			v.push_back(flatten(+it));
+		}
+		++it;
+	}
+	return v;
+}
+
+template <typename F1, typename F2, typename E, typename B>
+static void compare(
+	const tree_t& kd, const F1& f1, const F2& f2, const E& e, const B& b
+)
+{
+	const auto fwd = expected(kd, f1, f2, e);
+	const std::vector<value_t> bwd(fwd.rbegin(), fwd.rend());
+
+	CHECK_EQ(forward(kd.get_const_range_iterator_begin(f1, f2, e)), fwd);
+	CHECK_EQ(forward(kd.get_const_range_iterator_begin(f1, f2, b)), fwd);
+	CHECK_EQ(backward(kd.get_const_range_iterator_end(f1, f2, e)), bwd);
+	CHECK_EQ(backward(kd.get_const_range_iterator_end(f1, f2, b)), bwd);
+
+	auto it = kd.get_const_range_iterator(f1, f2, e);
+	CHECK_EQ(it.count(), fwd.size());
+	auto jt = kd.get_const_range_iterator(f1, f2, b);
+	CHECK_EQ(jt.count(), fwd.size());
+
+	if (fwd.size() < 2) {
+		return;
+	}
+
+	// move back and forth
+	auto kt = kd.get_const_range_iterator_begin(f1, f2, b);
+	++kt;
+	++kt;
+	--kt;
+	CHECK_EQ(flatten(+kt), fwd[1]);
+	--kt;
+	CHECK_EQ(flatten(+kt), fwd[0]);
+	CHECK(kt.begin());
+	--kt;
+	CHECK(kt.past_begin());
+	++kt;
+	CHECK_EQ(flatten(+kt), fwd[0]);
+}
+
+TEST_CASE("Predicates on the elements")
+{
+	const tree_t kd = make_tree();
+
+	const auto all = [](const int) -> bool
+	{
+		return true;
+	};
+	const auto even = [](const int k) -> bool
+	{
+		return k % 2 == 0;
+	};
+
+	for (const int t : {0, 15, 20, 25, 30, 1000}) {
+		const auto e = [t](const element_t& x) -> bool
+		{
+			return x.metadata.num_occs > t;
+		};
+		const auto b = classtree::batch(
+			[t](std::span<const element_t> xs, std::span<std::uint64_t> mask)
+			{
+				for (size_t i = 0; i < xs.size(); ++i) {
+					const bool in = xs[i].metadata.num_occs > t;
+					mask[i / 64] |= std::uint64_t{in} << (i % 64);
+				}
+			}
+		);
+		compare(kd, all, all, e, b);
+		compare(kd, even, all, e, b);
+		compare(kd, all, even, e, b);
+	}
+
+	SUBCASE("Data")
+	{
+		const auto e = [](const element_t& x) -> bool
+		{
+			return x.data % 3 == 0;
+		};
+		const auto b = classtree::batch(
+			[&](std::span<const element_t> xs, std::span<std::uint64_t> mask)
+			{
+				for (size_t i = 0; i < xs.size(); ++i) {
+					mask[i / 64] |= std::uint64_t{e(xs[i])} << (i % 64);
+				}
+			}
+		);
+		compare(kd, all, all, e, b);
+		compare(kd, even, even, e, b);
+	}
+}
+
+TEST_CASE("Leaf tree")
+{
+	classtree::ctree<int, void> kd;
+	for (int i = 0; i < 200; ++i) {
+		int value = i;
+		kd.add<false>(std::move(value));
+	}
+
+	const auto e = [](const int x) -> bool
+	{
+		return 50 <= x and x < 60;
+	};
+	auto it = kd.get_const_range_iterator_begin(e);
+	std::vector<int> v;
+	while (not it.end()) {
+		v.push_back(*it);
+		++it;
+	}
+	CHECK_EQ(v.size(), 10);
+	CHECK_EQ(kd.get_const_range_iterator(e).count(), 10);
+
+	// a constant iterator can count the elements of a batch predicate
+	const auto kt =
+		kd.get_const_range_iterator_begin(classtree::batch_between(50, 59));
+	CHECK_EQ(kt.count(), 10);
+	CHECK_EQ(*kt, 50);
+
+	// counting does not disturb the iteration, also in a leaf that is too
+	// large to be counted without allocating memory
+	for (int i = 200; i < 1000; ++i) {
+		int value = i;
+		kd.add<false>(std::move(value));
+	}
+	auto lt =
+		kd.get_const_range_iterator_begin(classtree::batch_between(50, 899));
+	++lt;
+	CHECK_EQ(lt.count(), 850);
+	v.clear();
+	while (not lt.end()) {
+		v.push_back(*lt);
+		++lt;
+	}
+	REQUIRE_EQ(v.size(), 849);
+	CHECK_EQ(v.front(), 51);
+	CHECK_EQ(v.back(), 899);
+
+	auto jt = kd.get_const_range_iterator_end(
+		[](const int x) -> bool
+		{
+			return x == 1000;
+		}
+	);
+	CHECK(jt.end());
+	CHECK(jt.past_begin());
+	// the exceptions of a predicate reach the caller
+	bool thrown = false;
+	try {
+		auto xt = kd.get_const_range_iterator_begin(
+			[](const int x) -> bool
+			{
+				if (x == 500) {
+					throw std::runtime_error("predicate");
+				}
+				return false;
+			}
+		);
+	}
+	catch (const std::runtime_error&) {
+		thrown = true;
+	}
+	CHECK(thrown);
+}
+
+TEST_CASE("Frozen tree")
+{
+	static constexpr auto table =
+		classtree::make_frozen_ctree<int, void, int, char>({
+			{2, 'b', 20},
+			{1, 'a', 10},
+			{1, 'a', 5},
+			{1, 'c', 7},
+			{3, 'a', 1},
+		});
+
+	const auto all_i = [](const int) -> bool
+	{
+		return true;
+	};
+	const auto all_c = [](const char) -> bool
+	{
+		return true;
+	};
+	const auto big = [](const int x) -> bool
+	{
+		return x >= 7;
+	};
+
+	auto it = table.get_const_range_iterator_begin(all_i, all_c, big);
+	std::vector<int> v;
+	while (not it.end()) {
+		v.push_back(*it);
+		++it;
+	}
+	CHECK_EQ(v, std::vector<int>{10, 7, 20});
+	CHECK_EQ(table.get_const_range_iterator(all_i, all_c, big).count(), 3);
+
+	auto jt = table.get_const_range_iterator_end(all_i, all_c, big);
+	v.clear();
+	while (not jt.past_begin()) {
+		v.push_back(*jt);
+		--jt;
+	}
+	CHECK_EQ(v, std::vector<int>{20, 7, 10});
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
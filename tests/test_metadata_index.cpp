@@ -0,0 +1,198 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <tuple>
+
+// ctree includes
+#include <ctree/ctree.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/metadata_index.hpp>
+
+struct occurrences {
+	std::size_t num_occs = 0;
+	occurrences& operator+= (const occurrences& m) noexcept
+	{
+		num_occs += m.num_occs;
+		return *this;
+	}
+};
+
+struct num_occs {
+	[[nodiscard]] std::size_t operator() (const occurrences& m) const noexcept
+	{
+		return m.num_occs;
+	}
+};
+
+typedef classtree::ctree<int, occurrences, int, std::string> tree_t;
+typedef classtree::indexed_ctree<tree_t, num_occs> indexed_t;
+typedef std::tuple<std::size_t, int, std::string, int> location_t;
+
+/// The locations of the elements of the index, sorted.
+template <typename range_t>
+[[nodiscard]] static std::vector<location_t> locations(const range_t& r)
+{
+	std::vector<location_t> v;
+	for (const auto& e : r) {
+		v.emplace_back(
+			e.value, std::get<0>(e.keys), std::get<1>(e.keys), e.data
+		);
+	}
+	std::sort(v.begin(), v.end());
+	return v;
+}
+
+/// The locations of the elements of the tree whose projection is in [lo, hi].
+[[nodiscard]] static std::vector<location_t>
+scan(const tree_t& t, const std::size_t lo, const std::size_t hi)
+{
+	std::vector<location_t> v;
+	auto it = t.get_const_iterator_begin();
+	while (not it.end()) {
+		const auto& [e, k1, k2] = +it;
+		if (lo <= e.metadata.num_occs and e.metadata.num_occs <= hi) {
+			v.emplace_back(e.metadata.num_occs, k1, k2, e.data);
+		}
+		++it;
+	}
+	std::sort(v.begin(), v.end());
+	return v;
+}
+
+static void check_index(const indexed_t& t)
+{
+	CHECK_EQ(t.index().size(), t.size());
+	for (std::size_t v = 0; v < 6; ++v) {
+		CHECK_EQ(locations(t.equal(v)), scan(t.tree(), v, v));
+		CHECK_EQ(t.count(v), scan(t.tree(), v, v).size());
+	}
+	CHECK_EQ(locations(t.between(2, 4)), scan(t.tree(), 2, 4));
+	CHECK_EQ(locations(t.between(0, 1000)), scan(t.tree(), 0, 1000));
+
+	for (const auto& e : t.index()) {
+		const auto *x = t.find(e);
+		REQUIRE(x != nullptr);
+		CHECK_EQ(x->data, e.data);
+		CHECK_EQ(x->metadata.num_occs, e.value);
+	}
+}
+
+TEST_CASE("Add")
+{
+	std::mt19937 gen(1234);
+	std::uniform_int_distribution<int> data(0, 20);
+	std::uniform_int_distribution<int> k1(0, 10);
+	std::uniform_int_distribution<int> k2(0, 5);
+
+	indexed_t t;
+	tree_t plain;
+	for (int i = 0; i < 2000; ++i) {
+		const int d = data(gen);
+		const int a = k1(gen);
+		const std::string b = std::to_string(k2(gen));
+		CHECK_EQ(t.add({d, {1}}, a, b), plain.add({d, {1}}, a, b));
+	}
+	CHECK_EQ(t.size(), plain.size());
+	check_index(t);
+	CHECK_GT(t.count(1), 0);
+	CHECK_GT(t.count(2), 0);
+
+	// non-unique additions
+	t.add<false>({100, {1000}}, 1, "1");
+	t.add<false>({100, {1000}}, 1, "1");
+	CHECK_EQ(t.count(1000), 2);
+	const auto *x = t.find(100, 1, "1");
+	REQUIRE(x != nullptr);
+	CHECK_EQ(x->metadata.num_occs, 1000);
+	CHECK_EQ(t.find(101, 1, "1"), nullptr);
+	CHECK_EQ(t.find(100, 1, "100"), nullptr);
+
+	// the index of a tree
+	indexed_t u(std::move(plain));
+	check_index(u);
+}
+
+TEST_CASE("Merge")
+{
+	indexed_t t;
+	for (int i = 0; i < 300; ++i) {
+		t.add({i % 17, {1}}, i % 5, std::to_string(i % 3));
+	}
+
+	tree_t other;
+	for (int i = 0; i < 200; ++i) {
+		other.add({i % 23, {1}}, i % 7, std::to_string(i % 2));
+	}
+	tree_t expected;
+	for (int i = 0; i < 300; ++i) {
+		expected.add({i % 17, {1}}, i % 5, std::to_string(i % 3));
+	}
+	for (int i = 0; i < 200; ++i) {
+		expected.add({i % 23, {1}}, i % 7, std::to_string(i % 2));
+	}
+
+	const std::size_t before = t.size();
+	CHECK_EQ(t.merge(std::move(other)), expected.size() - before);
+	CHECK_EQ(t.size(), expected.size());
+	check_index(t);
+	CHECK_EQ(locations(t.between(0, 1000)), scan(expected, 0, 1000));
+}
+
+TEST_CASE("Rebuild and clear")
+{
+	indexed_t t;
+	for (int i = 0; i < 100; ++i) {
+		t.add({i % 10, {1}}, i % 3, "a");
+	}
+	t.rebuild();
+	check_index(t);
+
+	t.clear();
+	CHECK_EQ(t.size(), 0);
+	CHECK(t.index().empty());
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,183 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <cmath>
+#include <vector>
+#include <tuple>
+
+// ctree includes
+#include <ctree/ctree.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/nearest.hpp>
+
+typedef classtree::ctree<int, void, double, int, double> tree_t;
+
+[[nodiscard]] static tree_t make_tree()
+{
+	std::mt19937 gen(1234);
+	std::uniform_real_distribution<double> k1(0, 10);
+	std::uniform_int_distribution<int> k2(0, 20);
+	std::normal_distribution<double> k3(0, 5);
+
+	tree_t kd;
+	for (int i = 0; i < 5000; ++i) {
+		int value = i;
+		// round the real keys so that there are repeats
+		const double x = std::round(k1(gen) * 10) / 10;
+		const double z = std::round(k3(gen) * 4) / 4;
+		kd.add<false>(std::move(value), x, k2(gen), z);
+	}
+	return kd;
+}
+
+/// Weighted squared distance of a term of the query.
+[[nodiscard]] static double
+term(const double k, const classtree::target<double>& t) noexcept
+{
+	return t.weight * (k - t.value) * (k - t.value);
+}
+
+/// The distances of all the elements to the query, sorted.
+template <typename D>
+[[nodiscard]] static std::vector<double>
+brute_force(const tree_t& kd, const D& distance)
+{
+	std::vector<double> ds;
+	auto it = kd.get_const_iterator_begin();
+	while (not it.end()) {
+		const auto [_, x, y, z] = +it;
+		ds.push_back(distance(x, y, z));
+		++it;
+	}
+	std::sort(ds.begin(), ds.end());
+	return ds;
+}
+
+/// The keys of every element, indexed by the element.
+[[nodiscard]] static std::vector<std::tuple<double, int, double>>
+all_keys(const tree_t& kd)
+{
+	std::vector<std::tuple<double, int, double>> keys(kd.size());
+	auto it = kd.get_const_iterator_begin();
+	while (not it.end()) {
+		const auto [e, x, y, z] = +it;
+		keys[static_cast<std::size_t>(e)] = {x, y, z};
+		++it;
+	}
+	return keys;
+}
+
+template <typename D, typename... Specs>
+static void
+check(const tree_t& kd, const std::size_t k, const D& distance, Specs... s)
+{
+	const auto all = brute_force(kd, distance);
+	const auto keys = all_keys(kd);
+	const auto res = classtree::nearest(kd, k, s...);
+
+	REQUIRE_EQ(res.size(), std::min(k, all.size()));
+	for (std::size_t i = 0; i < res.size(); ++i) {
+		const auto& [x, y, z] = res[i].keys;
+		CHECK_EQ(res[i].distance, all[i]);
+		CHECK_EQ(res[i].distance, distance(x, y, z));
+
+		// the element is stored under its keys
+		REQUIRE(res[i].element != nullptr);
+		CHECK_EQ(keys[static_cast<std::size_t>(*res[i].element)], res[i].keys);
+	}
+}
+
+TEST_CASE("Nearest neighbours")
+{
+	const tree_t kd = make_tree();
+
+	for (const std::size_t k : std::vector<std::size_t>{
+			 0, 1, 5, 37, 200, 6000, std::numeric_limits<std::size_t>::max()
+		 }) {
+		for (const auto& [x, z] : std::vector<std::pair<double, double>>{
+				 {5.0, 0.0}, {0.0, -10.0}, {10.5, 3.3}, {-3.0, 20.0}
+			 }) {
+			const classtree::target<double> tx{x};
+			const classtree::target<double> tz{z, 0.25};
+
+			check(
+				kd,
+				k,
+				[&](double a, int, double c)
+				{
+					return term(a, tx) + term(c, tz);
+				},
+				tx,
+				classtree::any_key{},
+				tz
+			);
+			check(
+				kd,
+				k,
+				[&](double a, int, double)
+				{
+					return term(a, tx);
+				},
+				tx,
+				classtree::any_key{},
+				classtree::any_key{}
+			);
+			check(
+				kd,
+				k,
+				[&](double, int b, double c)
+				{
+					return term(b, {7, 2.0}) + term(c, tz);
+				},
+				classtree::any_key{},
+				classtree::target<int>{7, 2.0},
+				tz
+			);
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,256 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include <tuple>
+
+// ctree includes
+#include <ctree/ctree.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/packed_column.hpp>
+#include <ctree/packed_ctree.hpp>
+
+template <typename T>
+static void check_column(const std::vector<T>& values)
+{
+	const classtree::packed_column<T> c(values);
+	REQUIRE_EQ(c.size(), values.size());
+	for (std::size_t i = 0; i < values.size(); ++i) {
+		CHECK_EQ(c[i], values[i]);
+	}
+}
+
+TEST_CASE("Packed column")
+{
+	std::mt19937_64 gen(1234);
+
+	SUBCASE("Random values")
+	{
+		std::vector<std::uint64_t> u64(1000);
+		for (auto& v : u64) {
+			v = gen();
+		}
+		check_column(u64);
+
+		std::vector<std::int32_t> i32(1000);
+		std::uniform_int_distribution<std::int32_t> d32(-100000, 100000);
+		for (auto& v : i32) {
+			v = d32(gen);
+		}
+		check_column(i32);
+
+		std::vector<std::int8_t> i8;
+		for (int v = -128; v < 128; ++v) {
+			i8.push_back(static_cast<std::int8_t>(v));
+		}
+		check_column(i8);
+
+		check_column(std::vector<int>(200, 7));
+		check_column(std::vector<int>{});
+	}
+
+	SUBCASE("Lower bound in sorted ranges")
+	{
+		// sorted runs of different lengths, one after the other
+		std::vector<std::uint64_t> values;
+		std::vector<std::pair<std::size_t, std::size_t>> runs;
+		std::uniform_int_distribution<std::size_t> len(1, 300);
+		std::uniform_int_distribution<std::uint64_t> step(1, 1000);
+		for (int r = 0; r < 50; ++r) {
+			const std::size_t first = values.size();
+			std::uint64_t v = (std::uint64_t{1} << 40) + gen() % 100000;
+			for (std::size_t i = len(gen); i > 0; --i) {
+				values.push_back(v);
+				v += step(gen);
+			}
+			runs.emplace_back(first, values.size());
+		}
+
+		const classtree::packed_column<std::uint64_t> c(values);
+		for (const auto& [first, last] : runs) {
+			const auto b = values.begin();
+			for (std::size_t i = first; i < last; ++i) {
+				for (const std::uint64_t v :
+					 {values[i] - 1, values[i], values[i] + 1}) {
+					const auto expected = static_cast<std::size_t>(
+						std::lower_bound(
+							b + static_cast<std::ptrdiff_t>(first),
+							b + static_cast<std::ptrdiff_t>(last),
+							v
+						) -
+						b
+					);
+					CHECK_EQ(c.lower_bound(first, last, v), expected);
+				}
+			}
+			CHECK_EQ(c.lower_bound(first, last, 0), first);
+			CHECK_EQ(c.lower_bound(first, last, ~std::uint64_t{0}), last);
+		}
+
+		// the differences in a run take fewer bits than the values
+		CHECK_LT(c.bytes(), values.size() * sizeof(std::uint64_t) / 2);
+	}
+
+	SUBCASE("Signed values that span zero")
+	{
+		std::vector<int> mixed, positive;
+		for (int v = -32; v < 32; ++v) {
+			mixed.push_back(v);
+			positive.push_back(v + 32);
+		}
+		check_column(mixed);
+
+		// the differences take as many bits as for the same range of
+		// non-negative values
+		const classtree::packed_column<int> m(mixed);
+		const classtree::packed_column<int> p(positive);
+		CHECK_EQ(m.bytes(), p.bytes());
+
+		for (int v = -34; v < 34; ++v) {
+			const auto expected = static_cast<std::size_t>(
+				std::lower_bound(mixed.begin(), mixed.end(), v) - mixed.begin()
+			);
+			CHECK_EQ(m.lower_bound(0, mixed.size(), v), expected);
+		}
+
+		std::vector<std::int64_t> extremes{
+			std::numeric_limits<std::int64_t>::min(),
+			-1,
+			0,
+			std::numeric_limits<std::int64_t>::max()
+		};
+		check_column(extremes);
+	}
+}
+
+struct occurrences {
+	std::size_t num_occs = 0;
+	occurrences& operator+= (const occurrences& m) noexcept
+	{
+		num_occs += m.num_occs;
+		return *this;
+	}
+};
+
+typedef classtree::ctree<int, occurrences, std::uint64_t, std::string, int>
+	tree_t;
+typedef classtree::
+	packed_ctree<int, occurrences, std::uint64_t, std::string, int>
+		packed_t;
+typedef std::tuple<int, std::size_t, std::uint64_t, std::string, int>
+	entry_t;
+
+TEST_CASE("Packed tree")
+{
+	std::mt19937 gen(1234);
+	std::uniform_int_distribution<std::uint64_t> k1(0, 5000);
+	std::uniform_int_distribution<int> k2(0, 4);
+	std::uniform_int_distribution<int> k3(0, 20);
+	std::uniform_int_distribution<int> data(0, 30);
+
+	tree_t t;
+	for (int i = 0; i < 20000; ++i) {
+		t.add(
+			{data(gen), {1}},
+			(std::uint64_t{1} << 40) + k1(gen),
+			std::to_string(k2(gen)),
+			k3(gen)
+		);
+	}
+	const packed_t p(t);
+	CHECK_EQ(p.size(), t.size());
+
+	std::vector<entry_t> expected;
+	auto it = t.get_const_iterator_begin();
+	while (not it.end()) {
+		const auto& [e, a, b, c] = +it;
+		expected.emplace_back(e.data, e.metadata.num_occs, a, b, c);
+
+		const auto *x = p.find(e.data, a, b, c);
+		REQUIRE(x != nullptr);
+		CHECK_EQ(x->data, e.data);
+		CHECK_EQ(x->metadata.num_occs, e.metadata.num_occs);
+		CHECK(p.has_keys(a, b, c));
+		++it;
+	}
+
+	std::vector<entry_t> visited;
+	p.for_each(
+		[&](const auto& e,
+			const std::uint64_t a,
+			const std::string& b,
+			const int c)
+		{ visited.emplace_back(e.data, e.metadata.num_occs, a, b, c); }
+	);
+	CHECK_EQ(visited, expected);
+
+	for (std::size_t i = 0; i < t.num_keys(); ++i) {
+		const std::uint64_t a = t.get_key(i);
+		const auto& c1 = t.get_child(i);
+		for (std::size_t j = 0; j < c1.num_keys(); ++j) {
+			const std::string& b = c1.get_key(j);
+			const auto& c2 = c1.get_child(j);
+			for (std::size_t k = 0; k < c2.num_keys(); ++k) {
+				CHECK_EQ(
+					p.leaf(a, b, c2.get_key(k)).size(), c2.get_child(k).size()
+				);
+			}
+		}
+	}
+
+	CHECK_FALSE(p.has_keys(0, "0", 0));
+	CHECK_FALSE(p.has_keys((std::uint64_t{1} << 40) + 6000, "0", 0));
+	CHECK_FALSE(p.has_keys(t.get_key(0), "5", 0));
+	CHECK_FALSE(p.has_keys(t.get_key(0), "0", 21));
+	CHECK_EQ(p.find(31, t.get_key(0), "0", 0), nullptr);
+
+	const packed_t empty(tree_t{});
+	CHECK_EQ(empty.size(), 0);
+	CHECK_FALSE(empty.has_keys(0, "0", 0));
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,253 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <vector>
+#include <tuple>
+
+// POSIX includes
+#include <unistd.h>
+
+// ctree includes
+#include <ctree/bulk_load.hpp>
+#include <ctree/ctree.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/partition.hpp>
+
+// custom includes
+#include "functions.hpp"
+
+struct occurrences {
+	std::size_t num_occs = 0;
+	occurrences& operator+= (const occurrences& m) noexcept
+	{
+		num_occs += m.num_occs;
+		return *this;
+	}
+};
+
+typedef classtree::ctree<int, occurrences, int, std::string, int> tree_t;
+
+/// An element with its keys, as a tuple of comparable values.
+static constexpr auto flatten = [](const auto& e, const auto&...keys)
+{
+	if constexpr (requires { e.metadata; }) {
+		return std::tuple(e.data, e.metadata.num_occs, keys...);
+	}
+	else {
+		return std::tuple(e, keys...);
+	}
+};
+
+[[nodiscard]] static tree_t make_tree(const int n)
+{
+	std::mt19937 gen(1234);
+	std::uniform_int_distribution<int> k1(0, 30);
+	std::uniform_int_distribution<int> k2(0, 5);
+	std::uniform_int_distribution<int> k3(0, 10);
+	std::uniform_int_distribution<int> data(0, 20);
+	tree_t t;
+	for (int i = 0; i < n; ++i) {
+		t.add({data(gen), {1}}, k1(gen), std::to_string(k2(gen)), k3(gen));
+	}
+	return t;
+}
+
+/// The size of the largest leaf of a tree.
+[[nodiscard]] static std::size_t largest_leaf(const tree_t& t)
+{
+	std::size_t s = 0;
+	for (const auto& [_1, c1] : t) {
+		for (const auto& [_2, c2] : c1) {
+			for (const auto& [_3, c3] : c2) {
+				s = std::max(s, c3.size());
+			}
+		}
+	}
+	return s;
+}
+
+TEST_CASE("Partition and assemble")
+{
+	const tree_t original = make_tree(20000);
+	const auto expected = contents(original, flatten);
+	const std::size_t n = original.size();
+	const std::size_t max_leaf = largest_leaf(original);
+
+	for (const std::size_t p : std::vector<std::size_t>{1, 2, 3, 7, 50}) {
+		tree_t t = make_tree(20000);
+		std::vector<tree_t> pieces = classtree::partition(std::move(t), p);
+		CHECK_EQ(t.size(), 0);
+		REQUIRE_EQ(pieces.size(), p);
+
+		decltype(contents(original, flatten)) concatenation;
+		for (tree_t& piece : pieces) {
+			const std::size_t size = piece.size();
+			CHECK_EQ(piece.update_size(), size);
+			CHECK_LE(size, n / p + max_leaf);
+			CHECK_GE(size + max_leaf, n / p);
+
+			const auto c = contents(piece, flatten);
+			concatenation.insert(concatenation.end(), c.begin(), c.end());
+		}
+		CHECK(concatenation == expected);
+
+		tree_t whole = classtree::assemble(std::move(pieces));
+		CHECK_EQ(whole.size(), n);
+		CHECK_EQ(whole.update_size(), n);
+		CHECK_EQ(whole.num_keys(), original.num_keys());
+		CHECK(contents(whole, flatten) == expected);
+
+		// the tree is still usable
+		whole.add({1000, {1}}, 0, std::string("0"), 0);
+		CHECK_EQ(whole.size(), n + 1);
+	}
+}
+
+TEST_CASE("More pieces than leaves")
+{
+	classtree::ctree<int, void, int> t;
+	t.add(1, 1);
+	t.add(2, 1);
+	t.add(3, 2);
+	const auto expected = contents(t, flatten);
+
+	auto pieces = classtree::partition(std::move(t), 5);
+	REQUIRE_EQ(pieces.size(), 5);
+	std::size_t non_empty = 0;
+	for (const auto& piece : pieces) {
+		non_empty += piece.size() > 0;
+	}
+	CHECK_EQ(non_empty, 2);
+
+	const auto whole = classtree::assemble(std::move(pieces));
+	CHECK_EQ(whole.size(), 3);
+	CHECK(contents(whole, flatten) == expected);
+}
+
+TEST_CASE("Assemble trees with common prefixes")
+{
+	typedef classtree::ctree<int, void, int, std::string, int> small_t;
+	small_t a, b, c, expected;
+	a.add(1, 1, std::string("a"), 1);
+	a.add(2, 1, std::string("a"), 2);
+	b.add(3, 1, std::string("a"), 2);
+	b.add(4, 1, std::string("a"), 3);
+	b.add(5, 1, std::string("b"), 0);
+	c.add(6, 1, std::string("b"), 1);
+	c.add(7, 2, std::string("a"), 0);
+	for (const small_t *t : {&a, &b, &c}) {
+		for (const auto& e : contents(*t, flatten)) {
+			const auto& [d, k1, k2, k3] = e;
+			expected.add<false>(int(d), k1, k2, k3);
+		}
+	}
+
+	std::vector<small_t> trees;
+	trees.push_back(std::move(a));
+	trees.push_back(small_t{});
+	trees.push_back(std::move(b));
+	trees.push_back(std::move(c));
+	const small_t whole = classtree::assemble(std::move(trees));
+	CHECK_EQ(whole.size(), 7);
+	CHECK_EQ(whole.num_keys(), 2);
+	CHECK(contents(whole, flatten) == contents(expected, flatten));
+}
+
+TEST_CASE("Allocators")
+{
+	std::pmr::monotonic_buffer_resource resource;
+	tree_t t;
+	t.set_allocator(&resource);
+	std::mt19937 gen(987);
+	std::uniform_int_distribution<int> key(0, 20);
+	for (int i = 0; i < 2000; ++i) {
+		t.add({i, {1}}, key(gen), std::to_string(key(gen)), key(gen));
+	}
+	const auto expected = contents(t, flatten);
+
+	auto pieces = classtree::partition(std::move(t), 3);
+	for (const tree_t& piece : pieces) {
+		CHECK_EQ(piece.get_allocator().resource(), &resource);
+	}
+
+	const tree_t whole = classtree::assemble(std::move(pieces));
+	CHECK_EQ(whole.get_allocator().resource(), &resource);
+	CHECK(contents(whole, flatten) == expected);
+}
+
+TEST_CASE("Partition into files")
+{
+	typedef classtree::ctree<int, void, int, int> binary_t;
+	std::mt19937 gen(4321);
+	std::uniform_int_distribution<int> key(0, 100);
+	binary_t t;
+	for (int i = 0; i < 5000; ++i) {
+		t.add<false>(i, key(gen), key(gen));
+	}
+	const auto expected = contents(t, flatten);
+
+	std::vector<std::string> paths;
+	for (int i = 0; i < 4; ++i) {
+		paths.push_back(
+			"/tmp/ctree_test_partition_" + std::to_string(::getpid()) + "_" +
+			std::to_string(i)
+		);
+	}
+	REQUIRE(classtree::partition(std::move(t), std::span(paths)));
+
+	decltype(contents(t, flatten)) concatenation;
+	for (const std::string& path : paths) {
+		binary_t piece;
+		REQUIRE(classtree::load_binary<false>(piece, path).has_value());
+		CHECK_GT(piece.size(), 0);
+		const auto c = contents(piece, flatten);
+		concatenation.insert(concatenation.end(), c.begin(), c.end());
+		::unlink(path.c_str());
+	}
+	CHECK(concatenation == expected);
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
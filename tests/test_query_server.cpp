@@ -0,0 +1,321 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <tuple>
+
+// POSIX includes
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// ctree includes
+#include <ctree/ctree.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/query_client.hpp>
+#include <ctree/query_server.hpp>
+
+typedef classtree::ctree<int, void, int, int> tree_t;
+typedef classtree::query_client<tree_t> client_t;
+
+[[nodiscard]] static std::string socket_path()
+{
+	return "/tmp/ctree_test_query_server_" + std::to_string(::getpid()) +
+		   ".sock";
+}
+
+[[nodiscard]] static tree_t make_tree()
+{
+	tree_t t;
+	for (int i = 0; i < 1000; ++i) {
+		int value = i;
+		t.add(std::move(value), i % 37, i % 11);
+	}
+	return t;
+}
+
+/// Number of elements of @e t with keys in the given intervals.
+[[nodiscard]] static std::uint64_t
+count(const tree_t& t, const int lo1, const int hi1, const int lo2, const int hi2)
+{
+	std::uint64_t c = 0;
+	auto it = t.get_const_iterator_begin();
+	while (not it.end()) {
+		const auto [_, k1, k2] = +it;
+		c += lo1 <= k1 and k1 <= hi1 and lo2 <= k2 and k2 <= hi2;
+		++it;
+	}
+	return c;
+}
+
+TEST_CASE("Requests")
+{
+	const tree_t expected = make_tree();
+	classtree::query_server<tree_t> server(make_tree());
+	REQUIRE(server.start(socket_path(), 2));
+	CHECK_FALSE(server.start(socket_path(), 2));
+
+	client_t client;
+	REQUIRE(client.connect(socket_path()));
+
+	SUBCASE("Find and count")
+	{
+		std::vector<std::uint64_t> answers;
+		for (int k1 = 40; k1 >= -1; --k1) {
+			for (int k2 = 0; k2 < 12; ++k2) {
+				client.count(k1, k2);
+				answers.push_back(count(expected, k1, k1, k2, k2));
+				client.find(k1 + 37 * k2, k1, k2);
+				answers.push_back(
+					(k1 + 37 * k2) % 37 == k1 and (k1 + 37 * k2) % 11 == k2 and
+					k1 >= 0 and k1 + 37 * k2 < 1000
+				);
+			}
+		}
+		CHECK_EQ(client.num_requests(), answers.size());
+		const auto results = client.execute();
+		REQUIRE(results.has_value());
+		CHECK_EQ(*results, answers);
+		CHECK_EQ(client.num_requests(), 0);
+	}
+
+	SUBCASE("Ranges")
+	{
+		const std::vector<std::tuple<int, int, int, int>> intervals{
+			{0, 36, 0, 10}, {5, 5, 0, 10}, {3, 9, 2, 4}, {30, 100, -5, 0}, {9, 3, 0, 10}
+		};
+		for (const auto& [lo1, hi1, lo2, hi2] : intervals) {
+			client.range({lo1, hi1}, {lo2, hi2});
+		}
+		const auto results = client.execute();
+		REQUIRE(results.has_value());
+		REQUIRE_EQ(results->size(), intervals.size());
+		for (std::size_t i = 0; i < intervals.size(); ++i) {
+			const auto& [lo1, hi1, lo2, hi2] = intervals[i];
+			CHECK_EQ((*results)[i], count(expected, lo1, hi1, lo2, hi2));
+		}
+	}
+
+	SUBCASE("Add")
+	{
+		client.count(3, 4);
+		client.add(5000, 3, 4);
+		client.add(5000, 3, 4);
+		client.find(5000, 3, 4);
+		client.count(3, 4);
+		const auto results = client.execute();
+		REQUIRE(results.has_value());
+		const std::uint64_t c = count(expected, 3, 3, 4, 4);
+		CHECK_EQ(*results, std::vector<std::uint64_t>{c, 1, 0, 1, c + 1});
+
+		server.stop();
+		CHECK_EQ(server.tree().size(), expected.size() + 1);
+	}
+
+	SUBCASE("Empty batch")
+	{
+		const auto results = client.execute();
+		REQUIRE(results.has_value());
+		CHECK(results->empty());
+	}
+
+	SUBCASE("Stop")
+	{
+		server.stop();
+		CHECK_FALSE(server.running());
+		client.count(1, 1);
+		CHECK_FALSE(client.execute().has_value());
+		CHECK_FALSE(client.connect(socket_path()));
+	}
+}
+
+TEST_CASE("Concurrent clients")
+{
+	classtree::query_server<tree_t, false> server;
+	REQUIRE(server.start(socket_path(), 4));
+
+	std::vector<std::thread> threads;
+	std::vector<int> ok(8, 0);
+	for (int c = 0; c < 8; ++c) {
+		threads.emplace_back(
+			[&, c]()
+			{
+				client_t client;
+				if (not client.connect(socket_path())) {
+					return;
+				}
+				bool all = true;
+				for (int b = 0; b < 50; ++b) {
+					for (int i = 0; i < 10; ++i) {
+						client.add(c * 1000 + b * 10 + i, c, i);
+						client.count(c, i);
+					}
+					const auto results = client.execute();
+					all = all and results.has_value();
+					const auto expected = static_cast<std::uint64_t>(b + 1);
+					for (std::size_t i = 0; all and i < 10; ++i) {
+						all = (*results)[2 * i] == 1 and
+							  (*results)[2 * i + 1] == expected;
+					}
+				}
+				ok[static_cast<std::size_t>(c)] = all;
+			}
+		);
+	}
+	for (auto& t : threads) {
+		t.join();
+	}
+	CHECK_EQ(std::count(ok.begin(), ok.end(), 1), 8);
+
+	server.stop();
+	CHECK_EQ(server.tree().size(), 8 * 50 * 10);
+}
+
+/// Connects to the server without a @ref classtree::query_client.
+[[nodiscard]] static int raw_connect()
+{
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	std::strcpy(address.sun_path, socket_path().c_str());
+	const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	REQUIRE(fd >= 0);
+	REQUIRE_EQ(
+		::connect(
+			fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)
+		),
+		0
+	);
+	return fd;
+}
+
+TEST_CASE("Stalled clients")
+{
+	classtree::query_server<tree_t> idle;
+	CHECK_FALSE(idle.start(socket_path(), 0));
+	CHECK_FALSE(idle.running());
+
+	classtree::query_server<tree_t> server(make_tree());
+	REQUIRE(server.start(socket_path(), 1, std::chrono::milliseconds(100)));
+
+	// a client that announces a large frame and sends nothing else
+	const int fd = raw_connect();
+	const std::uint32_t size = 1u << 29;
+	REQUIRE_EQ(::write(fd, &size, sizeof(size)), sizeof(size));
+
+	// the only worker is released when the frame times out
+	client_t client;
+	REQUIRE(client.connect(socket_path()));
+	client.count(1, 1);
+	const auto results = client.execute();
+	REQUIRE(results.has_value());
+	CHECK_EQ((*results)[0], count(make_tree(), 1, 1, 1, 1));
+
+	// and the stalled connection is closed
+	char c;
+	CHECK_EQ(::read(fd, &c, 1), 0);
+	::close(fd);
+}
+
+TEST_CASE("Malformed batches")
+{
+	classtree::query_server<tree_t> server(make_tree());
+	REQUIRE(server.start(socket_path(), 1));
+
+	// more requests than the bytes of the batch can hold
+	const int fd = raw_connect();
+	std::vector<std::byte> batch;
+	classtree::detail::put(batch, std::uint32_t{64});
+	batch.resize(batch.size() + 64, std::byte{1});
+	REQUIRE(classtree::detail::write_frame(fd, batch));
+	char c;
+	CHECK_EQ(::read(fd, &c, 1), 0);
+	::close(fd);
+
+	client_t client;
+	REQUIRE(client.connect(socket_path()));
+	client.count(1, 1);
+	const auto results = client.execute();
+	REQUIRE(results.has_value());
+	CHECK_EQ((*results)[0], count(make_tree(), 1, 1, 1, 1));
+}
+
+TEST_CASE("Trickling clients")
+{
+	classtree::query_server<tree_t> server(make_tree());
+	REQUIRE(server.start(socket_path(), 1, std::chrono::milliseconds(100)));
+
+	// a client that sends one byte of a large frame every 20 milliseconds,
+	// more often than the timeout, and stops when the server closes it
+	const int fd = raw_connect();
+	const std::uint32_t size = 1u << 29;
+	REQUIRE_EQ(::write(fd, &size, sizeof(size)), sizeof(size));
+	bool closed = false;
+	std::thread trickle(
+		[&]()
+		{
+			const char c = 0;
+			for (int i = 0; i < 100 and not closed; ++i) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+				closed = ::send(fd, &c, 1, MSG_NOSIGNAL) != 1;
+			}
+		}
+	);
+
+	// the only worker is released when the frame times out
+	client_t client;
+	REQUIRE(client.connect(socket_path()));
+	client.count(1, 1);
+	const auto results = client.execute();
+	REQUIRE(results.has_value());
+	CHECK_EQ((*results)[0], count(make_tree(), 1, 1, 1, 1));
+
+	trickle.join();
+	CHECK(closed);
+	::close(fd);
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -26,6 +26,8 @@
 // C++ includes
 #include <doctest/doctest.h>
 #include <print>
+#include <tuple>
+#include <vector>
 
 // ctree includes
 #include <ctree/search.hpp>
@@ -370,6 +372,34 @@ TEST_CASE("Large vector")
 	}
 }
 
+TEST_CASE("Find in a subtree")
+{
+	typedef classtree::element_t<int, int> elem_t;
+	typedef std::pmr::vector<elem_t> leaf_t;
+	std::pmr::vector<std::pair<int, std::pmr::vector<std::pair<char, leaf_t>>>>
+		node{
+			{1, {{'a', {{2, 20}, {4, 40}}}, {'c', {{1, 10}}}}},
+			{3, {{'b', {{5, 50}, {7, 70}, {9, 90}}}}},
+		};
+	const auto find = [&](const int d, const int k1, const char k2)
+	{ return classtree::detail::find_in<int, int>(node, d, k1, k2); };
+
+	for (const auto& [d, k1, k2] : std::vector<std::tuple<int, int, char>>{
+			 {2, 1, 'a'}, {4, 1, 'a'}, {1, 1, 'c'}, {7, 3, 'b'}, {9, 3, 'b'}
+		 }) {
+		const elem_t *const e = find(d, k1, k2);
+		REQUIRE(e != nullptr);
+		CHECK_EQ(e->data, d);
+		CHECK_EQ(e->metadata, 10 * d);
+	}
+
+	CHECK_EQ(find(3, 1, 'a'), nullptr);
+	CHECK_EQ(find(2, 1, 'b'), nullptr);
+	CHECK_EQ(find(2, 2, 'a'), nullptr);
+	CHECK_EQ(find(10, 3, 'b'), nullptr);
+	CHECK_EQ(find(5, 4, 'b'), nullptr);
+}
+
 int main(int argc, char **argv)
 {
 	doctest::Context context;
@@ -0,0 +1,195 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <random>
+#include <vector>
+#include <tuple>
+
+// ctree includes
+#include <ctree/ctree.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/memory_profile.hpp>
+
+typedef classtree::ctree<int, void, int, int, int> tree_t;
+typedef std::tuple<int, int, int> keys_t;
+
+/// A data set whose keys have very different fan-outs.
+[[nodiscard]] static std::vector<keys_t> make_keys(const std::size_t n)
+{
+	std::mt19937 gen(1234);
+	std::uniform_int_distribution<int> k1(0, 39);
+	std::uniform_int_distribution<int> k2(0, 4);
+	std::geometric_distribution<int> k3(0.05);
+
+	std::vector<keys_t> keys(n);
+	for (keys_t& k : keys) {
+		k = {k1(gen), k2(gen), k3(gen)};
+	}
+	return keys;
+}
+
+/// The number of nodes of every level of a tree.
+[[nodiscard]] static std::vector<double> count_nodes(const tree_t& t)
+{
+	std::vector<double> nodes{1, 0, 0, 0};
+	for (const auto& [_1, c1] : t) {
+		nodes[1] += 1;
+		for (const auto& [_2, c2] : c1) {
+			nodes[2] += 1;
+			nodes[3] += static_cast<double>(c2.num_keys());
+		}
+	}
+	return nodes;
+}
+
+TEST_CASE("Exact estimate")
+{
+	const auto keys = make_keys(20000);
+
+	tree_t t;
+	int v = 0;
+	for (auto [a, b, c] : keys) {
+		t.add<false>(v++, std::move(a), std::move(b), std::move(c));
+	}
+
+	// the whole data set is the sample
+	const auto e = classtree::estimate_shape<tree_t>(keys, keys.size());
+	CHECK_EQ(e.num_elements, keys.size());
+	CHECK_EQ(e.num_nodes, count_nodes(t));
+	CHECK_EQ(e.num_bytes, t.total_bytes<false>());
+	CHECK_EQ(e.fan_out(0), 40);
+	CHECK_EQ(e.fan_out(1), 5);
+}
+
+TEST_CASE("Extrapolation")
+{
+	const auto keys = make_keys(200000);
+
+	tree_t t;
+	int v = 0;
+	for (auto [a, b, c] : keys) {
+		t.add<false>(v++, std::move(a), std::move(b), std::move(c));
+	}
+	const auto nodes = count_nodes(t);
+
+	// the first 1% of the data set
+	const std::vector<keys_t> sample(keys.begin(), keys.begin() + 2000);
+	const auto e = classtree::estimate_shape<tree_t>(sample, keys.size());
+
+	for (std::size_t l = 0; l < nodes.size(); ++l) {
+		CHECK_LE(std::abs(e.num_nodes[l] - nodes[l]), 0.2 * nodes[l]);
+	}
+	const auto bytes = static_cast<double>(t.total_bytes<false>());
+	CHECK_LE(std::abs(static_cast<double>(e.num_bytes) - bytes), 0.2 * bytes);
+}
+
+TEST_CASE("Pre-shaped ingest")
+{
+	const auto keys = make_keys(50000);
+	const std::vector<keys_t> sample(keys.begin(), keys.begin() + 500);
+	const auto e = classtree::estimate_shape<tree_t>(sample, keys.size());
+	const classtree::growth_policy policy = e.policy();
+
+	REQUIRE_EQ(policy.levels.size(), 4);
+	CHECK_EQ(policy.levels[0].initial, 40);
+	CHECK_EQ(policy.levels[1].initial, 5);
+
+	tree_t t1;
+	tree_t t2;
+	classtree::pre_shape(t2, e);
+	CHECK_EQ(t2.num_capacity_bytes(), t2.num_bytes() + 40 * sizeof(*t2.begin()));
+
+	int v = 0;
+	for (const auto& [a, b, c] : keys) {
+		int v1 = v;
+		int v2 = v;
+		t1.add<false>(std::move(v1), a, b, c);
+		t2.add_with_policy<false>(policy.levels, std::move(v2), a, b, c);
+		++v;
+	}
+
+	auto it1 = t1.get_const_iterator_begin();
+	auto it2 = t2.get_const_iterator_begin();
+	while (not it1.end() and not it2.end()) {
+		CHECK_EQ(+it1, +it2);
+		++it1;
+		++it2;
+	}
+	CHECK(it1.end());
+	CHECK(it2.end());
+
+	// the first two levels were allocated exactly once
+	CHECK_EQ(t2.num_capacity_bytes(), t2.num_bytes());
+	for (const auto& [_, c] : t2) {
+		CHECK_EQ(c.num_capacity_bytes(), c.num_bytes());
+	}
+}
+
+TEST_CASE("Empty sample")
+{
+	const auto e = classtree::estimate_shape<tree_t>(std::vector<keys_t>{}, 10);
+	CHECK_EQ(e.num_bytes, 0);
+	CHECK_EQ(e.num_nodes, std::vector<double>{0, 0, 0, 0});
+
+	tree_t t;
+	classtree::pre_shape(t, e);
+	CHECK_EQ(t.size(), 0);
+}
+
+TEST_CASE("Sample larger than the data set")
+{
+	const auto keys = make_keys(1000);
+
+	tree_t t;
+	int v = 0;
+	for (auto [a, b, c] : keys) {
+		t.add<false>(v++, std::move(a), std::move(b), std::move(c));
+	}
+
+	// the number of elements is too small: the prefixes of the sample
+	// are counted anyway
+	const auto e = classtree::estimate_shape<tree_t>(keys, 10);
+	CHECK_EQ(e.num_nodes, count_nodes(t));
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,181 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+// ctree includes
+#include <ctree/ctree.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/stable_ctree.hpp>
+
+struct occurrences {
+	std::size_t num_occs = 0;
+	occurrences& operator+= (const occurrences& m) noexcept
+	{
+		num_occs += m.num_occs;
+		return *this;
+	}
+};
+
+typedef classtree::ctree<int, occurrences, int, std::string> tree_t;
+typedef classtree::stable_ctree<tree_t> stable_t;
+
+TEST_CASE("Handles")
+{
+	std::mt19937 gen(1234);
+	std::uniform_int_distribution<int> data(0, 50);
+	std::uniform_int_distribution<int> k1(0, 10);
+	std::uniform_int_distribution<int> k2(0, 5);
+
+	stable_t t;
+	tree_t plain;
+	std::vector<std::pair<classtree::element_handle, int>> handles;
+	std::vector<const stable_t::leaf_element_t *> pointers;
+	for (int i = 0; i < 5000; ++i) {
+		const int d = data(gen);
+		const int a = k1(gen);
+		const std::string b = std::to_string(k2(gen));
+		const auto [h, added] = t.add({d, {1}}, a, b);
+		CHECK_EQ(added, plain.add({d, {1}}, a, b));
+		CHECK(t.valid(h));
+		CHECK_EQ(t.find(d, a, b), h);
+		if (added) {
+			handles.emplace_back(h, d);
+			pointers.push_back(t.get(h));
+		}
+	}
+	CHECK_EQ(t.size(), plain.size());
+	CHECK_EQ(t.tree().size(), plain.size());
+	CHECK_EQ(handles.size(), plain.size());
+
+	// the handles and the pointers to the elements survive the additions
+	for (std::size_t i = 0; i < handles.size(); ++i) {
+		const auto [h, d] = handles[i];
+		REQUIRE(t.get(h) != nullptr);
+		CHECK_EQ(t.get(h), pointers[i]);
+		CHECK_EQ(t[h].data, d);
+	}
+
+	// the metadata of the slab is that of the tree
+	auto it = plain.get_const_iterator_begin();
+	while (not it.end()) {
+		const auto& [e, a, b] = +it;
+		const classtree::element_handle h = t.find(e.data, a, b);
+		REQUIRE(t.valid(h));
+		CHECK_EQ(t[h].metadata.num_occs, e.metadata.num_occs);
+		++it;
+	}
+
+	// the leaves of the tree of handles
+	auto jt = t.tree().get_const_iterator_begin();
+	std::size_t n = 0;
+	while (not jt.end()) {
+		const auto& [e, a, b] = +jt;
+		CHECK_EQ(t[e.metadata].data, e.data);
+		CHECK_EQ(t.find(e.data, a, b), e.metadata);
+		++n;
+		++jt;
+	}
+	CHECK_EQ(n, t.size());
+
+	CHECK_FALSE(t.valid(t.find(100, 1, "1")));
+	CHECK_FALSE(t.valid(t.find(1, 1, "100")));
+}
+
+TEST_CASE("Non-unique additions")
+{
+	stable_t t;
+	const auto [h1, a1] = t.add<false>({7, {1}}, 1, "a");
+	const auto [h2, a2] = t.add<false>({7, {2}}, 1, "a");
+	CHECK(a1);
+	CHECK(a2);
+	CHECK_NE(h1, h2);
+	CHECK_EQ(t.size(), 2);
+	CHECK_EQ(t[h1].metadata.num_occs, 1);
+	CHECK_EQ(t[h2].metadata.num_occs, 2);
+
+	const auto [h3, a3] = t.add({7, {5}}, 1, "a");
+	CHECK_FALSE(a3);
+	CHECK(h3 == h1 or h3 == h2);
+	CHECK_EQ(t[h3].metadata.num_occs, h3 == h1 ? 6 : 7);
+}
+
+TEST_CASE("Without metadata")
+{
+	classtree::stable_ctree<classtree::ctree<int, void, int>> t;
+	std::vector<std::pair<classtree::element_handle, int>> handles;
+	for (int i = 0; i < 1000; ++i) {
+		const auto [h, added] = t.add(i % 97, i % 13);
+		if (added) {
+			handles.emplace_back(h, i % 13);
+		}
+		CHECK_EQ(t[h], i % 97);
+	}
+	CHECK_EQ(t.size(), handles.size());
+	CHECK_EQ(t.tree().size(), handles.size());
+	for (const auto& [h, k] : handles) {
+		CHECK_EQ(t.find(t[h], k), h);
+	}
+}
+
+TEST_CASE("Clear")
+{
+	stable_t t;
+	const auto [h, _] = t.add({1, {1}}, 1, "a");
+	CHECK(t.valid(h));
+	t.clear();
+	CHECK_EQ(t.size(), 0);
+	CHECK_FALSE(t.valid(h));
+	CHECK_EQ(t.get(h), nullptr);
+
+	// a handle with the same index of a new generation
+	const auto [g, added] = t.add({1, {1}}, 1, "a");
+	CHECK(added);
+	CHECK_EQ(g.index, h.index);
+	CHECK_NE(g, h);
+	CHECK_FALSE(t.valid(h));
+	CHECK(t.valid(g));
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,130 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <memory_resource>
+#include <vector>
+
+// ctree includes
+#include <ctree/ctree.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/teardown.hpp>
+
+// custom includes
+#include "functions.hpp"
+
+typedef classtree::ctree<int, void, int, int, int> tree_t;
+
+TEST_CASE("Parallel clear")
+{
+	counting_resource resource;
+	std::pmr::memory_resource *const previous =
+		std::pmr::set_default_resource(&resource);
+
+	for (const std::size_t num_threads : std::vector<std::size_t>{1, 3, 8, 100}) {
+		tree_t t;
+		fill_tree(t, 20000);
+		const std::size_t root_bytes = t.num_capacity_bytes();
+		CHECK_GT(resource.bytes.load(), root_bytes);
+
+		classtree::clear_parallel(t, num_threads);
+		CHECK_EQ(t.size(), 0);
+		CHECK_EQ(t.num_keys(), 0);
+		// only the memory of the root is kept
+		CHECK_EQ(resource.bytes.load(), root_bytes);
+
+		// the tree can be reused
+		tree_t expected;
+		fill_tree(expected, 100);
+		fill_tree(t, 100);
+		CHECK_EQ(contents(t), contents(expected));
+	}
+	CHECK_EQ(resource.bytes.load(), 0);
+
+	std::pmr::set_default_resource(previous);
+}
+
+TEST_CASE("Clear in the background")
+{
+	counting_resource resource;
+	std::pmr::memory_resource *const previous =
+		std::pmr::set_default_resource(&resource);
+
+	for (const std::size_t num_threads : std::vector<std::size_t>{1, 4}) {
+		tree_t t;
+		fill_tree(t, 20000);
+
+		std::future<void> done = classtree::clear_async(t, num_threads);
+		CHECK_EQ(t.size(), 0);
+		CHECK_EQ(t.num_keys(), 0);
+		CHECK_EQ(t.num_capacity_bytes(), 0);
+
+		// the tree can be used while the old nodes are freed
+		fill_tree(t, 100);
+		const std::size_t bytes = t.total_capacity_bytes<false>();
+
+		done.get();
+		CHECK_EQ(resource.bytes.load(), bytes);
+	}
+	CHECK_EQ(resource.bytes.load(), 0);
+
+	std::pmr::set_default_resource(previous);
+}
+
+TEST_CASE("Leaf")
+{
+	classtree::ctree<int, void> t;
+	for (int i = 0; i < 10; ++i) {
+		int value = i;
+		t.add<false>(std::move(value));
+	}
+	classtree::clear_parallel(t, 4);
+	CHECK_EQ(t.size(), 0);
+
+	for (int i = 0; i < 10; ++i) {
+		int value = i;
+		t.add<false>(std::move(value));
+	}
+	classtree::clear_async(t).get();
+	CHECK_EQ(t.size(), 0);
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,331 @@
+/**
+ * Tests for the Classification Tree
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+
+#define DOCTEST_CONFIG_IMPLEMENT
+
+// C++ includes
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <tuple>
+#include <span>
+
+// ctree includes
+#include <ctree/batch_predicate.hpp>
+#include <ctree/ctree.hpp>
+#include <ctree/executor.hpp>
+#include <ctree/iterator.hpp>
+#include <ctree/key_set.hpp>
+#include <ctree/transform.hpp>
+
+typedef classtree::ctree<int, int, int, int> tree_t;
+typedef classtree::element_t<int, int> element_t;
+typedef std::tuple<int, int, int, int> entry_t;
+
+[[nodiscard]] static tree_t make_tree()
+{
+	std::mt19937 gen(1234);
+	std::uniform_int_distribution<int> k1(0, 19);
+	std::uniform_int_distribution<int> k2(0, 9);
+	std::uniform_int_distribution<int> data(0, 99);
+
+	tree_t t;
+	for (int i = 0; i < 20000; ++i) {
+		t.add({data(gen), 1}, k1(gen), k2(gen));
+	}
+	return t;
+}
+
+/// The keys, data and metadata of the elements of the tree, in order.
+[[nodiscard]] static std::vector<entry_t> entries(const tree_t& t)
+{
+	std::vector<entry_t> v;
+	auto it = t.get_const_iterator_begin();
+	while (not it.end()) {
+		const auto& [e, a, b] = +it;
+		v.emplace_back(a, b, e.data, e.metadata);
+		++it;
+	}
+	return v;
+}
+
+/// Are the elements of every leaf sorted by data?
+[[nodiscard]] static bool sorted_leaves(const tree_t& t)
+{
+	for (const auto& [_, c] : t) {
+		for (const auto& [__, leaf] : c) {
+			const bool sorted = std::is_sorted(
+				leaf.begin(),
+				leaf.end(),
+				[](const element_t& x, const element_t& y)
+				{ return x.data < y.data; }
+			);
+			if (not sorted) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+TEST_CASE("Metadata")
+{
+	tree_t t = make_tree();
+	std::vector<entry_t> expected = entries(t);
+	classtree::work_stealing_pool pool(4);
+
+	SUBCASE("Whole tree")
+	{
+		const classtree::transform_stats s = classtree::transform_metadata(
+			t, pool, [](int& m) { m *= 3; }
+		);
+		for (auto& [a, b, d, m] : expected) {
+			m *= 3;
+		}
+		CHECK_EQ(s.num_elements, t.size());
+		CHECK_EQ(s.num_sorted_leaves, 0);
+		CHECK_EQ(entries(t), expected);
+	}
+
+	SUBCASE("Range of keys")
+	{
+		const auto f1 = [](const int a) { return a % 2 == 0; };
+		const auto f2 = classtree::batch_between(2, 5);
+		const classtree::transform_stats s = classtree::transform_metadata(
+			t, pool, [](int& m) { m += 100; }, f1, f2
+		);
+
+		std::size_t n = 0;
+		std::size_t num_leaves = 0;
+		for (std::size_t i = 0; i < expected.size(); ++i) {
+			auto& [a, b, d, m] = expected[i];
+			if (f1(a) and 2 <= b and b <= 5) {
+				m += 100;
+				++n;
+				if (i == 0 or std::get<0>(expected[i - 1]) != a or
+					std::get<1>(expected[i - 1]) != b) {
+					++num_leaves;
+				}
+			}
+		}
+		CHECK(n > 0);
+		CHECK_EQ(s.num_elements, n);
+		CHECK_EQ(s.num_leaves, num_leaves);
+		CHECK_EQ(entries(t), expected);
+	}
+
+	SUBCASE("Predicate over the elements")
+	{
+		const auto f1 = classtree::in_set({1, 4, 7, 8});
+		const auto any = [](const int) { return true; };
+		const auto small = [](const element_t& e) { return e.data < 30; };
+		const auto large = classtree::batch(
+			[](std::span<const element_t> es, std::span<std::uint64_t> mask)
+			{
+				for (std::size_t i = 0; i < es.size(); ++i) {
+					if (es[i].data >= 70) {
+						mask[i / 64] |= std::uint64_t{1} << (i % 64);
+					}
+				}
+			}
+		);
+		const classtree::transform_stats s1 = classtree::transform_metadata(
+			t, pool, [](int& m) { m = -m; }, f1, any, small
+		);
+		const classtree::transform_stats s2 = classtree::transform_metadata(
+			t, 2, [](int& m) { m = 1000; }, f1, any, large
+		);
+
+		std::size_t n1 = 0;
+		std::size_t n2 = 0;
+		for (auto& [a, b, d, m] : expected) {
+			if (a == 1 or a == 4 or a == 7 or a == 8) {
+				if (d < 30) {
+					m = -m;
+					++n1;
+				}
+				if (d >= 70) {
+					m = 1000;
+					++n2;
+				}
+			}
+		}
+		CHECK_EQ(s1.num_elements, n1);
+		CHECK_EQ(s2.num_elements, n2);
+		CHECK_EQ(entries(t), expected);
+	}
+}
+
+TEST_CASE("Data")
+{
+	tree_t t = make_tree();
+	std::vector<entry_t> expected = entries(t);
+
+	SUBCASE("Order preserved")
+	{
+		classtree::inline_executor e;
+		const classtree::transform_stats s =
+			classtree::transform_data(t, e, [](int& d) { d += 1000; });
+		for (auto& [a, b, d, m] : expected) {
+			d += 1000;
+		}
+		CHECK_EQ(s.num_elements, t.size());
+		CHECK_EQ(s.num_sorted_leaves, 0);
+		CHECK_EQ(entries(t), expected);
+	}
+
+	SUBCASE("Order restored")
+	{
+		const auto f1 = [](const int a) { return a < 5; };
+		const auto any = [](const int) { return true; };
+		const classtree::transform_stats s = classtree::transform_data(
+			t, 3, [](int& d) { d = -d; }, f1, any
+		);
+		for (auto& [a, b, d, m] : expected) {
+			if (a < 5) {
+				d = -d;
+			}
+		}
+		CHECK(s.num_sorted_leaves > 0);
+		CHECK(sorted_leaves(t));
+
+		std::vector<entry_t> result = entries(t);
+		CHECK_EQ(result.size(), expected.size());
+		std::sort(result.begin(), result.end());
+		std::sort(expected.begin(), expected.end());
+		CHECK_EQ(result, expected);
+	}
+
+	SUBCASE("Unique instances")
+	{
+		std::size_t sum = 0;
+		for (const auto& [a, b, d, m] : expected) {
+			sum += static_cast<std::size_t>(m);
+		}
+
+		classtree::work_stealing_pool pool(3);
+		const classtree::transform_stats s =
+			classtree::transform_data(t, pool, [](int& d) { d /= 10; });
+		CHECK(s.num_merged_elements > 0);
+		CHECK_EQ(s.num_elements, expected.size());
+		CHECK_EQ(t.size(), expected.size() - s.num_merged_elements);
+
+		// no repeats, and the metadata of the merged elements is kept
+		std::vector<entry_t> result = entries(t);
+		CHECK_EQ(result.size(), t.size());
+		std::size_t merged_sum = 0;
+		for (std::size_t i = 0; i < result.size(); ++i) {
+			merged_sum += static_cast<std::size_t>(std::get<3>(result[i]));
+			if (i > 0) {
+				const auto& [a, b, d, m] = result[i];
+				const auto& [pa, pb, pd, pm] = result[i - 1];
+				CHECK((a != pa or b != pb or pd < d));
+			}
+		}
+		CHECK_EQ(merged_sum, sum);
+
+		// adding an existing element does not add a repeat
+		const auto& [a, b, d, m] = result[0];
+		CHECK_FALSE(t.add({int(d), 1}, int(a), int(b)));
+	}
+
+	SUBCASE("Spans of elements")
+	{
+		const auto f1 = classtree::batch_between(3, 8);
+		const auto any = [](const int) { return true; };
+		const classtree::transform_stats s = classtree::transform_leaves(
+			t,
+			2,
+			[](const std::span<element_t> elems)
+			{
+				for (element_t& x : elems) {
+					x.metadata *= 2;
+					x.data = 99 - x.data;
+				}
+			},
+			f1,
+			any
+		);
+		for (auto& [a, b, d, m] : expected) {
+			if (3 <= a and a <= 8) {
+				m *= 2;
+				d = 99 - d;
+			}
+		}
+		CHECK_EQ(s.num_merged_elements, 0);
+		CHECK(s.num_sorted_leaves > 0);
+		CHECK(sorted_leaves(t));
+
+		std::vector<entry_t> result = entries(t);
+		std::sort(result.begin(), result.end());
+		std::sort(expected.begin(), expected.end());
+		CHECK_EQ(result, expected);
+	}
+
+	SUBCASE("Without metadata")
+	{
+		classtree::ctree<int, void, int> u;
+		for (int i = 0; i < 1000; ++i) {
+			u.add<false>(i % 37, i % 10);
+		}
+		const classtree::transform_stats s = classtree::transform_data<false>(
+			u, 2, [](int& d) { d = 100 - d; }, [](const int k) { return k < 3; }
+		);
+		CHECK_EQ(s.num_leaves, 3);
+		CHECK_EQ(s.num_elements, 300);
+		CHECK_EQ(s.num_sorted_leaves, 3);
+		CHECK_EQ(s.num_merged_elements, 0);
+		CHECK_EQ(u.size(), 1000);
+
+		classtree::ctree<int, int> leaf;
+		leaf.add({5, 1});
+		leaf.add({7, 1});
+		classtree::inline_executor e;
+		const classtree::transform_stats r = classtree::transform_metadata(
+			leaf, e, [](int& m) { m = 4; }
+		);
+		CHECK_EQ(r.num_leaves, 1);
+		CHECK_EQ(r.num_elements, 2);
+		for (const auto& x : leaf) {
+			CHECK_EQ(x.metadata, 4);
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}